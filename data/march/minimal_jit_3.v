@@ -0,0 +1,11 @@
+`ifndef __CASCADE_DATA_MARCH_MINIMAL_JIT_3_V
+`define __CASCADE_DATA_MARCH_MINIMAL_JIT_3_V
+
+`include "data/stdlib/stdlib.v"
+
+(*__target="sw;sw;sw"*)
+Root root();
+
+Clock clock();
+
+`endif
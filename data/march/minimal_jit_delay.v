@@ -0,0 +1,11 @@
+`ifndef __CASCADE_DATA_MARCH_MINIMAL_JIT_DELAY_V
+`define __CASCADE_DATA_MARCH_MINIMAL_JIT_DELAY_V
+
+`include "data/stdlib/stdlib.v"
+
+(*__target="sw;sw", __delay=1*)
+Root root();
+
+Clock clock();
+
+`endif
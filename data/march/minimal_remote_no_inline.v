@@ -0,0 +1,11 @@
+`ifndef __CASCADE_DATA_MARCH_MINIMAL_REMOTE_NO_INLINE_V
+`define __CASCADE_DATA_MARCH_MINIMAL_REMOTE_NO_INLINE_V
+
+`include "data/stdlib/stdlib.v"
+
+(*__loc="/tmp/fpga_socket", __no_inline="true"*)
+Root root();
+
+Clock clock();
+
+`endif
@@ -0,0 +1,100 @@
+// Two small counters and a large one. Under a small inlining budget, the
+// small counters are inlined into root and the large one is compiled on its
+// own. All three count clock ticks.
+
+module Small(
+  input wire clk,
+  output reg[7:0] val
+);
+  initial val = 0;
+  always @(posedge clk) val <= val + 1;
+endmodule
+
+module Large(
+  input wire clk,
+  output wire[7:0] val
+);
+  reg[7:0] r0 = 0;
+  reg[7:0] r1 = 0;
+  reg[7:0] r2 = 0;
+  reg[7:0] r3 = 0;
+  reg[7:0] r4 = 0;
+  reg[7:0] r5 = 0;
+  reg[7:0] r6 = 0;
+  reg[7:0] r7 = 0;
+  reg[7:0] r8 = 0;
+  reg[7:0] r9 = 0;
+  reg[7:0] r10 = 0;
+  reg[7:0] r11 = 0;
+  reg[7:0] r12 = 0;
+  reg[7:0] r13 = 0;
+  reg[7:0] r14 = 0;
+  reg[7:0] r15 = 0;
+  reg[7:0] r16 = 0;
+  reg[7:0] r17 = 0;
+  reg[7:0] r18 = 0;
+  reg[7:0] r19 = 0;
+  reg[7:0] r20 = 0;
+  reg[7:0] r21 = 0;
+  reg[7:0] r22 = 0;
+  reg[7:0] r23 = 0;
+  reg[7:0] r24 = 0;
+  reg[7:0] r25 = 0;
+  reg[7:0] r26 = 0;
+  reg[7:0] r27 = 0;
+  reg[7:0] r28 = 0;
+  reg[7:0] r29 = 0;
+  reg[7:0] r30 = 0;
+  reg[7:0] r31 = 0;
+  always @(posedge clk) begin
+    r0 <= r0 + 8'd1;
+    r1 <= r1 + 8'd1;
+    r2 <= r2 + 8'd1;
+    r3 <= r3 + 8'd1;
+    r4 <= r4 + 8'd1;
+    r5 <= r5 + 8'd1;
+    r6 <= r6 + 8'd1;
+    r7 <= r7 + 8'd1;
+    r8 <= r8 + 8'd1;
+    r9 <= r9 + 8'd1;
+    r10 <= r10 + 8'd1;
+    r11 <= r11 + 8'd1;
+    r12 <= r12 + 8'd1;
+    r13 <= r13 + 8'd1;
+    r14 <= r14 + 8'd1;
+    r15 <= r15 + 8'd1;
+    r16 <= r16 + 8'd1;
+    r17 <= r17 + 8'd1;
+    r18 <= r18 + 8'd1;
+    r19 <= r19 + 8'd1;
+    r20 <= r20 + 8'd1;
+    r21 <= r21 + 8'd1;
+    r22 <= r22 + 8'd1;
+    r23 <= r23 + 8'd1;
+    r24 <= r24 + 8'd1;
+    r25 <= r25 + 8'd1;
+    r26 <= r26 + 8'd1;
+    r27 <= r27 + 8'd1;
+    r28 <= r28 + 8'd1;
+    r29 <= r29 + 8'd1;
+    r30 <= r30 + 8'd1;
+    r31 <= r31 + 8'd1;
+  end
+  assign val = r0 & r1 & r2 & r3 & r4 & r5 & r6 & r7 & r8 & r9 & r10 & r11 & r12 & r13 & r14 & r15 & r16 & r17 & r18 & r19 & r20 & r21 & r22 & r23 & r24 & r25 & r26 & r27 & r28 & r29 & r30 & r31;
+endmodule
+
+wire[7:0] x;
+wire[7:0] y;
+wire[7:0] z;
+Small s1(clock.val, x);
+Small s2(clock.val, y);
+Large l(clock.val, z);
+
+reg[15:0] count = 0;
+always @(posedge clock.val) begin
+  count <= count + 1;
+  if (count == 16384) begin
+    $write((x == y) && (y == z));
+    $finish;
+  end
+end
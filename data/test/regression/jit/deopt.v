@@ -0,0 +1,33 @@
+// Two identical counters which are compiled on their own. The first is
+// repeatedly deoptimized. Any deoptimization which takes place after it's
+// been promoted moves it back to software, and mustn't lose its count. The
+// second is left alone and should stay on its highest tier.
+
+(*__no_inline="true"*)
+module Counter(
+  input wire clk,
+  output reg[63:0] val
+);
+  initial val = 0;
+  always @(posedge clk) val <= val + 1;
+endmodule
+
+wire[63:0] x;
+wire[63:0] y;
+Counter c1(clock.val, x);
+Counter c2(clock.val, y);
+
+initial $write("once");
+
+always @(posedge clock.val) begin
+  if (x != y) begin
+    $write("lost");
+    $finish;
+  end
+  if (x[11:0] == 128)
+    $__debug(4, root.c1);
+  if (x == 65536) begin
+    $write("done");
+    $finish;
+  end
+end
@@ -0,0 +1,23 @@
+module Counter(
+  input wire clk,
+  output reg[7:0] val
+);
+  initial val = 0;
+  always @(posedge clk) val <= val + 1;
+endmodule
+
+wire[7:0] x;
+Counter c(clock.val, x);
+
+reg[63:0] count = 0;
+always @(posedge clock.val) begin
+  count <= count + 1;
+  if (count == 128)
+    $__debug(6, root.c);
+  if (count == 512)
+    $__debug(5, root.c);
+  if (count == 1024) begin
+    $write(x == count[7:0]);
+    $finish;
+  end
+end
@@ -0,0 +1,10 @@
+// A counter which runs until it's stopped. It doesn't declare anything when
+// it's retargeted, so retargeting it away and back again restores the
+// original source of root.
+
+initial $write("once");
+
+reg[63:0] count = 0;
+always @(posedge clock.val) begin
+  count <= count + 1;
+end
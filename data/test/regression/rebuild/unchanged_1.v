@@ -0,0 +1,17 @@
+// A counter which is compiled on its own, and a register in root which
+// follows it. Nothing here finishes. A second file is evaluated later.
+
+(*__no_inline="true"*)
+module Counter(
+  input wire clk,
+  output reg[7:0] val
+);
+  initial val = 0;
+  always @(posedge clk) val <= val + 1;
+endmodule
+
+wire[7:0] x;
+Counter c(clock.val, x);
+
+reg[7:0] y = 0;
+always @(posedge clock.val) y <= x;
@@ -0,0 +1,11 @@
+// Adds code to root which only reads what root already reads from the
+// counter. Root's isolated source changes, the counter's doesn't.
+
+reg[15:0] count = 0;
+always @(posedge clock.val) begin
+  count <= count + 1;
+  if (count == 1024) begin
+    $write("done");
+    $finish;
+  end
+end
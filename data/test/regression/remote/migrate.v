@@ -0,0 +1,14 @@
+// A counter and a running sum which run long enough for their engine to be
+// migrated while they're running. Neither may lose its value along the way.
+
+reg[15:0] count = 0;
+reg[31:0] sum = 0;
+
+always @(posedge clock.val) begin
+  count <= count + 1;
+  sum <= sum + count;
+  if (count == 16384) begin
+    $write("%d %d", count, sum);
+    $finish;
+  end
+end
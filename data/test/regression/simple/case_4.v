@@ -0,0 +1,23 @@
+reg[15:0] i = 0;
+
+always @(posedge clock.val) begin
+  case (i[2:0])
+    0, 2: $write("a");
+    1: $write("b");
+    3: $write("c");
+    4, 5: $write("d");
+    2: $write("x");
+    default: $write("e");
+  endcase
+  case (i)
+    1: $write("1");
+    100: $write("x");
+    3: $write("3");
+    1000: $write("y");
+    default: $write(".");
+  endcase
+
+  i <= i + 1;
+  if (i == 7)
+    $finish;
+end
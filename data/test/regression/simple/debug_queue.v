@@ -0,0 +1,11 @@
+// Reports the state of the compile queue. Nothing here is jit compiled, so
+// it should always be empty.
+
+reg[1:0] count = 0;
+always @(posedge clock.val) begin
+  count <= count + 1;
+  if (count == 1)
+    $__debug(7, root.count);
+  if (count == 3)
+    $finish;
+end
@@ -0,0 +1,10 @@
+integer i = 0;
+reg[31:0] sum = 0;
+
+initial begin
+  for (i = 0; i < 100000; i = i+1) begin
+    sum = sum + i;
+  end
+  $write(sum);
+  $finish;
+end
@@ -0,0 +1,40 @@
+// This test mixes reads, writes, and seeks on a single stream, one per clock
+// tick. Remote engines read ahead, so every step after the first read leaves
+// unused input behind.
+
+integer s = $fopen(`SCRATCH(io_5.dat), "w+");
+reg[31:0] r = 0;
+reg[3:0] step = 0;
+
+always @(posedge clock.val) begin
+  step <= step + 1;
+  case (step)
+    0: begin
+      $fwrite(s, "%h %h %h %h\n", 32'h1, 32'h2, 32'h3, 32'h4);
+      $fseek(s, 0, 0);
+    end
+    1: begin
+      $fread(s, r);
+      $write("%h ", r);
+    end
+    2: begin
+      $fseek(s, 18, 0);
+      $fwrite(s, "%h", 32'h9);
+    end
+    3: $fseek(s, 9, 0);
+    4: begin
+      $fread(s, r);
+      $write("%h ", r);
+    end
+    5: begin
+      $fread(s, r);
+      $write("%h ", r);
+    end
+    default: begin
+      $fflush(s);
+      $fread(s, r);
+      $write("%h", r);
+      $finish;
+    end
+  endcase
+end
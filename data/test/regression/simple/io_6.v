@@ -0,0 +1,27 @@
+// This test initializes a 64K entry memory with one $fread per entry and then
+// reads back a few addresses. The memory image is written by the test harness.
+
+`include "data/stdlib/memory.v"
+
+reg[15:0] addr = 0;
+wire[7:0] rdata;
+Memory#(8, 16, `SCRATCH(io_6.dat)) m(
+  .clock(clock.val),
+  .wen(1'b0),
+  .addr(addr),
+  .wdata(8'd0),
+  .rdata(rdata)
+);
+
+reg[2:0] step = 0;
+always @(posedge clock.val) begin
+  step <= step + 1;
+  case (step)
+    0: addr <= 1;
+    1: addr <= 4095;
+    2: addr <= 4096;
+    3: addr <= 65534;
+    default: $finish;
+  endcase
+  $write("%h ", rdata);
+end
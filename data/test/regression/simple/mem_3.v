@@ -0,0 +1,20 @@
+// A memory which is large enough to be stored in packed form. Its elements
+// are wider than a machine word, and are written both whole and in part.
+
+reg[39:0] mem[4095:0];
+integer i = 0;
+reg[39:0] sum = 0;
+
+initial begin
+  for (i = 0; i < 4096; i = i+1) begin
+    mem[i] = 40'h1_0000_0000 + i;
+  end
+  for (i = 0; i < 4096; i = i+2) begin
+    mem[i][7:0] = 8'hff;
+  end
+  for (i = 0; i < 4096; i = i+1) begin
+    sum = sum + mem[i];
+  end
+  $write(sum);
+  $finish;
+end
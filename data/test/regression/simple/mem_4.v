@@ -0,0 +1,15 @@
+// A memory which is initialized from a file image. The image is shorter than
+// the memory, so the elements past the end of the file should be zero.
+
+(* __image = "data/test/regression/simple/mem_4.dat" *)
+reg[7:0] mem[15:0];
+integer i = 0;
+reg[31:0] sum = 0;
+
+initial begin
+  for (i = 0; i < 16; i = i+1) begin
+    sum = sum + mem[i];
+  end
+  $write(sum);
+  $finish;
+end
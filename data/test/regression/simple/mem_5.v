@@ -0,0 +1,19 @@
+// A memory with more than 2^16 elements. Each element that's written is read
+// back on the next cycle, and a few of the earliest writes are read back at
+// the very end, so any loss of state along the way changes the output.
+
+reg[31:0] mem[(1<<20)-1:0];
+reg[31:0] i = 0;
+reg[31:0] sum = 0;
+
+always @(posedge clock.val) begin
+  if (i == 20000) begin
+    $write("%h %h %h", mem[41], mem[2000*41], sum);
+    $finish;
+  end
+  mem[i*41] <= i + 1;
+  if (i > 0) begin
+    sum <= sum + mem[(i-1)*41];
+  end
+  i <= i + 1;
+end
@@ -0,0 +1,11 @@
+// The memory from the README, initialized from a file image with 2^20
+// elements and written back when the program finishes.
+
+(* __image = `SCRATCH(mem_6.dat), __write_back *)
+reg[31:0] mem[(1<<20)-1:0];
+
+initial begin
+  $write("%h %h %h", mem[0], mem[65536], mem[(1<<20)-1]);
+  mem[1] = 32'hcafe;
+  $finish;
+end
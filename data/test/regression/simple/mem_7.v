@@ -0,0 +1,12 @@
+// A memory whose elements are narrower than their stride, initialized from an
+// image with garbage in the padding bits and written back when the program
+// finishes. The image is longer than the memory.
+
+(* __image = `SCRATCH(mem_7.dat), __write_back *)
+reg[11:0] mem[3:0];
+
+initial begin
+  $write("%h %h", mem[0], mem[1]);
+  mem[2] = 12'habc;
+  $finish;
+end
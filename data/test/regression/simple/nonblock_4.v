@@ -0,0 +1,17 @@
+reg[7:0] a = 1;
+reg[7:0] b = 2;
+reg[7:0] c = 0;
+reg[3:0] COUNT = 0;
+
+always @(posedge clock.val) begin
+  a <= b;
+  b <= a;
+  c <= 1;
+  if (a == 1)
+    c <= 7;
+
+  $write("%d%d%d ", a, b, c);
+  COUNT <= COUNT + 1;
+  if (COUNT == 3)
+    $finish;
+end
@@ -0,0 +1,30 @@
+// This test contains a chain of registers which never reach an output, a
+// loop whose variable is read after it finishes, and a conditional which
+// guards a system task.
+
+reg[7:0] a = 0;
+reg[7:0] b = 0;
+reg[7:0] c = 0;
+reg[7:0] d = 0;
+wire[7:0] e;
+assign e = c + d;
+
+integer i = 0;
+reg[7:0] sum = 0;
+reg[7:0] COUNT = 0;
+
+always @(posedge clock.val) begin
+  a <= a + 1;
+  b <= a;
+  c <= b;
+  d <= e;
+  for (i = 0; i < 4; i = i + 1) begin
+    c <= c ^ i;
+  end
+  sum <= sum + i;
+  COUNT <= COUNT + 1;
+  if (COUNT == 4) begin
+    $write("%d", sum);
+    $finish;
+  end
+end
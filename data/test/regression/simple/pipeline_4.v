@@ -0,0 +1,38 @@
+// This test contains multiplies, divides, moduli, and powers of power-of-two
+// constants, some of which can be strength reduced and some of which can't.
+// Widths are visible wherever an expression is self-determined.
+
+reg[7:0] a;
+reg signed[7:0] b;
+reg[31:0] e;
+integer i;
+reg[15:0] y;
+reg[3:0] z;
+
+initial begin
+  a = 201;
+  b = 8'hf9;
+  e = 5;
+  i = -13;
+
+  $write("%h ", a * 8'd4);
+  $write("%h ", 8'd4 * a);
+  $write("%h ", a * 4);
+  $write("%h ", a / 8'd8);
+  $write("%h ", a % 8);
+  $write("%h ", b % 4'd8);
+  $write("%d ", b * 8'sd2);
+  $write("%h ", {a * 8'd2, 4'h0});
+  $write("%d ", i / 4);
+  $write("%d ", i % 8);
+  $write("%h ", 2 ** e);
+
+  y = a * 4;
+  $write("%h ", y);
+  y = b * 4'd4;
+  $write("%h ", y);
+  z = a / 4;
+  $write("%h", z);
+
+  $finish;
+end
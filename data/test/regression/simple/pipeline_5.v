@@ -0,0 +1,44 @@
+// This test contains expressions whose bits are partly known at compile time:
+// masks by zero, zero-extended sums, constant shifts, and comparisons between
+// zero-extended values.
+
+reg[7:0] x;
+reg[7:0] y;
+reg[15:0] w;
+reg[7:0] a;
+reg[8:0] b;
+reg[7:0] c;
+reg[7:0] d;
+reg e;
+reg f;
+reg g;
+reg h;
+
+initial begin
+  x = 8'h5a;
+  y = 8'hff;
+  w = 16'h1234;
+
+  a = x & 0;
+  $write("%h ", a);
+  b = {8'b0,y} + 1;
+  $write("%h ", b);
+  c = (w << 8) | y;
+  $write("%h ", c);
+  d = x >> 8;
+  $write("%h ", d);
+  d = w >> 4;
+  $write("%h ", d);
+  d = x << 3;
+  $write("%h ", d);
+  d = x << 0;
+  $write("%h ", d);
+
+  e = {8'b0,y} == 255;
+  f = {8'b0,y} < 9'h100;
+  g = {8'b0,x} != {8'b0,y};
+  h = {4'b0,x} > {8'b0,y};
+  $write("%b%b%b%b", e, f, g, h);
+
+  $finish;
+end
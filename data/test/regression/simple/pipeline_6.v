@@ -0,0 +1,24 @@
+// This test contains repeated subexpressions which are separated by a
+// nonblocking write to one of their inputs.
+
+reg[7:0] a = 8'h0f;
+reg[7:0] b = 8'h33;
+reg[7:0] c = 8'h01;
+reg[7:0] w = 0;
+reg[7:0] x = 0;
+reg[7:0] y = 0;
+reg[7:0] z = 0;
+reg[1:0] n = 0;
+
+always @(posedge clock.val) begin
+  w = (a ^ b) + c;
+  x = (a ^ b) - c;
+  y = (a ^ b) & c;
+  b <= c;
+  z = (a ^ b) | c;
+  n <= n + 1;
+  if (n == 1) begin
+    $write("%h %h %h %h", w, x, y, z);
+    $finish;
+  end
+end
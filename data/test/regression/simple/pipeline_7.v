@@ -0,0 +1,32 @@
+// This test contains assignments to narrow targets whose right-hand sides
+// contain operators that depend on the width of their context: right shifts,
+// division, modulus, and signed arithmetic. None of these may be narrowed.
+
+reg[31:0] a;
+reg[3:0] b;
+reg[3:0] c;
+reg[3:0] y;
+reg signed[1:0] s;
+reg[3:0] z;
+
+initial begin
+  a = 0;
+  b = 15;
+  c = 15;
+  s = -1;
+
+  y = a + ((b+c) >> 1);
+  $write("%h ", y);
+  y = a + ((b+c) / 2);
+  $write("%h ", y);
+  y = a + ((b+c) % 17);
+  $write("%h ", y);
+  y = a + (((b+c) >> 4) << 3);
+  $write("%h ", y);
+  y = a + b + c;
+  $write("%h ", y);
+  z = s ^ 8'sd17;
+  $write("%h", z);
+
+  $finish;
+end
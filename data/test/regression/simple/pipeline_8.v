@@ -0,0 +1,11 @@
+// A memory which is written back to its image, but which is never read by
+// the program itself.
+
+(* __image = `SCRATCH(pipeline_8.dat), __write_back *)
+reg[31:0] mem[3:0];
+
+initial begin
+  mem[1] = 32'hcafe;
+  $write("done");
+  $finish;
+end
@@ -0,0 +1,7 @@
+reg[31:0] sum = 0;
+
+initial begin
+  repeat(100000) sum = sum + 3;
+  $write(sum);
+  $finish;
+end
@@ -0,0 +1,14 @@
+integer i = 0;
+integer j = 0;
+reg[31:0] n = 0;
+
+initial begin
+  while (i < 1000) begin
+    for (j = 0; j < i; j = j+1) begin
+      n = n + 1;
+    end
+    i = i + 1;
+  end
+  $write(n);
+  $finish;
+end
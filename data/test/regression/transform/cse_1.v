@@ -0,0 +1,29 @@
+// Repeated subexpressions in continuous assignments and in an always block.
+// The always block contains repeats which are separated by a system task
+// and by a nonblocking write to one of their inputs.
+
+module Cse(clk);
+  input wire clk;
+
+  reg[7:0] a;
+  reg[7:0] b;
+  reg[7:0] c;
+  reg[7:0] w;
+  reg[7:0] x;
+  reg[7:0] y;
+  reg[7:0] z;
+  wire[7:0] p;
+  wire[7:0] q;
+
+  assign p = (a & c) + 8'd1;
+  assign q = (a & c) - 8'd1;
+
+  always @(posedge clk) begin
+    w = (a ^ b) + c;
+    x = (a ^ b) - c;
+    $display(a ^ b);
+    y = (a ^ b) & c;
+    b <= c;
+    z = (a ^ b) | c;
+  end
+endmodule
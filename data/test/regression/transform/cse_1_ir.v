@@ -0,0 +1,32 @@
+// The result of running common_subexpression_eliminate on cse_1.v
+
+module Cse(clk);
+  reg[7:0] __cse_1;
+  wire[7:0] __cse_0;
+  input wire clk;
+
+  reg[7:0] a;
+  reg[7:0] b;
+  reg[7:0] c;
+  reg[7:0] w;
+  reg[7:0] x;
+  reg[7:0] y;
+  reg[7:0] z;
+  wire[7:0] p;
+  wire[7:0] q;
+
+  assign p = __cse_0 + 8'd1;
+  assign q = __cse_0 - 8'd1;
+
+  always @(posedge clk) begin
+    __cse_1 = a ^ b;
+    w = __cse_1 + c;
+    x = __cse_1 - c;
+    $display(a ^ b);
+    y = (a ^ b) & c;
+    b <= c;
+    z = (a ^ b) | c;
+  end
+
+  assign __cse_0 = a & c;
+endmodule
@@ -0,0 +1,28 @@
+// Expressions whose bits are partly known at compile time: masks by zero,
+// zero-extended sums, constant shifts, and comparisons between zero-extended
+// values.
+
+module KnownBits(clk);
+  input wire clk;
+
+  reg[7:0] x;
+  reg[7:0] y;
+  reg[15:0] w;
+  reg[7:0] a;
+  reg[8:0] b;
+  reg[7:0] c;
+  reg[7:0] d;
+  reg[7:0] f;
+  reg e;
+  reg g;
+
+  always @(posedge clk) begin
+    a = x & 0;
+    b = {8'b0,y} + 1;
+    c = (w << 8) | y;
+    d = x >> 8;
+    f = x << 0;
+    e = {8'b0,y} == 255;
+    g = {8'b0,x} != {8'b0,y};
+  end
+endmodule
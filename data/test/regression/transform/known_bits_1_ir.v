@@ -0,0 +1,26 @@
+// The result of running known_bits_prop on known_bits_1.v
+
+module KnownBits(clk);
+  input wire clk;
+
+  reg[7:0] x;
+  reg[7:0] y;
+  reg[15:0] w;
+  reg[7:0] a;
+  reg[8:0] b;
+  reg[7:0] c;
+  reg[7:0] d;
+  reg[7:0] f;
+  reg e;
+  reg g;
+
+  always @(posedge clk) begin
+    a = 8'h0;
+    b = {8'b0,y} + 9'h1;
+    c = y;
+    d = 8'h0;
+    f = x;
+    e = y == 8'hff;
+    g = x != y;
+  end
+endmodule
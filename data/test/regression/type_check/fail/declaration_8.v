@@ -0,0 +1,3 @@
+// File images must exist
+(* __image = "data/test/regression/type_check/fail/missing.dat" *)
+reg[7:0] mem[15:0];
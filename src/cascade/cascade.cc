@@ -51,6 +51,7 @@ Cascade::Cascade() : eval_(this), iostream(&sb_), sb_() {
   runtime_.get_compiler()->set("sw", new SwCompiler());
 
   set_quartus_server("localhost", 9900);
+  set_compression_threshold(0);
 }
 
 Cascade::~Cascade() {
@@ -69,12 +70,78 @@ Cascade& Cascade::set_enable_inlining(bool enable) {
   return *this;
 }
 
+Cascade& Cascade::set_inline_budget(size_t n) {
+  assert(!is_running_);
+  runtime_.set_inline_budget(n);
+  return *this;
+}
+
+Cascade& Cascade::set_inline_threshold(size_t ms) {
+  assert(!is_running_);
+  runtime_.set_inline_threshold(ms);
+  return *this;
+}
+
 Cascade& Cascade::set_open_loop_target(size_t n) {
   assert(!is_running_);
   runtime_.set_open_loop_target(n);
   return *this;
 }
 
+Cascade& Cascade::set_promotion_threshold(size_t ms) {
+  assert(!is_running_);
+  runtime_.set_promotion_threshold(ms);
+  return *this;
+}
+
+Cascade& Cascade::set_async_fast_pass(bool enable) {
+  assert(!is_running_);
+  runtime_.set_async_fast_pass(enable);
+  return *this;
+}
+
+Cascade& Cascade::set_speculative_cache_size(size_t n) {
+  assert(!is_running_);
+  runtime_.set_speculative_cache_size(n);
+  return *this;
+}
+
+Cascade& Cascade::set_max_compilations(size_t n) {
+  assert(!is_running_);
+  runtime_.set_max_compilations(n);
+  return *this;
+}
+
+Cascade& Cascade::set_pass_pipeline(const string& spec) {
+  assert(!is_running_);
+  runtime_.set_pass_pipeline(spec);
+  return *this;
+}
+
+Cascade& Cascade::set_pass_stats(bool enable) {
+  assert(!is_running_);
+  runtime_.set_pass_stats(enable);
+  return *this;
+}
+
+Cascade& Cascade::set_enable_debug(bool enable) {
+  assert(!is_running_);
+  runtime_.set_enable_debug(enable);
+  return *this;
+}
+
+Cascade& Cascade::set_batch_mode(bool enable) {
+  assert(!is_running_);
+  runtime_.set_batch_mode(enable);
+  return *this;
+}
+
+Cascade& Cascade::set_cache_path(const string& path) {
+  assert(!is_running_);
+  runtime_.set_cache_path(path);
+  return *this;
+}
+
 Cascade& Cascade::set_quartus_server(const string& host, size_t port) {
   assert(!is_running_);
   auto* dc = runtime_.get_compiler()->get("de10");
@@ -84,6 +151,14 @@ Cascade& Cascade::set_quartus_server(const string& host, size_t port) {
   return *this;
 }
 
+Cascade& Cascade::set_compression_threshold(size_t n) {
+  assert(!is_running_);
+  auto* pc = runtime_.get_compiler()->get("proxy");
+  assert(pc != nullptr);
+  static_cast<ProxyCompiler*>(pc)->set_compression_threshold(n);
+  return *this;
+}
+
 Cascade& Cascade::set_profile_interval(size_t n) {
   assert(!is_running_);
   runtime_.set_profile_interval(n);
@@ -181,6 +256,11 @@ bool Cascade::is_finished() const {
   return runtime_.is_finished();
 }
 
+Cascade& Cascade::migrate(const string& from, const string& to) {
+  runtime_.migrate(from, to);
+  return *this;
+}
+
 Cascade::EvalLoop::EvalLoop(Cascade* cascade) : Thread() {
   cascade_ = cascade;
 }
@@ -62,8 +62,20 @@ class Cascade : public std::iostream {
     // run.  Inoking any of these methods afterwards is undefined.
     Cascade& set_include_dirs(const std::string& path);
     Cascade& set_enable_inlining(bool enable);
+    Cascade& set_inline_budget(size_t n);
+    Cascade& set_inline_threshold(size_t ms);
     Cascade& set_open_loop_target(size_t n);
+    Cascade& set_promotion_threshold(size_t ms);
+    Cascade& set_async_fast_pass(bool enable);
+    Cascade& set_speculative_cache_size(size_t n);
+    Cascade& set_max_compilations(size_t n);
+    Cascade& set_pass_pipeline(const std::string& spec);
+    Cascade& set_pass_stats(bool enable);
+    Cascade& set_enable_debug(bool enable);
+    Cascade& set_batch_mode(bool enable);
+    Cascade& set_cache_path(const std::string& path);
     Cascade& set_quartus_server(const std::string& host, size_t port);
+    Cascade& set_compression_threshold(size_t n);
     Cascade& set_profile_interval(size_t n);
     Cascade& set_stdin(std::streambuf* sb);
     Cascade& set_stdout(std::streambuf* sb);
@@ -87,6 +99,12 @@ class Cascade : public std::iostream {
     bool is_running() const;
     bool is_finished() const;
 
+    // Migration Methods:
+    //
+    // Moves every engine located at from to to without stopping the
+    // simulation. This method returns immediately.
+    Cascade& migrate(const std::string& from, const std::string& to);
+
   private:
     class EvalLoop : public Thread {
       public:
@@ -35,12 +35,17 @@
 #include <streambuf>
 #include <sys/socket.h>
 #include <vector>
+#include "common/lz4.h"
 
 namespace cascade {
 
 // This class provides a c++ stream interface to *nix file descriptors. The
 // implementation of this class uses a resizable character buffer in the heap
-// to store character data in between calls to flush.
+// to store character data in between calls to flush. Each flush is sent as a
+// single length-prefixed frame. Frames which are larger than the compression
+// threshold are compressed if doing so makes them smaller. Compressed frames
+// are marked in their length prefix, so the receiving end can always decode
+// them regardless of its own threshold.
 
 class fdbuf : public std::streambuf {
   public:
@@ -55,9 +60,21 @@ class fdbuf : public std::streambuf {
     explicit fdbuf(int fd);
     ~fdbuf() override = default;
 
+    // Configuration Interface:
+    //
+    // Sets the minimum size of a frame which will be compressed. A value of
+    // zero disables compression.
+    void set_compression_threshold(uint32_t n);
+
   private:
+    // Frame Header Flags:
+    static constexpr uint32_t compressed_ = 0x8000'0000;
+
     // File Descriptor
     int fd_;
+    // Compression State
+    uint32_t threshold_;
+    std::vector<char_type> zip_;
     // Get/Input/Read Area
     std::vector<char_type> get_;
     // Put/Output/Write Area
@@ -88,6 +105,9 @@ class fdbuf : public std::streambuf {
     // Send/Recv:
     int send(const char_type* c, size_t len);
     int recv(char_type* c, size_t len);
+    // Reads the next frame into the get area. Returns its length or -1 on
+    // failure.
+    int recv_frame();
 };
 
 class ifdstream : public std::istream {
@@ -113,16 +133,23 @@ class fdstream : public std::iostream {
     fdstream(int fd);
     ~fdstream() override = default;
 
+    void set_compression_threshold(uint32_t n);
+
   private:
     fdbuf buf_;
 };
 
 inline fdbuf::fdbuf(int fd) : get_(1), put_(1) {
   fd_ = fd;
+  threshold_ = 0;
   setg(get_.data(), get_.data(), get_.data());
   setp(put_.data(), put_.data()+1);
 }
 
+inline void fdbuf::set_compression_threshold(uint32_t n) {
+  threshold_ = n;
+}
+
 inline void fdbuf::imbue(const std::locale& loc) {
   // Does nothing.
   (void) loc;
@@ -153,7 +180,27 @@ inline int fdbuf::sync() {
   const uint32_t n = pptr()-pbase();
   if (n == 0) {
     return 0;
-  } else if (send((const char*)&n, sizeof(n)) == -1) {
+  }
+
+  // Compressed frames contain the uncompressed length followed by the
+  // compressed data. Fall back on sending the frame as-is if it didn't shrink.
+  if ((threshold_ > 0) && (n >= threshold_)) {
+    Lz4::compress(pbase(), n, zip_);
+    if (zip_.size() + sizeof(n) < n) {
+      const uint32_t header = (zip_.size() + sizeof(n)) | compressed_;
+      if (send((const char*)&header, sizeof(header)) == -1) {
+        return -1;
+      } else if (send((const char*)&n, sizeof(n)) == -1) {
+        return -1;
+      } else if (send(zip_.data(), zip_.size()) == -1) {
+        return -1;
+      }
+      setp(put_.data(), put_.data()+put_.size());
+      return 0;
+    }
+  }
+
+  if (send((const char*)&n, sizeof(n)) == -1) {
     return -1;
   } else if (send((const char*)pbase(), n) == -1) {
     return -1;
@@ -168,32 +215,17 @@ inline std::streamsize fdbuf::showmanyc() {
 }
 
 inline fdbuf::int_type fdbuf::underflow() {
-  uint32_t n = 0;
-  if (recv((char_type*)&n, sizeof(n)) == -1) {
-    return traits_type::eof(); 
-  }
-  if (n > get_.size()) {
-    get_.resize(n);
-  }
-  if (recv((char_type*)get_.data(), n) == -1) {
+  if (recv_frame() == -1) {
     return traits_type::eof();
   }
-  setg(get_.data(), get_.data(), get_.data()+n);
   return traits_type::to_int_type(get_[0]);
 }
 
 inline fdbuf::int_type fdbuf::uflow() {
-  uint32_t n = 0;
-  if (recv((char_type*)&n, sizeof(n)) == -1) {
-    return traits_type::eof(); 
-  }
-  if (n > get_.size()) {
-    get_.resize(n);
-  }
-  if (recv((char_type*)get_.data(), n) == -1) {
+  if (recv_frame() == -1) {
     return traits_type::eof();
   }
-  setg(get_.data(), get_.data()+1, get_.data()+n);
+  gbump(1);
   return traits_type::to_int_type(get_[0]);
 }
 
@@ -261,8 +293,9 @@ inline int fdbuf::send(const char_type* c, size_t len) {
 inline int fdbuf::recv(char_type* c, size_t len) {
   int total = 0;
   while (total < (int)len) {
+    // A return value of zero means the other end of the socket was closed
     const auto res = ::recv(fd_, c+total, len-total, 0);
-    if (res == -1) {
+    if (res <= 0) {
       return -1;
     }
     total += res;
@@ -270,12 +303,57 @@ inline int fdbuf::recv(char_type* c, size_t len) {
   return total;
 }
 
+inline int fdbuf::recv_frame() {
+  uint32_t n = 0;
+  if (recv((char_type*)&n, sizeof(n)) == -1) {
+    return -1;
+  }
+
+  // Uncompressed frames can be read directly into the get area
+  if ((n & compressed_) == 0) {
+    if (n > get_.size()) {
+      get_.resize(n);
+    }
+    if (recv((char_type*)get_.data(), n) == -1) {
+      return -1;
+    }
+    setg(get_.data(), get_.data(), get_.data()+n);
+    return n;
+  }
+
+  // Compressed frames are decompressed into the get area
+  n &= ~compressed_;
+  uint32_t len = 0;
+  if ((n < sizeof(len)) || (recv((char_type*)&len, sizeof(len)) == -1)) {
+    return -1;
+  }
+  n -= sizeof(len);
+  if (n > zip_.size()) {
+    zip_.resize(n);
+  }
+  if (recv((char_type*)zip_.data(), n) == -1) {
+    return -1;
+  }
+  if (len > get_.size()) {
+    get_.resize(len);
+  }
+  if (!Lz4::decompress(zip_.data(), n, get_.data(), len)) {
+    return -1;
+  }
+  setg(get_.data(), get_.data(), get_.data()+len);
+  return len;
+}
+
 inline ifdstream::ifdstream(int fd) : std::istream(&buf_), buf_(fd) { }
 
 inline ofdstream::ofdstream(int fd) : std::ostream(&buf_), buf_(fd) { }
 
 inline fdstream::fdstream(int fd) : std::iostream(&buf_), buf_(fd) { }
 
+inline void fdstream::set_compression_threshold(uint32_t n) {
+  buf_.set_compression_threshold(n);
+}
+
 } // namespace cascade
 
 #endif
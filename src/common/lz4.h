@@ -0,0 +1,193 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_COMMON_LZ4_H
+#define CASCADE_SRC_COMMON_LZ4_H
+
+#include <cstdint>
+#include <cstring>
+#include <stddef.h>
+#include <vector>
+
+namespace cascade {
+
+// This class is a self-contained implementation of the LZ4 block format. It
+// favors speed over compression ratio and is intended for compressing large,
+// highly redundant messages (ie module source and simulation state) before
+// sending them over a socket.
+
+struct Lz4 {
+  // Compresses n bytes starting at src and replaces the contents of dst with
+  // the result.
+  static void compress(const char* src, size_t n, std::vector<char>& dst);
+  // Decompresses n bytes starting at src into exactly dn bytes starting at
+  // dst. Returns false if the input was malformed.
+  static bool decompress(const char* src, size_t n, char* dst, size_t dn);
+
+  private:
+    static constexpr size_t min_match_ = 4;
+    static constexpr size_t last_literals_ = 5;
+    static constexpr size_t match_limit_ = 12;
+    static constexpr size_t max_offset_ = 65535;
+    static constexpr size_t hash_bits_ = 12;
+
+    static uint32_t read32(const char* c);
+    static uint32_t hash(uint32_t seq);
+    static void write_length(size_t len, std::vector<char>& dst);
+    static void write_sequence(const char* lit, size_t lit_len, size_t offset, size_t match_len, std::vector<char>& dst);
+};
+
+inline void Lz4::compress(const char* src, size_t n, std::vector<char>& dst) {
+  dst.clear();
+  dst.reserve(n + n/255 + 16);
+
+  // Positions are stored off by one so that zero can mean empty
+  std::vector<uint32_t> table(1 << hash_bits_, 0);
+  size_t anchor = 0;
+  for (size_t i = 0; (n > match_limit_) && (i < n - match_limit_); ) {
+    const auto seq = read32(src+i);
+    auto& entry = table[hash(seq)];
+    const auto ref = entry;
+    entry = i+1;
+
+    if ((ref == 0) || (i-(ref-1) > max_offset_) || (read32(src+ref-1) != seq)) {
+      ++i;
+      continue;
+    }
+
+    // Extend the match as far as possible, leaving room for the literals
+    // which must end every block.
+    size_t len = min_match_;
+    for (const auto* m = src+ref-1; (i+len < n-last_literals_) && (m[len] == src[i+len]); ++len);
+
+    write_sequence(src+anchor, i-anchor, i-(ref-1), len, dst);
+    i += len;
+    anchor = i;
+  }
+  write_sequence(src+anchor, n-anchor, 0, 0, dst);
+}
+
+inline bool Lz4::decompress(const char* src, size_t n, char* dst, size_t dn) {
+  const auto* ip = reinterpret_cast<const uint8_t*>(src);
+  const auto* ie = ip + n;
+  size_t op = 0;
+
+  while (ip < ie) {
+    const auto token = *ip++;
+
+    // Literals
+    size_t lit = token >> 4;
+    if (lit == 15) {
+      for (uint8_t b = 255; b == 255; lit += b) {
+        if (ip == ie) {
+          return false;
+        }
+        b = *ip++;
+      }
+    }
+    if ((lit > size_t(ie-ip)) || (lit > dn-op)) {
+      return false;
+    }
+    memcpy(dst+op, ip, lit);
+    ip += lit;
+    op += lit;
+
+    // The last sequence in a block contains only literals
+    if (ip == ie) {
+      break;
+    }
+
+    // Match
+    if (ie-ip < 2) {
+      return false;
+    }
+    const size_t offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if ((offset == 0) || (offset > op)) {
+      return false;
+    }
+    size_t len = token & 0xf;
+    if (len == 15) {
+      for (uint8_t b = 255; b == 255; len += b) {
+        if (ip == ie) {
+          return false;
+        }
+        b = *ip++;
+      }
+    }
+    len += min_match_;
+    if (len > dn-op) {
+      return false;
+    }
+    // Matches may overlap the bytes they produce, so copy one at a time
+    for (size_t i = 0; i < len; ++i, ++op) {
+      dst[op] = dst[op-offset];
+    }
+  }
+  return op == dn;
+}
+
+inline uint32_t Lz4::read32(const char* c) {
+  uint32_t res;
+  memcpy(&res, c, sizeof(res));
+  return res;
+}
+
+inline uint32_t Lz4::hash(uint32_t seq) {
+  return (seq * 2654435761u) >> (32 - hash_bits_);
+}
+
+inline void Lz4::write_length(size_t len, std::vector<char>& dst) {
+  for (; len >= 255; len -= 255) {
+    dst.push_back(char(255));
+  }
+  dst.push_back(char(len));
+}
+
+inline void Lz4::write_sequence(const char* lit, size_t lit_len, size_t offset, size_t match_len, std::vector<char>& dst) {
+  const auto ml = (match_len == 0) ? 0 : (match_len - min_match_);
+  dst.push_back(char(((lit_len < 15 ? lit_len : 15) << 4) | (ml < 15 ? ml : 15)));
+  if (lit_len >= 15) {
+    write_length(lit_len-15, dst);
+  }
+  dst.insert(dst.end(), lit, lit+lit_len);
+  if (match_len == 0) {
+    return;
+  }
+  dst.push_back(char(offset & 0xff));
+  dst.push_back(char(offset >> 8));
+  if (ml >= 15) {
+    write_length(ml-15, dst);
+  }
+}
+
+} // namespace cascade
+
+#endif
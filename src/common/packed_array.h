@@ -0,0 +1,273 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_COMMON_PACKED_ARRAY_H
+#define CASCADE_SRC_COMMON_PACKED_ARRAY_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "common/bits.h"
+
+namespace cascade {
+
+// This class is a flat alternative to Vector<Bits> for large arrays of
+// fixed-width bit strings. Rather than allocating a separate Bits object for
+// every element, elements are stored back to back in a single block of
+// memory, each one padded out to 1, 2, or a multiple of 4 bytes. Locating an
+// element is a single multiply. Storage is zero-filled lazily by the
+// operating system, so arrays which are only sparsely touched cost little
+// more than the pages that they use.
+//
+// Arrays can also be initialized from a file image. The layout of an image is
+// identical to the layout of the array in memory: stride() bytes per element,
+// in host byte order, starting from index zero. Images are mapped privately
+// and paged in on demand, so loading even a very large image is cheap.
+
+class PackedArray {
+  public:
+    PackedArray(size_t n, size_t w);
+    PackedArray(const PackedArray& rhs) = delete;
+    PackedArray& operator=(const PackedArray& rhs) = delete;
+    ~PackedArray();
+
+    // Returns the number of elements in this array
+    size_t size() const;
+    // Returns the width of each element in bits
+    size_t width() const;
+    // Returns the number of bytes that each element occupies
+    size_t stride() const;
+    // Returns the number of bytes that an element of width w would occupy
+    static size_t stride_for(size_t w);
+
+    // Copies the idx'th element into b, which must be width() bits wide
+    void read(size_t idx, Bits* b) const;
+    // Copies b, which must be width() bits wide, into the idx'th element
+    void write(size_t idx, const Bits& b);
+    // Copies the contents of rhs, which must have the same width as this
+    // array, into this array in bulk. If the two arrays differ in size, only
+    // the elements which they have in common are copied.
+    void assign(const PackedArray& rhs);
+
+    // Replaces the contents of this array with a file image. Elements which
+    // extend past the end of the file are set to zero, and changes are not
+    // written back to the file. Returns false if the file couldn't be opened,
+    // in which case the array is left unmodified, or if it couldn't be
+    // mapped, in which case every element is set to zero.
+    bool map(const std::string& path);
+    // Replaces the file at path with an image of the contents of this array.
+    // Returns false on failure, in which case the file is left unmodified.
+    bool write_back(const std::string& path) const;
+
+  private:
+    uint8_t* data_;
+    size_t size_;
+    size_t width_;
+    size_t stride_;
+
+    // Returns the number of bytes in this array, rounded up to a full page
+    size_t capacity() const;
+
+    template <typename B>
+    void read_words(const uint8_t* src, size_t n, Bits* b) const;
+    template <typename B>
+    void write_words(uint8_t* dst, size_t n, const Bits& b);
+};
+
+inline PackedArray::PackedArray(size_t n, size_t w) {
+  size_ = n;
+  width_ = w;
+  stride_ = stride_for(w);
+  assert(size_ > 0);
+
+  auto* res = mmap(nullptr, capacity(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  assert(res != MAP_FAILED);
+  data_ = static_cast<uint8_t*>(res);
+}
+
+inline PackedArray::~PackedArray() {
+  munmap(data_, capacity());
+}
+
+inline size_t PackedArray::size() const {
+  return size_;
+}
+
+inline size_t PackedArray::width() const {
+  return width_;
+}
+
+inline size_t PackedArray::stride() const {
+  return stride_;
+}
+
+inline size_t PackedArray::stride_for(size_t w) {
+  return (w <= 8) ? 1 : (w <= 16) ? 2 : (4 * ((w+31) / 32));
+}
+
+inline void PackedArray::read(size_t idx, Bits* b) const {
+  assert(idx < size_);
+  assert(b->size() == width_);
+
+  const auto* src = data_ + idx*stride_;
+  switch (stride_) {
+    case 1:
+      read_words<uint8_t>(src, 1, b);
+      break;
+    case 2:
+      read_words<uint16_t>(src, 1, b);
+      break;
+    default:
+      read_words<uint32_t>(src, stride_/4, b);
+      break;
+  }
+}
+
+inline void PackedArray::write(size_t idx, const Bits& b) {
+  assert(idx < size_);
+  assert(b.size() == width_);
+
+  auto* dst = data_ + idx*stride_;
+  switch (stride_) {
+    case 1:
+      write_words<uint8_t>(dst, 1, b);
+      break;
+    case 2:
+      write_words<uint16_t>(dst, 1, b);
+      break;
+    default:
+      write_words<uint32_t>(dst, stride_/4, b);
+      break;
+  }
+}
+
+inline void PackedArray::assign(const PackedArray& rhs) {
+  assert(rhs.width_ == width_);
+  memcpy(data_, rhs.data_, std::min(size_, rhs.size_)*stride_);
+}
+
+inline bool PackedArray::map(const std::string& path) {
+  const auto fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    close(fd);
+    return false;
+  }
+
+  // Map as much of the file as overlaps this array on top of the pages that
+  // we already own. The remainder of the last page is zero-filled by the
+  // operating system, and every page after that is replaced by a fresh zero
+  // page.
+  const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const auto n = std::min(static_cast<size_t>(st.st_size), size_*stride_);
+  const auto len = ((n + page - 1) / page) * page;
+  auto ok = (len == 0) || (mmap(data_, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED);
+  close(fd);
+  if (ok && (len < capacity())) {
+    ok = mmap(data_ + len, capacity() - len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED;
+  }
+
+  // A failed MAP_FIXED leaves the range in an unspecified state. Start over
+  // with a fresh zero-filled mapping.
+  if (!ok) {
+    auto* res = mmap(data_, capacity(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    assert(res != MAP_FAILED);
+    (void) res;
+  }
+  return ok;
+}
+
+inline bool PackedArray::write_back(const std::string& path) const {
+  // The image may still be mapped by this array, in which case truncating it
+  // would pull the pages we haven't touched out from under us. Instead, write
+  // a new image alongside the old one and move it into place.
+  auto tmp = path + ".XXXXXX";
+  const auto fd = mkstemp(&tmp[0]);
+  if (fd == -1) {
+    return false;
+  }
+  auto ok = fchmod(fd, 0644) != -1;
+  const auto n = size_*stride_;
+  for (size_t i = 0; ok && (i < n); ) {
+    const auto res = ::write(fd, data_ + i, n - i);
+    ok = res > 0;
+    i += ok ? res : 0;
+  }
+  close(fd);
+  ok = ok && (rename(tmp.c_str(), path.c_str()) != -1);
+  if (!ok) {
+    unlink(tmp.c_str());
+  }
+  return ok;
+}
+
+inline size_t PackedArray::capacity() const {
+  const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return ((size_*stride_ + page - 1) / page) * page;
+}
+
+template <typename B>
+inline void PackedArray::read_words(const uint8_t* src, size_t n, Bits* b) const {
+  for (size_t i = 0; i < n; ++i) {
+    B word;
+    memcpy(&word, src + i*sizeof(B), sizeof(B));
+    // File images aren't guaranteed to be zero above the width of an
+    // element. Mask off anything past the end before handing it to b.
+    const auto rem = width_ - i*8*sizeof(B);
+    if (rem < 8*sizeof(B)) {
+      word &= static_cast<B>((B(1) << rem) - 1);
+    }
+    b->write_word<B>(i, word);
+  }
+}
+
+template <typename B>
+inline void PackedArray::write_words(uint8_t* dst, size_t n, const Bits& b) {
+  for (size_t i = 0; i < n; ++i) {
+    const auto word = b.read_word<B>(i);
+    memcpy(dst + i*sizeof(B), &word, sizeof(B));
+  }
+}
+
+} // namespace cascade
+
+#endif
@@ -31,8 +31,10 @@
 #ifndef CASCADE_SRC_COMMON_SYSTEM_H
 #define CASCADE_SRC_COMMON_SYSTEM_H
 
+#include <cerrno>
 #include <cstdlib>
 #include <string>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #ifdef __APPLE__
@@ -48,6 +50,7 @@ namespace cascade {
 struct System {
   static std::string src_root();
   static int execute(const std::string& cmd);
+  static bool make_dirs(const std::string& path);
 };
 
 #ifdef __APPLE__
@@ -71,6 +74,21 @@ inline int System::execute(const std::string& cmd) {
   return ::system(cmd.c_str());
 }
 
+inline bool System::make_dirs(const std::string& path) {
+  // Create each prefix of path in turn, ignoring the ones which already exist
+  for (size_t i = 1; i <= path.length(); ++i) {
+    if ((i < path.length()) && (path[i] != '/')) {
+      continue;
+    }
+    const auto dir = path.substr(0, i);
+    if ((mkdir(dir.c_str(), 0755) != 0) && (errno != EEXIST)) {
+      return false;
+    }
+  }
+  struct stat s;
+  return (stat(path.c_str(), &s) == 0) && S_ISDIR(s.st_mode);
+}
+
 } // namespace cascade
 
 #endif
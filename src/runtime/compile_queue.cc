@@ -0,0 +1,185 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "runtime/compile_queue.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace cascade {
+
+CompileQueue::CompileQueue(ThreadPool* pool) {
+  pool_ = pool;
+  next_id_ = 0;
+  set_max_active(1);
+}
+
+CompileQueue& CompileQueue::set_max_active(size_t n) {
+  lock_guard<mutex> lg(lock_);
+  max_active_ = max(n, static_cast<size_t>(1));
+  return *this;
+}
+
+void CompileQueue::insert(const void* owner, uint64_t key, const string& target, uint64_t cost, uint64_t priority, Job job, Job abort) {
+  vector<Job> aborts;
+  { lock_guard<mutex> lg(lock_);
+    for (auto i = pending_.begin(); i != pending_.end(); ) {
+      if ((i->owner == owner) && (i->key == key)) {
+        priority = max(priority, i->priority);
+        aborts.push_back(i->abort);
+        i = pending_.erase(i);
+      } else {
+        ++i;
+      }
+    }
+    pending_.push_back({next_id_++, owner, key, target, cost, priority, job, abort, chrono::steady_clock::time_point()});
+    dispatch();
+  }
+  for (auto& a : aborts) {
+    a();
+  }
+}
+
+void CompileQueue::cancel(const void* owner) {
+  vector<Job> aborts;
+  { lock_guard<mutex> lg(lock_);
+    for (auto i = pending_.begin(); i != pending_.end(); ) {
+      if (i->owner == owner) {
+        aborts.push_back(i->abort);
+        i = pending_.erase(i);
+      } else {
+        ++i;
+      }
+    }
+  }
+  for (auto& a : aborts) {
+    a();
+  }
+}
+
+void CompileQueue::clear() {
+  vector<Job> aborts;
+  { lock_guard<mutex> lg(lock_);
+    for (auto& r : pending_) {
+      aborts.push_back(r.abort);
+    }
+    pending_.clear();
+  }
+  for (auto& a : aborts) {
+    a();
+  }
+}
+
+size_t CompileQueue::pending() const {
+  lock_guard<mutex> lg(lock_);
+  return pending_.size();
+}
+
+size_t CompileQueue::active() const {
+  lock_guard<mutex> lg(lock_);
+  return active_.size();
+}
+
+uint64_t CompileQueue::eta() const {
+  lock_guard<mutex> lg(lock_);
+
+  // Estimate the time remaining for each request, crediting running requests
+  // for the time they've already spent.
+  const auto now = chrono::steady_clock::now();
+  uint64_t total = 0;
+  for (const auto* rs : {&active_, &pending_}) {
+    for (const auto& r : *rs) {
+      const auto itr = rates_.find(r.target);
+      if (itr == rates_.end()) {
+        continue;
+      }
+      auto t = static_cast<uint64_t>(itr->second * r.cost);
+      if (rs == &active_) {
+        const auto elapsed = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(now - r.begin).count());
+        t = (elapsed < t) ? (t - elapsed) : 0;
+      }
+      total += t;
+    }
+  }
+  // Requests run max_active_ at a time
+  return total / max_active_;
+}
+
+void CompileQueue::dispatch() {
+  while ((active_.size() < max_active_) && !pending_.empty()) {
+    // Hottest first, then cheapest, then oldest
+    const auto itr = min_element(pending_.begin(), pending_.end(), [](const Request& a, const Request& b) {
+      if (a.priority != b.priority) {
+        return a.priority > b.priority;
+      }
+      if (a.cost != b.cost) {
+        return a.cost < b.cost;
+      }
+      return a.id < b.id;
+    });
+    auto r = *itr;
+    pending_.erase(itr);
+
+    r.begin = chrono::steady_clock::now();
+    active_.push_back(r);
+    const auto id = r.id;
+    const auto job = r.job;
+    pool_->insert([this, id, job]{
+      job();
+      finish(id);
+    });
+  }
+}
+
+void CompileQueue::finish(uint64_t id) {
+  lock_guard<mutex> lg(lock_);
+  const auto itr = find_if(active_.begin(), active_.end(), [id](const Request& r) {
+    return r.id == id;
+  });
+  assert(itr != active_.end());
+
+  // Update the rate estimate for this target. Recent compilations are given
+  // as much weight as all of the ones that came before them.
+  const auto ns = static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - itr->begin).count());
+  const auto rate = ns / max(itr->cost, static_cast<uint64_t>(1));
+  const auto ritr = rates_.find(itr->target);
+  if (ritr == rates_.end()) {
+    rates_[itr->target] = rate;
+  } else {
+    ritr->second = 0.5 * (ritr->second + rate);
+  }
+
+  active_.erase(itr);
+  dispatch();
+}
+
+} // namespace cascade
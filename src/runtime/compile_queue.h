@@ -0,0 +1,124 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_RUNTIME_COMPILE_QUEUE_H
+#define CASCADE_SRC_RUNTIME_COMPILE_QUEUE_H
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/thread_pool.h"
+
+namespace cascade {
+
+// This class schedules background compilations onto a thread pool. At most
+// max_active requests run at once. The rest wait in a queue which is ordered
+// by priority (the amount of time that the requesting module has spent
+// running) and then by estimated cost (the size of the module's IR), so that
+// hot, cheap modules are promoted first. A request which is identical to one
+// that is still waiting replaces it rather than running twice. The queue
+// also learns how long compilations take for each target, which it uses to
+// estimate how long it will take to drain.
+
+class CompileQueue {
+  public:
+    // Typedefs:
+    typedef ThreadPool::Job Job;
+
+    // Constructors:
+    explicit CompileQueue(ThreadPool* pool);
+    ~CompileQueue() = default;
+
+    // Configuration Interface:
+    CompileQueue& set_max_active(size_t n);
+
+    // Scheduling Interface:
+    //
+    // Inserts a request on behalf of owner. Requests are identified by key.
+    // If owner already has a waiting request with this key, that request is
+    // aborted and the new one inherits its priority if it's higher. Exactly
+    // one of job or abort will eventually be invoked.
+    void insert(const void* owner, uint64_t key, const std::string& target, uint64_t cost, uint64_t priority, Job job, Job abort);
+    // Aborts every waiting request which belongs to owner. Requests which
+    // have already started running are unaffected.
+    void cancel(const void* owner);
+    // Aborts every waiting request.
+    void clear();
+
+    // Status Interface:
+    //
+    // Returns the number of waiting requests
+    size_t pending() const;
+    // Returns the number of running requests
+    size_t active() const;
+    // Returns the estimated number of nanoseconds until every request has
+    // completed. Targets which haven't completed a compilation yet aren't
+    // accounted for.
+    uint64_t eta() const;
+
+  private:
+    // Request State:
+    struct Request {
+      uint64_t id;
+      const void* owner;
+      uint64_t key;
+      std::string target;
+      uint64_t cost;
+      uint64_t priority;
+      Job job;
+      Job abort;
+      std::chrono::steady_clock::time_point begin;
+    };
+
+    ThreadPool* pool_;
+    size_t max_active_;
+
+    mutable std::mutex lock_;
+    std::vector<Request> pending_;
+    std::vector<Request> active_;
+    // Observed nanoseconds of compilation time per unit of cost, by target
+    std::unordered_map<std::string, double> rates_;
+    uint64_t next_id_;
+
+    // Moves requests from pending_ to active_ until max_active_ is reached.
+    // This method must be invoked with lock_ held.
+    void dispatch();
+    // Records the completion of the request with this id
+    void finish(uint64_t id);
+};
+
+} // namespace cascade
+
+#endif
@@ -0,0 +1,163 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "runtime/ir_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+#include "common/log.h"
+#include "common/system.h"
+#include "verilog/ast/ast.h"
+#include "verilog/parse/parser.h"
+#include "verilog/print/print.h"
+
+using namespace std;
+
+namespace cascade {
+
+IrCache::IrCache() {
+  set_cache_path("");
+}
+
+IrCache& IrCache::set_cache_path(const string& path) {
+  path_ = path;
+  if (enabled() && !System::make_dirs(path_)) {
+    path_ = "";
+  }
+  return *this;
+}
+
+bool IrCache::enabled() const {
+  return !path_.empty();
+}
+
+uint64_t IrCache::hash(const string& src) {
+  // 64-bit FNV-1a, seeded with the cache version
+  uint64_t res = 0xcbf29ce484222325;
+  for (auto c : to_string(version_) + "\n" + src) {
+    res ^= static_cast<uint8_t>(c);
+    res *= 0x100000001b3;
+  }
+  return res;
+}
+
+ModuleDeclaration* IrCache::get(uint64_t key, const string& src, size_t* tier) const {
+  // Check for a miss. We compare the source text as well as its hash to
+  // guard against collisions.
+  string s;
+  string ir;
+  if (!read(key, tier, &s, &ir) || (s != src)) {
+    return nullptr;
+  }
+
+  // Treat entries which have been corrupted as misses
+  Log log;
+  Parser p(&log);
+  stringstream ss(ir);
+  p.parse(ss);
+  if (log.error() || (p.begin() == p.end()) || !(*p.begin())->is(Node::Tag::module_declaration)) {
+    for (auto* n : p) {
+      delete n;
+    }
+    return nullptr;
+  }
+  return static_cast<ModuleDeclaration*>(*p.begin());
+}
+
+void IrCache::put(uint64_t key, const string& src, const ModuleDeclaration* ir) const {
+  stringstream ss;
+  ss << ir;
+  write(key, 0, src, ss.str());
+}
+
+void IrCache::promote(uint64_t key, size_t tier) const {
+  size_t t = 0;
+  string src;
+  string ir;
+  if (read(key, &t, &src, &ir) && (tier > t)) {
+    write(key, tier, src, ir);
+  }
+}
+
+string IrCache::get_path(uint64_t key) const {
+  stringstream ss;
+  ss << path_ << "/" << hex << setw(16) << setfill('0') << key << ".v";
+  return ss.str();
+}
+
+bool IrCache::read(uint64_t key, size_t* tier, string* src, string* ir) const {
+  if (!enabled()) {
+    return false;
+  }
+  ifstream ifs(get_path(key), ios::binary);
+  if (!ifs.is_open()) {
+    return false;
+  }
+
+  // Entries are a version and tier followed by the length-prefixed source
+  // and IR. Entries written by other versions are treated as misses.
+  size_t v = 0;
+  size_t n = 0;
+  size_t m = 0;
+  ifs >> v >> *tier >> n >> m;
+  ifs.get();
+  if (ifs.fail() || (v != version_)) {
+    return false;
+  }
+  src->resize(n);
+  ir->resize(m);
+  ifs.read(&(*src)[0], n);
+  ifs.read(&(*ir)[0], m);
+  return !ifs.fail();
+}
+
+void IrCache::write(uint64_t key, size_t tier, const string& src, const string& ir) const {
+  if (!enabled()) {
+    return;
+  }
+
+  // Write to a temporary file and then move it into place, so that readers
+  // never see a partially written entry.
+  const auto path = get_path(key);
+  stringstream tmp;
+  tmp << path << "." << getpid() << "." << this_thread::get_id() << ".tmp";
+  { ofstream ofs(tmp.str(), ios::binary);
+    ofs << version_ << " " << tier << " " << src.length() << " " << ir.length() << "\n";
+    ofs.write(src.data(), src.length());
+    ofs.write(ir.data(), ir.length());
+  }
+  rename(tmp.str().c_str(), path.c_str());
+}
+
+} // namespace cascade
@@ -0,0 +1,90 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_RUNTIME_IR_CACHE_H
+#define CASCADE_SRC_RUNTIME_IR_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "verilog/ast/ast_fwd.h"
+
+namespace cascade {
+
+// This class is a persistent, content-addressed cache of transformed module
+// IR. Entries are keyed by a hash of the isolated source code of a module
+// (which includes its target annotations) and store the result of running
+// the IR pipeline along with the highest jit tier that the module was
+// promoted to. Each entry is stored in its own file, so the cache can be
+// shared between concurrent runs. Entries are also tagged with a version
+// number which must be bumped whenever a change to the IR passes or the
+// printer would change the contents of an entry.
+
+class IrCache {
+  public:
+    // Constructors:
+    IrCache();
+    ~IrCache() = default;
+
+    // Configuration Interface:
+    //
+    // Sets the directory that entries are stored in, creating it if
+    // necessary. An empty path, or one which can't be created, disables the
+    // cache.
+    IrCache& set_cache_path(const std::string& path);
+
+    // Cache Interface:
+    //
+    // Returns true if the cache is enabled.
+    bool enabled() const;
+    // Returns the key for the isolated source code src.
+    static uint64_t hash(const std::string& src);
+    // Returns the IR associated with src, or nullptr on a miss. On a hit,
+    // tier is set to the highest tier recorded for this entry. The caller
+    // takes ownership of the result.
+    ModuleDeclaration* get(uint64_t key, const std::string& src, size_t* tier) const;
+    // Associates src with ir. This method does not take ownership of ir.
+    void put(uint64_t key, const std::string& src, const ModuleDeclaration* ir) const;
+    // Records that the module associated with key reached tier. Does nothing
+    // if tier is lower than the tier which is already recorded.
+    void promote(uint64_t key, size_t tier) const;
+
+  private:
+    static constexpr size_t version_ = 1;
+    std::string path_;
+
+    std::string get_path(uint64_t key) const;
+    bool read(uint64_t key, size_t* tier, std::string* src, std::string* ir) const;
+    void write(uint64_t key, size_t tier, const std::string& src, const std::string& ir) const;
+};
+
+} // namespace cascade
+
+#endif
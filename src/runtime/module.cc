@@ -30,13 +30,18 @@
 
 #include "runtime/module.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include "common/thread_pool.h"
+#include "runtime/compile_queue.h"
 #include "runtime/data_plane.h"
+#include "runtime/ir_cache.h"
 #include "runtime/isolate.h"
 #include "runtime/runtime.h"
 #include "target/compiler.h"
@@ -48,16 +53,9 @@
 #include "verilog/print/print.h"
 #include "verilog/program/elaborate.h"
 #include "verilog/program/inline.h"
-#include "verilog/transform/assign_unpack.h"
-#include "verilog/transform/block_flatten.h"
-#include "verilog/transform/constant_prop.h"
-#include "verilog/transform/control_merge.h"
-#include "verilog/transform/de_alias.h"
+#include "verilog/program/program.h"
 #include "verilog/transform/delete_initial.h"
-#include "verilog/transform/dead_code_eliminate.h"
-#include "verilog/transform/event_expand.h"
-#include "verilog/transform/index_normalize.h"
-#include "verilog/transform/loop_unroll.h"
+#include "verilog/transform/pass_manager.h"
 
 using namespace std;
 
@@ -122,13 +120,36 @@ Module::Module(const ModuleDeclaration* psrc, Runtime* rt, Module* parent) {
 
   engine_ = rt_->get_compiler()->compile_stub(rt_->get_next_id(), psrc);
   version_ = 0;
+  src_hash_ = 0;
+  pending_hash_ = 0;
+  build_ = 0;
+  built_ = 0;
+
+  jit_src_ = nullptr;
+  tier_ = 0;
+  requested_ = 0;
+  profile_ = 0;
+  hot_ = 0;
+  src_size_ = 0;
+  inline_requested_ = false;
+  ir_key_ = 0;
+  cached_tier_ = 0;
 }
 
 Module::~Module() {
   for (auto* c : children_) {
     delete c;
   }
+  for (auto* m : inlined_) {
+    delete m;
+  }
   delete engine_;
+  if (jit_src_ != nullptr) {
+    delete jit_src_;
+  }
+  for (auto& s : spec_) {
+    delete s.engine;
+  }
 }
 
 Module::iterator Module::begin() {
@@ -151,6 +172,18 @@ size_t Module::size() const {
   return res;
 }
 
+Module* Module::find(const Node* n) {
+  while ((n != nullptr) && !n->is(Node::Tag::module_declaration)) {
+    n = n->get_parent();
+  }
+  for (auto i = iterator(this), ie = end(); i != ie; ++i) {
+    if ((*i)->psrc_ == n) {
+      return *i;
+    }
+  }
+  return nullptr;
+}
+
 void Module::synchronize(size_t n) {
   // Examine new code and instantiate new modules below the root 
   Instantiator inst(this);
@@ -158,24 +191,22 @@ void Module::synchronize(size_t n) {
   for (auto i = psrc_->begin_items()+idx, ie = psrc_->end_items(); i != ie; ++i) {
     (*i)->accept(&inst);
   }
-  // Recompile everything 
+  // Recompile everything. Modules whose isolated source hasn't changed will
+  // keep their current engines.
+  vector<pair<Module*, size_t>> ms;
   for (auto i = iterator(this), ie = end(); i != ie; ++i) {
     const auto ignore = (*i == this) ? (psrc_->size_items() - n) : 0;
-    (*i)->compile_and_replace(ignore);
+    ms.push_back(make_pair(*i, ignore));
   }
+  compile_and_replace(ms, rt_->get_async_fast_pass());
   // Synchronize subscriptions with the dataplane. Note that we do this *after*
   // recompilation.  This guarantees that the variable names used by
-  // Isolate::isolate() are deterministic.
+  // Isolate::isolate() are deterministic. Modules with fast-pass compilations
+  // in flight are skipped. Their current engines may not know about the new
+  // variables, and they'll subscribe when their replacements are swapped in.
   for (auto i = iterator(this), ie = end(); i != ie; ++i) {
-    for (auto* r : ModuleInfo((*i)->psrc_).reads()) {
-      const auto gid = rt_->get_isolate()->isolate(r);
-      rt_->get_data_plane()->register_id(gid);
-      rt_->get_data_plane()->register_writer((*i)->engine_, gid);
-    }
-    for (auto* w : ModuleInfo((*i)->psrc_).writes()) {
-      const auto gid = rt_->get_isolate()->isolate(w);
-      rt_->get_data_plane()->register_id(gid);
-      rt_->get_data_plane()->register_reader((*i)->engine_, gid);
+    if ((*i)->built_ == (*i)->build_) {
+      (*i)->subscribe();
     }
   }
 }
@@ -184,12 +215,178 @@ void Module::rebuild() {
   // This method should only be called in a state where all modules are in sync
   // with the user's program. However(!) we do still need to regenerate source.
   // Recall that compilation takes over ownership of a module's source code.
+  vector<pair<Module*, size_t>> ms;
+  for (auto i = iterator(this), ie = end(); i != ie; ++i) {
+    ms.push_back(make_pair(*i, (*i)->psrc_->size_items()));
+  }
+  compile_and_replace(ms, false);
+  // If this call superseded any background fast-pass compilations, the
+  // modules that they belonged to haven't subscribed to the dataplane yet.
   for (auto i = iterator(this), ie = end(); i != ie; ++i) {
-    const auto ignore = (*i)->psrc_->size_items();
-    (*i)->compile_and_replace(ignore);
+    (*i)->subscribe();
   }
 }
 
+void Module::migrate(const string& loc) {
+  // Like rebuild(), this method should only be called in a state where all
+  // modules are in sync with the user's program.
+  for (auto i = iterator(this), ie = end(); i != ie; ++i) {
+    (*i)->compile_and_migrate(loc);
+  }
+}
+
+void Module::profile(uint64_t ns) {
+  hot_ += ns;
+  // Logic which was compiled on its own is inlined into its parent once it's
+  // been charged more than the runtime's inlining threshold.
+  const auto threshold = rt_->get_inline_threshold();
+  if ((threshold > 0) && (hot_ >= threshold) && !inline_requested_ && (parent_ != nullptr) && Inline().can_inline(psrc_)) {
+    inline_requested_ = true;
+    rt_->schedule_interrupt([this]{
+      inline_source();
+    });
+  }
+  // Nothing to do if there are no more tiers to request
+  if (requested_+1 >= tiers_.size()) {
+    return;
+  }
+  profile_ += ns;
+  if (profile_ >= rt_->get_promotion_threshold()) {
+    profile_ = 0;
+    compile_tier(requested_+1);
+  }
+}
+
+void Module::deoptimize() {
+  // Nothing to do if we're already running in software
+  if (tier_ == 0) {
+    return;
+  }
+
+  // Bump the sequence number for this module. This guarantees that any jit
+  // compilations still in flight will abort.
+  ++version_;
+  rt_->get_compile_queue()->cancel(this);
+  requested_ = 0;
+  profile_ = 0;
+
+  // Record human readable name for this module
+  const auto* iid = static_cast<const ModuleInstantiation*>(psrc_->get_parent())->get_iid();
+  const auto fid = Resolve().get_readable_full_id(iid);
+
+  // Recompile the first tier. Software compilation is fast, so there's no
+  // need to do this in the background. Initial blocks have already run, and
+  // replacing the engine will move the current state into the new one.
+  auto* md = jit_src_->clone();
+  md->get_attrs()->set_or_replace("__target", new String(tiers_[0].first));
+  md->get_attrs()->set_or_replace("__loc", new String(tiers_[0].second));
+  md->get_attrs()->erase("__delay");
+  md->get_attrs()->erase("__state_safe_int");
+  DeleteInitial().run(md);
+
+  stringstream ss;
+  ss << "deoptimization of " << fid << " with attributes " << md->get_attrs();
+  auto* e = rt_->get_compiler()->compile(engine_->get_id(), md);
+  if (e == nullptr) {
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << ss.str() << endl;
+    return;
+  }
+  engine_->replace_with(e);
+  tier_ = 0;
+  ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << ss.str() << endl;
+}
+
+bool Module::inline_source() {
+  if ((parent_ == nullptr) || !Inline().can_inline(psrc_)) {
+    return false;
+  }
+
+  // Record human readable name for this module
+  const auto* iid = static_cast<const ModuleInstantiation*>(psrc_->get_parent())->get_iid();
+  const auto fid = Resolve().get_readable_full_id(iid);
+
+  // The variables that this module and its parent share with the rest of
+  // the program are about to change. Unsubscribe both while we still know
+  // what they are.
+  auto* p = parent_;
+  unsubscribe();
+  p->unsubscribe();
+  if (!rt_->get_program()->inline_module(psrc_)) {
+    subscribe();
+    p->subscribe();
+    return false;
+  }
+  auto* s = engine_->get_state();
+
+  // Detach this module and hand its children over to its parent. Bump the
+  // sequence numbers for this module. This guarantees that any compilations
+  // still in flight will abort.
+  p->children_.erase(std::find(p->children_.begin(), p->children_.end(), this));
+  for (auto* c : children_) {
+    c->parent_ = p;
+    p->children_.push_back(c);
+  }
+  children_.clear();
+  p->inlined_.push_back(this);
+  ++version_;
+  ++build_;
+  rt_->get_compile_queue()->cancel(this);
+
+  // Recompile the parent. Initial blocks have already run, and variables keep
+  // their ids when they're inlined, so this module's state can be moved
+  // directly into the new engine.
+  compile_and_replace({make_pair(p, p->psrc_->size_items())}, false);
+  p->engine_->set_state(s);
+  delete s;
+  p->subscribe();
+  rt_->reconfigure();
+
+  ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Inlined " << fid << endl;
+  return true;
+}
+
+Module* Module::outline_source(const ModuleDeclaration* src) {
+  // As above, unsubscribe before the variables that this module shares with
+  // the rest of the program change.
+  unsubscribe();
+  if (!rt_->get_program()->outline_module(src)) {
+    subscribe();
+    return nullptr;
+  }
+  auto* s = engine_->get_state();
+
+  // Create a module for the outlined code, and hand over any children whose
+  // instantiations were inlined along with it.
+  auto* m = new Module(src, rt_, this);
+  for (auto i = children_.begin(); i != children_.end(); ) {
+    const auto* n = (*i)->psrc_->get_parent()->get_parent();
+    while (!n->is(Node::Tag::module_declaration)) {
+      n = n->get_parent();
+    }
+    if (n == src) {
+      (*i)->parent_ = m;
+      m->children_.push_back(*i);
+      i = children_.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  children_.push_back(m);
+
+  // Recompile both modules. The new module picks its state out of what used
+  // to belong to this one.
+  compile_and_replace({make_pair(this, psrc_->size_items()), make_pair(m, src->size_items())}, false);
+  m->engine_->set_state(s);
+  delete s;
+  subscribe();
+  m->subscribe();
+  rt_->reconfigure();
+
+  const auto* iid = static_cast<const ModuleInstantiation*>(src->get_parent())->get_iid();
+  ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Outlined " << Resolve().get_readable_full_id(iid) << endl;
+  return m;
+}
+
 void Module::save(ostream& os) {
   os << size() << endl;
 
@@ -311,115 +508,517 @@ void Module::Instantiator::visit(const ModuleInstantiation* mi) {
 
 
 ModuleDeclaration* Module::regenerate_ir_source(size_t ignore) {
+  string src;
+  auto* md = isolate_ir_source(ignore, &src);
+  return transform_ir_source(md, src, &ir_key_, &cached_tier_, nullptr, nullptr);
+}
+
+ModuleDeclaration* Module::isolate_ir_source(size_t ignore, string* src) {
   auto* md = rt_->get_isolate()->isolate(psrc_, ignore);
+
+  // Redirect any locations which engines have been migrated away from
+  const auto* l = md->get_attrs()->get<String>("__loc");
+  if (l != nullptr) {
+    stringstream in(l->get_readable_val());
+    stringstream out;
+    string loc;
+    for (auto first = true; getline(in, loc, ';'); first = false) {
+      out << (first ? "" : ";") << rt_->get_location(loc);
+    }
+    if (out.str() != l->get_readable_val()) {
+      md->get_attrs()->set_or_replace("__loc", new String(out.str()));
+    }
+  }
+
+  stringstream ss;
+  ss << md;
+  *src = ss.str();
+  return md;
+}
+
+ModuleDeclaration* Module::transform_ir_source(ModuleDeclaration* md, const string& src, uint64_t* key, size_t* tier, string* stats, vector<string>* capped) {
   const auto* std = md->get_attrs()->get<String>("__std");
   const auto is_logic = (std != nullptr) && (std->get_readable_val() == "logic");
   if (is_logic) {
+    // The pipeline is chosen by the target of the last jit tier, since
+    // that's the compiler whose output it has the most effect on. 
+    const auto ts = split(md->get_attrs()->get<String>("__target")->get_readable_val());
+    const auto pipeline = rt_->get_pass_pipeline(ts.back());
+
+    // Check the cache before running the IR pipeline. The pipeline is part of
+    // the key, since different pipelines produce different IR. This holds for
+    // the default pipeline as well, which may change between builds.
+    auto* cache = rt_->get_ir_cache();
+    const auto csrc = "// " + pipeline + "\n" + src;
+    if (cache->enabled()) {
+      *key = IrCache::hash(csrc);
+      *tier = 0;
+      if (auto* ir = cache->get(*key, csrc, tier)) {
+        delete md;
+        return ir;
+      }
+    }
+
     ModuleInfo(md).invalidate();
-    AssignUnpack().run(md);
-    IndexNormalize().run(md);
-    LoopUnroll().run(md);
-    DeAlias().run(md);
-    ConstantProp().run(md);
-    EventExpand().run(md);
-    ControlMerge().run(md);
-    DeadCodeEliminate().run(md);
-    BlockFlatten().run(md);
+    PassManager pm;
+    pm.set_pipeline(pipeline);
+    pm.set_stats(rt_->get_pass_stats() && (stats != nullptr));
+    pm.run(md);
+    if (rt_->get_pass_stats() && (stats != nullptr)) {
+      stringstream ss;
+      pm.write_stats(ss);
+      *stats = ss.str();
+    }
+    if (capped != nullptr) {
+      *capped = pm.capped();
+    }
+
+    if (cache->enabled()) {
+      cache->put(*key, csrc, md);
+    }
   }
   return md;
 }
 
-void Module::compile_and_replace(size_t ignore) {
-  // Generate new code and bump the sequence number for this module
-  auto* md = regenerate_ir_source(ignore); 
-  ++version_;
-  const auto this_version = version_;
+void Module::compile_and_replace(const vector<pair<Module*, size_t>>& ms, bool async) {
+  // Isolation reads the shared program ast and the isolate's symbol tables,
+  // so it runs serially. Modules whose source hasn't changed drop out here.
+  vector<pair<Module*, Build>> bs;
+  for (const auto& m : ms) {
+    Build b;
+    if (m.first->begin_build(m.second, &b)) {
+      bs.push_back(make_pair(m.first, b));
+    }
+  }
 
-  // Record human readable name for this module
+  // Background Path: Everything from here until the swap runs on the
+  // runtime's thread pool, and the current engines keep running until their
+  // replacements are ready. Swaps take place between time steps. A build
+  // which is superseded by a newer one before it finishes is discarded.
+  if (async) {
+    for (auto& b : bs) {
+      auto* m = b.first;
+      auto* ptr = new Build(b.second);
+      m->rt_->schedule_asynchronous(Runtime::Asynchronous([m, ptr]{
+        m->run_build(ptr);
+        m->rt_->schedule_interrupt([m, ptr]{
+          if (m->finish_build(ptr)) {
+            m->subscribe();
+            m->rt_->reconfigure();
+          }
+          delete ptr;
+        },
+        [ptr]{
+          lock_guard<mutex> lg(alt_lock_);
+          if (ptr->engine != nullptr) {
+            delete ptr->engine;
+          }
+          if (ptr->jit_src != nullptr) {
+            delete ptr->jit_src;
+          }
+          delete ptr;
+        });
+      }));
+    }
+    return;
+  }
+
+  // Everything from here until the swap only touches a module's isolated
+  // source and its build results. Run these stages in parallel. We use a
+  // dedicated pool rather than the runtime's, which may be tied up with
+  // long-running slow-pass compilations.
+  if (bs.size() == 1) {
+    bs[0].first->run_build(&bs[0].second);
+  } else if (bs.size() > 1) {
+    const size_t n = max(1u, thread::hardware_concurrency());
+    ThreadPool pool;
+    pool.set_num_threads(min(n, bs.size()));
+    for (auto& b : bs) {
+      auto* ptr = &b;
+      pool.insert([ptr]{ptr->first->run_build(&ptr->second);});
+    }
+    pool.run();
+    pool.stop_now();
+  }
+
+  // Swap in the results. This is the only stage which touches the engines
+  // that the runtime is currently using.
+  for (auto& b : bs) {
+    b.first->finish_build(&b.second);
+  }
+}
+
+bool Module::begin_build(size_t ignore, Build* b) {
+  // Isolate this module. There's nothing to do if its source is the same as
+  // the source of the most recent request, or if there isn't one in flight,
+  // the source of the running engine. Either way, the engine which is running
+  // now (which may have been promoted to a later jit tier, or may be about to
+  // be replaced by a background compilation of the same source) is still
+  // valid. The hash is only a shortcut; the text has the final say.
+  b->md = isolate_ir_source(ignore, &b->src);
+  b->src_hash = IrCache::hash(b->src);
+  const auto pending = build_ > built_;
+  if ((b->src_hash == (pending ? pending_hash_ : src_hash_)) && (b->src == (pending ? pending_src_ : src_))) {
+    delete b->md;
+    return false;
+  }
+  pending_hash_ = b->src_hash;
+  pending_src_ = b->src;
+  b->id = ++build_;
+  b->ir_key = b->src_hash;
+
+  // Record human readable name for this module. Resolve decorates the shared
+  // program ast lazily, so this has to happen here as well.
   const auto* iid = static_cast<const ModuleInstantiation*>(psrc_->get_parent())->get_iid();
-  const auto fid = Resolve().get_readable_full_id(iid);
+  b->fid = Resolve().get_readable_full_id(iid);
+  b->cached_tier = 0;
+  b->jit_src = nullptr;
+  b->engine = nullptr;
+  return true;
+}
+
+void Module::run_build(Build* b) {
+  // Generate new code
+  auto* md = transform_ir_source(b->md, b->src, &b->ir_key, &b->cached_tier, &b->stats, &b->capped);
+  b->md = nullptr;
 
   // Lookup annotations 
   const auto* std = md->get_attrs()->get<String>("__std");
-  const auto* t = md->get_attrs()->get<String>("__target");
-  const auto* l = md->get_attrs()->get<String>("__loc");
+  const auto t = md->get_attrs()->get<String>("__target")->get_readable_val();
+  const auto l = md->get_attrs()->get<String>("__loc")->get_readable_val();
 
-  // Check: Is this an std module, was jit compilation requested?  
-  const auto tsep = t->get_readable_val().find_first_of(';');
-  const auto lsep = l->get_readable_val().find_first_of(';');
-  const auto jit = std->eq("logic") && ((tsep != string::npos) || (lsep != string::npos));
-
-  // If we're jit compiling, we'll need a second copy of the source need to
-  // adjust the annotations. We'll also need to erase debugging annotations from
-  // the first pass source.
-  ModuleDeclaration* md2 = nullptr;
-  if (jit) {
-    md2 = md->clone();
-    if (tsep != string::npos) {
-      md2->get_attrs()->set_or_replace("__target", new String(t->get_readable_val().substr(tsep+1)));
-      md->get_attrs()->set_or_replace("__target", new String(t->get_readable_val().substr(0, tsep)));
-    }
-    if (lsep != string::npos) {
-      md2->get_attrs()->set_or_replace("__loc", new String(l->get_readable_val().substr(lsep+1)));
-      md->get_attrs()->set_or_replace("__loc", new String(l->get_readable_val().substr(0, lsep)));
+  // Compute jit tiers. Only logic modules are jit compiled. Everything else
+  // has a single tier which uses its annotations verbatim.
+  if (std->eq("logic")) {
+    const auto ts = split(t);
+    const auto ls = split(l);
+    for (size_t i = 0, ie = max(ts.size(), ls.size()); i < ie; ++i) {
+      b->tiers.push_back(make_pair(ts[min(i, ts.size()-1)], ls[min(i, ls.size()-1)]));
     }
+  } else {
+    b->tiers.push_back(make_pair(t, l));
+  }
+
+  // If we're jit compiling, we'll need a copy of the source for the later
+  // tiers. We'll also need to adjust the annotations and erase debugging
+  // annotations from the first tier source.
+  if (b->tiers.size() > 1) {
+    b->jit_src = md->clone();
+    md->get_attrs()->set_or_replace("__target", new String(b->tiers[0].first));
+    md->get_attrs()->set_or_replace("__loc", new String(b->tiers[0].second));
     md->get_attrs()->erase("__delay");
     md->get_attrs()->erase("__state_safe_int");
-  } else {
-    md2 = new ModuleDeclaration(new Attributes(), new Identifier("null"));
   }
-  // Check whether the first pass compilation is sw
-  if (std->eq("logic") && !md->get_attrs()->get<String>("__target")->eq("sw")) {
+  // Check whether the first tier compilation is sw
+  if (std->eq("logic") && (b->tiers[0].first != "sw")) {
     rt_->get_compiler()->fatal("Fast-pass compilation for logic must target software!");
     delete md;
-    delete md2;
     return;
   }
 
-  // Fast Path. Compile and replace the original engine.  
+  // Fast Path. Compile the replacement for the original engine.  
   stringstream ss;
-  ss << "fast-pass recompilation of " << fid << " with attributes " << md->get_attrs();
-  auto* e_fast = rt_->get_compiler()->compile(engine_->get_id(), md);
-  if (e_fast == nullptr) {
+  ss << "fast-pass recompilation of " << b->fid << " with attributes " << md->get_attrs();
+  b->what = ss.str();
+  b->engine = rt_->get_compiler()->compile(engine_->get_id(), md);
+  if (b->engine == nullptr) {
     rt_->get_compiler()->fatal("Unable to complete fast-pass compilation!");
+  }
+}
+
+bool Module::finish_build(Build* b) {
+  // Discard the results of this build if it failed or if a newer one has
+  // been requested in the meantime.
+  if ((b->engine == nullptr) || (b->id < build_)) {
+    // If the most recent request failed, forget about it so that the next
+    // request for the same source tries again.
+    if (b->id == build_) {
+      pending_hash_ = 0;
+      pending_src_.clear();
+    }
+    if (b->engine != nullptr) {
+      ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << b->what << endl;
+      delete b->engine;
+    }
+    if (b->jit_src != nullptr) {
+      delete b->jit_src;
+    }
+    b->engine = nullptr;
+    b->jit_src = nullptr;
+    return false;
+  }
+
+  // Bump the sequence number for this module. This guarantees that any jit
+  // compilations still in flight will abort, and any which haven't started
+  // yet never will. Then reset jit state.
+  ++version_;
+  rt_->get_compile_queue()->cancel(this);
+  tiers_ = b->tiers;
+  tier_ = 0;
+  requested_ = 0;
+  profile_ = 0;
+  if (jit_src_ != nullptr) {
+    delete jit_src_;
+  }
+  jit_src_ = b->jit_src;
+  ir_key_ = b->ir_key;
+  cached_tier_ = b->cached_tier;
+  src_size_ = b->src.size();
+  b->jit_src = nullptr;
+
+  // Swap in the new engine
+  engine_->replace_with(b->engine);
+  b->engine = nullptr;
+  built_ = b->id;
+  src_hash_ = b->src_hash;
+  src_ = b->src;
+  if (engine_->is_stub()) {
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Deferring " << b->what << endl;
   } else {
-    engine_->replace_with(e_fast);
-    if (engine_->is_stub()) {
-      ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Deferring " << ss.str() << endl;
-    } else {
-      ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << ss.str() << endl;
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << b->what << endl;
+  }
+  if (!b->stats.empty()) {
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "IR pipeline statistics for " << b->fid << ":" << endl << b->stats;
+  }
+  for (const auto& g : b->capped) {
+    ostream(rt_->rdbuf(Runtime::stdwarn_)) << "IR pipeline group " << g << " reached its iteration limit for " << b->fid << " and may not have converged" << endl;
+  }
+
+  // Later tiers are usually compiled when profiling data says that this
+  // module is hot. If profiling is disabled, compile all of them now. If this
+  // module was promoted in a previous run, skip straight to the highest tier
+  // that it reached.
+  if (rt_->get_promotion_threshold() == 0) {
+    while (requested_+1 < tiers_.size()) {
+      compile_tier(requested_+1);
     }
+  } else if (rt_->get_ir_cache()->enabled() && (cached_tier_ > 0) && (tiers_.size() > 1)) {
+    compile_tier(min(cached_tier_, tiers_.size()-1));
   }
+  return true;
+}
 
-  // Slow Path: Schedule a thread to compile in the background and swap in the
-  // results in a safe runtime window when it's done. 
-  if (jit && (e_fast != nullptr)) {
-    rt_->schedule_asynchronous(Runtime::Asynchronous([this, this_version, md2, fid]{
-      stringstream ss;
-      ss << "slow-pass recompilation of " << fid << " with attributes " << md2->get_attrs();
-      const auto str = ss.str();
-
-      DeleteInitial().run(md2);
-      auto* e_slow = rt_->get_compiler()->compile(engine_->get_id(), md2);
-
-      rt_->schedule_interrupt([this, this_version, e_slow, str]{
-        if ((this_version < version_) || (e_slow == nullptr)) {
-          ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << str << endl;
-        } else {
-          engine_->replace_with(e_slow);
-          ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << str << endl;
+void Module::subscribe() {
+  for (auto* r : ModuleInfo(psrc_).reads()) {
+    const auto gid = rt_->get_isolate()->isolate(r);
+    rt_->get_data_plane()->register_id(gid);
+    rt_->get_data_plane()->register_writer(engine_, gid);
+  }
+  for (auto* w : ModuleInfo(psrc_).writes()) {
+    const auto gid = rt_->get_isolate()->isolate(w);
+    rt_->get_data_plane()->register_id(gid);
+    rt_->get_data_plane()->register_reader(engine_, gid);
+  }
+}
+
+void Module::unsubscribe() {
+  for (auto* r : ModuleInfo(psrc_).reads()) {
+    const auto gid = rt_->get_isolate()->isolate(r);
+    rt_->get_data_plane()->unregister_writer(engine_, gid);
+  }
+  for (auto* w : ModuleInfo(psrc_).writes()) {
+    const auto gid = rt_->get_isolate()->isolate(w);
+    rt_->get_data_plane()->unregister_reader(engine_, gid);
+  }
+}
+
+void Module::compile_tier(size_t tier) {
+  // Compile this tier in the background and swap in the results in a safe
+  // runtime window when it's done. Several tiers may be in flight at once. If
+  // a higher tier finishes first, the lower ones are skipped.
+  requested_ = tier;
+  const auto this_version = version_;
+  const auto key = ir_key_;
+  const auto target = tiers_[tier];
+
+  const auto* iid = static_cast<const ModuleInstantiation*>(psrc_->get_parent())->get_iid();
+  const auto fid = Resolve().get_readable_full_id(iid);
+
+  // If we've already compiled this source for this tier, there's no need to
+  // do it again. We still have to wait for a safe window to swap it in.
+  if (auto* e = speculate(key, tier)) {
+    stringstream ss;
+    ss << "tier-" << tier << " recompilation of " << fid << " from speculative cache";
+    const auto str = ss.str();
+    rt_->schedule_interrupt([this, this_version, tier, key, target, e, str]{
+      install_tier(this_version, tier, key, target, e, str);
+    },
+    [e] {
+      lock_guard<mutex> lg(alt_lock_);
+      delete e;
+    });
+    return;
+  }
+
+  auto* md = jit_src_->clone();
+  md->get_attrs()->set_or_replace("__target", new String(target.first));
+  md->get_attrs()->set_or_replace("__loc", new String(target.second));
+
+  rt_->schedule_compilation(this, request_key(tier, target), target.first, src_size_, hot_, Runtime::Asynchronous([this, this_version, tier, key, target, md, fid]{
+    stringstream ss;
+    ss << "tier-" << tier << " recompilation of " << fid << " with attributes " << md->get_attrs();
+    const auto str = ss.str();
+
+    DeleteInitial().run(md);
+    auto* e = rt_->get_compiler()->compile(engine_->get_id(), md);
+
+    rt_->schedule_interrupt([this, this_version, tier, key, target, e, str]{
+      install_tier(this_version, tier, key, target, e, str);
+    },
+    [e] {
+      lock_guard<mutex> lg(alt_lock_);
+      if (e != nullptr) {
+        delete e;
+      }
+    });
+  }),
+  [md]{
+    delete md;
+  });
+}
+
+void Module::install_tier(size_t version, size_t tier, uint64_t key, const pair<string, string>& target, Engine* e, const string& what) {
+  // If the source this engine was compiled from has been replaced, hold on to
+  // it in case that source shows up again.
+  if ((version < version_) && (e != nullptr) && (rt_->get_speculative_cache_size() > 0)) {
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Retained " << what << endl;
+    retain(key, tier, target, e);
+    return;
+  }
+  if ((version < version_) || (tier <= tier_) || (e == nullptr)) {
+    ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << what << endl;
+    if (e != nullptr) {
+      delete e;
+    }
+    return;
+  }
+  engine_->replace_with(e);
+  tier_ = tier;
+  profile_ = 0;
+  rt_->get_ir_cache()->promote(key, tier);
+  ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << what << endl;
+}
+
+Engine* Module::speculate(uint64_t key, size_t tier) {
+  for (auto i = spec_.begin(), ie = spec_.end(); i != ie; ++i) {
+    if ((i->key == key) && (i->tier == tier) && (i->target == tiers_[tier])) {
+      auto* e = i->engine;
+      spec_.erase(i);
+      return e;
+    }
+  }
+  return nullptr;
+}
+
+void Module::retain(uint64_t key, size_t tier, const pair<string, string>& target, Engine* e) {
+  // Replace any older engine with the same tag, and evict the oldest engine if
+  // we're over capacity.
+  for (auto i = spec_.begin(), ie = spec_.end(); i != ie; ++i) {
+    if ((i->key == key) && (i->tier == tier) && (i->target == target)) {
+      delete i->engine;
+      spec_.erase(i);
+      break;
+    }
+  }
+  spec_.push_back({key, tier, target, e});
+  while (spec_.size() > rt_->get_speculative_cache_size()) {
+    delete spec_.front().engine;
+    spec_.erase(spec_.begin());
+  }
+}
+
+void Module::compile_and_migrate(const string& loc) {
+  // Redirect every tier. There's nothing else to do unless the engine that's
+  // currently running is located at loc.
+  if (tiers_.empty()) {
+    return;
+  }
+  const auto here = tiers_[tier_].second == loc;
+  for (auto& t : tiers_) {
+    t.second = rt_->get_location(t.second);
+  }
+  if (!here) {
+    return;
+  }
+
+  // Bump the sequence number for this module. This guarantees that any jit
+  // compilations still in flight will abort. They'll be requested again if
+  // this module stays hot.
+  ++version_;
+  rt_->get_compile_queue()->cancel(this);
+  const auto this_version = version_;
+  requested_ = tier_;
+  profile_ = 0;
+
+  // Record human readable name for this module
+  const auto* iid = static_cast<const ModuleInstantiation*>(psrc_->get_parent())->get_iid();
+  const auto fid = Resolve().get_readable_full_id(iid);
+
+  // Recompile the current tier for its new location
+  auto* md = (tier_ == 0) ? regenerate_ir_source(psrc_->size_items()) : jit_src_->clone();
+  md->get_attrs()->set_or_replace("__target", new String(tiers_[tier_].first));
+  md->get_attrs()->set_or_replace("__loc", new String(tiers_[tier_].second));
+  if (tiers_.size() > 1) {
+    md->get_attrs()->erase("__delay");
+    md->get_attrs()->erase("__state_safe_int");
+  }
+
+  // Compile in the background and swap in the results in a safe runtime
+  // window when it's done. Replacing the engine moves its state and inputs
+  // into the new engine and tears down the old one.
+  rt_->schedule_compilation(this, request_key(tier_, tiers_[tier_]), tiers_[tier_].first, src_size_, hot_, Runtime::Asynchronous([this, this_version, md, fid]{
+    stringstream ss;
+    ss << "migration of " << fid << " with attributes " << md->get_attrs();
+    const auto str = ss.str();
+
+    DeleteInitial().run(md);
+    auto* e = rt_->get_compiler()->compile(engine_->get_id(), md);
+
+    rt_->schedule_interrupt([this, this_version, e, str]{
+      if ((this_version < version_) || (e == nullptr)) {
+        ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Aborted " << str << endl;
+        if (e != nullptr) {
+          delete e;
         }
-      },
-      [e_slow] {
-        lock_guard<mutex> lg(alt_lock_);
-        if (e_slow != nullptr) {
-          delete e_slow;
+        // If the current tier can't be compiled at its new location, there's
+        // no point in leaving this module at its old one. Fall back on
+        // software.
+        if ((this_version == version_) && (e == nullptr)) {
+          deoptimize();
         }
-      });
-    }));
-  } else {
-    delete md2;
+      } else {
+        engine_->replace_with(e);
+        ostream(rt_->rdbuf(Runtime::stdinfo_)) << "Finished " << str << endl;
+      }
+    },
+    [e] {
+      lock_guard<mutex> lg(alt_lock_);
+      if (e != nullptr) {
+        delete e;
+      }
+    });
+  }),
+  [md]{
+    delete md;
+  });
+}
+
+uint64_t Module::request_key(size_t tier, const pair<string, string>& target) const {
+  stringstream ss;
+  ss << ir_key_ << ";" << tier << ";" << target.first << ";" << target.second;
+  return IrCache::hash(ss.str());
+}
+
+vector<string> Module::split(const string& s) {
+  vector<string> res;
+  stringstream ss(s);
+  for (string tok; getline(ss, tok, ';'); ) {
+    res.push_back(tok);
+  }
+  if (res.empty()) {
+    res.push_back("");
   }
+  return res;
 }
 
 } // namespace cascade
@@ -34,6 +34,9 @@
 #include <forward_list>
 #include <iosfwd>
 #include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
 #include <vector>
 #include "verilog/ast/visitors/editor.h"
 #include "verilog/ast/visitors/visitor.h"
@@ -71,6 +74,9 @@ class Module {
     Engine* engine();
     // Returns the number of modules in this hierarchy:
     size_t size() const;
+    // Returns the module in this hierarchy whose source contains n, or
+    // nullptr if there is no such module:
+    Module* find(const Node* n);
 
     // Synchronizes the module hierarchy with changes which have been made to
     // the ast since the previous invocation of synchronize. n is the number of
@@ -78,6 +84,36 @@ class Module {
     void synchronize(size_t n);
     // Forces a recompilation of the entire module hierarchy.
     void rebuild();
+    // Recompiles every engine in the module hierarchy which is located at loc
+    // and swaps in the results when they're ready. This method should be
+    // invoked after the runtime's location table has been updated.
+    void migrate(const std::string& loc);
+
+    // Profiling Interface:
+    //
+    // Charges ns nanoseconds of execution time to this module's engine. Once
+    // an engine has been charged more than the runtime's promotion threshold,
+    // compilation of the next jit tier begins in the background.
+    void profile(uint64_t ns);
+    // Moves this module's engine back to its first (software) jit tier,
+    // leaving the rest of the hierarchy untouched, and aborts any jit
+    // compilations which are in flight. Later tiers may be requested again
+    // once this module becomes hot. This method should only be invoked from
+    // within an interrupt.
+    void deoptimize();
+    // Inlining Interface:
+    //
+    // These methods restructure the module hierarchy and should only be
+    // invoked from within an interrupt. inline_source() inlines this module
+    // into its parent and recompiles the parent. This module's state is moved
+    // into the parent's engine, its children are handed over to the parent,
+    // and it is removed from the hierarchy. Returns false if this module can't
+    // be inlined. outline_source() outlines the module whose elaborated source
+    // is src, which must have been inlined into this one, and returns the new
+    // child, or nullptr on failure.
+    bool inline_source();
+    Module* outline_source(const ModuleDeclaration* src);
+
     // Dumps the state of the module hierarchy to an ostream. 
     void save(std::ostream& os);
     // Reads the state of the module hierarchy from an istream. 
@@ -109,10 +145,106 @@ class Module {
     // Engine State:
     Engine* engine_;
     size_t version_;
+    // The isolated source that engine_ was built from and its hash, the
+    // isolated source of the most recent request to rebuild engine_ and its
+    // hash, and the sequence numbers of those two requests. The sequence
+    // numbers differ while a background fast-pass compilation is in flight.
+    uint64_t src_hash_;
+    std::string src_;
+    uint64_t pending_hash_;
+    std::string pending_src_;
+    size_t build_;
+    size_t built_;
+
+    // JIT State:
+    //
+    // The target and location of each tier, the source used to compile tiers
+    // after the first, the tier which is currently running, the highest tier
+    // which has been requested, and the time charged to the current engine
+    // since the last promotion.
+    std::vector<std::pair<std::string, std::string>> tiers_;
+    ModuleDeclaration* jit_src_;
+    size_t tier_;
+    size_t requested_;
+    uint64_t profile_;
+    // The total time charged to this module, which is used to prioritize its
+    // compilations, and the size of its source, which is used to estimate
+    // their cost.
+    uint64_t hot_;
+    size_t src_size_;
+
+    // Inlining State:
+    //
+    // Whether this module has been scheduled to be inlined into its parent,
+    // and the modules which have been inlined into this one. Those are kept
+    // around until teardown, since background compilations may still hold on
+    // to them.
+    bool inline_requested_;
+    std::vector<Module*> inlined_;
+
+    // IR Cache State:
+    //
+    // The cache key for the most recently generated IR and the highest tier
+    // that it was promoted to in previous runs.
+    uint64_t ir_key_;
+    size_t cached_tier_;
+
+    // Speculation State:
+    //
+    // Slow-pass engines which finished compiling after the source they were
+    // compiled from was replaced, oldest first. Each one is tagged with the
+    // hash of that source and the tier, target, and location it was compiled
+    // for. If the same source reappears, they're swapped in immediately.
+    struct Speculation {
+      uint64_t key;
+      size_t tier;
+      std::pair<std::string, std::string> target;
+      Engine* engine;
+    };
+    std::vector<Speculation> spec_;
+
+    // Recompilation State:
+    //
+    // Recompilation is split into three stages. Isolation and the final swap
+    // touch shared state and run on the runtime thread. Transformation and
+    // fast-pass compilation only touch their isolated source and the results
+    // below, and run in parallel across modules, or in the background.
+    struct Build {
+      size_t id;
+      ModuleDeclaration* md;
+      std::string src;
+      uint64_t src_hash;
+      uint64_t ir_key;
+      size_t cached_tier;
+      std::vector<std::pair<std::string, std::string>> tiers;
+      ModuleDeclaration* jit_src;
+      std::string fid;
+      std::string what;
+      std::string stats;
+      std::vector<std::string> capped;
+      Engine* engine;
+    };
 
     // Helper Methods:
     ModuleDeclaration* regenerate_ir_source(size_t ignore);
-    void compile_and_replace(size_t ignore);
+    ModuleDeclaration* isolate_ir_source(size_t ignore, std::string* src);
+    ModuleDeclaration* transform_ir_source(ModuleDeclaration* md, const std::string& src, uint64_t* key, size_t* tier, std::string* stats, std::vector<std::string>* capped);
+    static void compile_and_replace(const std::vector<std::pair<Module*, size_t>>& ms, bool async);
+    bool begin_build(size_t ignore, Build* b);
+    void run_build(Build* b);
+    bool finish_build(Build* b);
+    void subscribe();
+    void unsubscribe();
+    void compile_tier(size_t tier);
+    void install_tier(size_t version, size_t tier, uint64_t key, const std::pair<std::string, std::string>& target, Engine* e, const std::string& what);
+    Engine* speculate(uint64_t key, size_t tier);
+    void retain(uint64_t key, size_t tier, const std::pair<std::string, std::string>& target, Engine* e);
+    void compile_and_migrate(const std::string& loc);
+    // Returns the compile queue key for a compilation of this module's
+    // current source for tier at target
+    uint64_t request_key(size_t tier, const std::pair<std::string, std::string>& target) const;
+    // Splits a semicolon separated list of jit annotations
+    static std::vector<std::string> split(const std::string& s);
 };
 
 } // namespace cascade
@@ -39,7 +39,9 @@
 #include "common/incstream.h"
 #include "common/indstream.h"
 #include "common/system.h"
+#include "runtime/compile_queue.h"
 #include "runtime/data_plane.h"
+#include "runtime/ir_cache.h"
 #include "runtime/isolate.h"
 #include "runtime/module.h"
 #include "runtime/nullbuf.h"
@@ -52,8 +54,10 @@
 #include "verilog/build/ast_builder.h"
 #include "verilog/parse/parser.h"
 #include "verilog/print/print.h"
+#include "verilog/program/elaborate.h"
 #include "verilog/program/inline.h"
 #include "verilog/program/program.h"
+#include "verilog/transform/pass_manager.h"
 
 using namespace std;
 
@@ -66,8 +70,11 @@ Runtime::Runtime() : Thread() {
   log_ = new Log();
   parser_ = new Parser(log_);
   compiler_ = new LocalCompiler(this);
+  compile_queue_ = new CompileQueue(&pool_);
+  compile_queue_->set_max_active(2);
   dp_ = new DataPlane();
   isolate_ = new Isolate();
+  ir_cache_ = new IrCache();
 
   program_ = new Program();
   root_ = nullptr;
@@ -77,13 +84,22 @@ Runtime::Runtime() : Thread() {
   open_loop_itrs_ = 2;
   open_loop_target_ = 1;
   disable_inlining_ = false;
+  set_promotion_threshold(0);
+  set_inline_threshold(0);
+  async_fast_pass_ = false;
+  speculative_cache_size_ = 0;
+  pass_stats_ = false;
+  enable_debug_ = false;
+  batch_mode_ = false;
 
   finished_ = false;
   item_evals_ = 0;
 
   schedule_all_ = false;
+  reconfigure_ = false;
   clock_ = nullptr;
   inlined_logic_ = nullptr;
+  profile_step_ = false;
 
   begin_time_ = ::time(nullptr);
   last_time_ = ::time(nullptr);
@@ -113,6 +129,7 @@ Runtime::~Runtime() {
   // return. When that's done, stop any asynchronous jobs associated with
   // compilers.
 
+  compile_queue_->clear();
   compiler_->stop_compile();
   pool_.stop_now();
   compiler_->stop_async();
@@ -130,8 +147,10 @@ Runtime::~Runtime() {
   delete log_;
   delete parser_;
   delete compiler_;
+  delete compile_queue_;
   delete dp_;
   delete isolate_;
+  delete ir_cache_;
 
   for (auto& s : streambufs_) {
     if (s.second) {
@@ -155,12 +174,87 @@ Runtime& Runtime::set_disable_inlining(bool di) {
   return *this;
 }
 
+Runtime& Runtime::set_inline_budget(size_t n) {
+  program_->set_inline_budget(n);
+  return *this;
+}
+
+Runtime& Runtime::set_inline_threshold(size_t ms) {
+  inline_threshold_ = uint64_t(ms) * 1000000;
+  return *this;
+}
+
 Runtime& Runtime::set_profile_interval(size_t n) {
   profile_interval_ = n;
   last_check_ = ::time(nullptr);
   return *this;
 }
 
+Runtime& Runtime::set_cache_path(const string& path) {
+  ir_cache_->set_cache_path(path);
+  return *this;
+}
+
+Runtime& Runtime::set_promotion_threshold(size_t ms) {
+  promotion_threshold_ = uint64_t(ms) * 1000000;
+  return *this;
+}
+
+Runtime& Runtime::set_async_fast_pass(bool afp) {
+  async_fast_pass_ = afp;
+  return *this;
+}
+
+Runtime& Runtime::set_speculative_cache_size(size_t n) {
+  speculative_cache_size_ = n;
+  return *this;
+}
+
+Runtime& Runtime::set_max_compilations(size_t n) {
+  compile_queue_->set_max_active(n);
+  return *this;
+}
+
+Runtime& Runtime::set_pass_pipeline(const string& spec) {
+  pass_pipelines_.clear();
+  pass_pipeline_error_.clear();
+  stringstream ss(spec);
+  for (string entry; getline(ss, entry, ';'); ) {
+    const auto eq = entry.find('=');
+    const auto target = (eq == string::npos) ? "" : entry.substr(0, eq);
+    const auto pipeline = (eq == string::npos) ? entry : entry.substr(eq+1);
+
+    // Malformed pipelines are dropped, and reported when the runtime starts
+    PassManager pm;
+    if (pm.set_pipeline(pipeline).error()) {
+      stringstream es;
+      es << "Unrecognized pass pipeline '" << pipeline << "'!";
+      for (const auto& u : pm.unknown()) {
+        es << " Unknown pass '" << u << "'.";
+      }
+      pass_pipeline_error_ = es.str();
+      continue;
+    }
+    pass_pipelines_[target] = pipeline;
+  }
+  return *this;
+}
+
+Runtime& Runtime::set_pass_stats(bool ps) {
+  pass_stats_ = ps;
+  return *this;
+}
+
+Runtime& Runtime::set_enable_debug(bool ed) {
+  enable_debug_ = ed;
+  return *this;
+}
+
+Runtime& Runtime::set_batch_mode(bool bm) {
+  batch_mode_ = bm;
+  return *this;
+}
+
 DataPlane* Runtime::get_data_plane() {
   return dp_;
 }
@@ -169,14 +263,56 @@ Compiler* Runtime::get_compiler() {
   return compiler_;
 }
 
+CompileQueue* Runtime::get_compile_queue() {
+  return compile_queue_;
+}
+
 Isolate* Runtime::get_isolate() {
   return isolate_;
 }
 
+IrCache* Runtime::get_ir_cache() {
+  return ir_cache_;
+}
+
+Program* Runtime::get_program() {
+  return program_;
+}
+
 Engine::Id Runtime::get_next_id() {
   return next_id_++;
 }
 
+uint64_t Runtime::get_promotion_threshold() const {
+  return promotion_threshold_;
+}
+
+uint64_t Runtime::get_inline_threshold() const {
+  return inline_threshold_;
+}
+
+bool Runtime::get_async_fast_pass() const {
+  return async_fast_pass_;
+}
+
+size_t Runtime::get_speculative_cache_size() const {
+  return speculative_cache_size_;
+}
+
+string Runtime::get_pass_pipeline(const string& t) const {
+  auto itr = pass_pipelines_.find(t);
+  if (itr == pass_pipelines_.end()) {
+    itr = pass_pipelines_.find("");
+  }
+  const auto def = batch_mode_ ? PassManager::batch_pipeline() : PassManager::default_pipeline();
+  const auto res = (itr == pass_pipelines_.end()) ? def : itr->second;
+  return enable_debug_ ? PassManager::remove(res, "dead_state_eliminate") : res;
+}
+
+bool Runtime::get_pass_stats() const {
+  return pass_stats_;
+}
+
 pair<bool, bool> Runtime::eval(istream& is) {
   log_->clear();
   const auto eof = parser_->parse(is);
@@ -274,6 +410,22 @@ void Runtime::schedule_asynchronous(Asynchronous async) {
   pool_.insert(async); 
 }
 
+void Runtime::schedule_compilation(const void* owner, uint64_t key, const string& target, uint64_t cost, uint64_t priority, Asynchronous job, Asynchronous abort) {
+  compile_queue_->insert(owner, key, target, cost, priority, job, abort);
+}
+
+string Runtime::compile_queue_status() const {
+  stringstream ss;
+  ss << "Compile queue: " << compile_queue_->pending() << " waiting, "
+     << compile_queue_->active() << " running, ETA "
+     << (compile_queue_->eta() / 1000000) << "ms";
+  return ss.str();
+}
+
+void Runtime::reconfigure() {
+  reconfigure_ = true;
+}
+
 bool Runtime::is_finished() const {
   return finished_;
 }
@@ -302,6 +454,18 @@ void Runtime::debug(uint32_t action, const string& arg) {
           recursive_showvars(r);
         }
         break;
+      case 4:
+        deoptimize(r);
+        break;
+      case 5:
+        inline_module(r);
+        break;
+      case 6:
+        outline_module(r);
+        break;
+      case 7:
+        showqueue();
+        break;
       default:
         break;
     }
@@ -420,6 +584,39 @@ void Runtime::save(const string& path) {
   });
 }
 
+void Runtime::migrate(const string& from, const string& to) {
+  // Nothing to do if engines wouldn't actually move
+  if (from == to) {
+    return;
+  }
+  schedule_interrupt([this, from, to]{
+    // As with retarget(), invoking this method in a state where item_evals_ >
+    // 0 can be problematic. This condition guarantees safety.
+    if (item_evals_ > 0) {
+      return migrate(from, to);
+    }
+    // Requests for to are no longer redirected. Requests for from (and
+    // anything which was already redirected to from) are redirected to to.
+    locs_.erase(to);
+    locs_[from] = to;
+    for (auto& l : locs_) {
+      if (l.second == from) {
+        l.second = to;
+      }
+    }
+
+    ostream(rdbuf(stdinfo_)) << "Migrating engines from " << from << " to " << to << endl;
+    if (root_ != nullptr) {
+      root_->migrate(from);
+    }
+  });
+}
+
+string Runtime::get_location(const string& loc) const {
+  const auto itr = locs_.find(loc);
+  return (itr == locs_.end()) ? loc : itr->second;
+}
+
 FId Runtime::rdbuf(streambuf* sb) {
   streambufs_.push_back(make_pair(sb, false));
   return streambufs_.size()-1;
@@ -453,7 +650,7 @@ FId Runtime::fopen(const std::string& path, uint8_t mode) {
     case 1: m = ios_base::out; break;
     case 2: m = ios_base::app; break;
     case 3: m = ios_base::in | ios_base::out; break;
-    case 4: m = ios_base::in | ios_base::trunc; break;
+    case 4: m = ios_base::in | ios_base::out | ios_base::trunc; break;
     case 5: m = ios_base::in | ios_base::app; break;
     default: break;
   }
@@ -524,6 +721,11 @@ void Runtime::run_logic() {
   if (logical_time_ == 0) {
     log_event("BEGIN");
   }
+  if (!pass_pipeline_error_.empty()) {
+    ostream(rdbuf(stderr_)) << pass_pipeline_error_ << endl;
+    pass_pipeline_error_.clear();
+    finish(0);
+  }
   if (finished_) {
     return;
   }
@@ -616,22 +818,27 @@ bool Runtime::eval_item(ModuleItem* mi) {
 void Runtime::rebuild() {
   // If nothing has been evaled since the last call, we don't have to worry
   // about recompilation. But we might be here because of a jit handoff, in
-  // which case we still need to check for compiler errors.
+  // which case we still need to check for compiler errors, or because a
+  // background fast-pass compilation finished, in which case we still need
+  // to reconfigure scheduling state.
   if (item_evals_ == 0) {
     if (compiler_->error()) {
       log_compiler_errors();
     } 
-    return;
-  } 
-
-  // Inline as much as we can and compile whatever is new. Reset the
-  // item_evals_ counter as soon as we're done.
-  program_->inline_all();
-  root_->synchronize(item_evals_);
-  item_evals_ = 0;
-  if (compiler_->error()) {
-    log_compiler_errors();
-  } 
+    if (!reconfigure_) {
+      return;
+    }
+  } else {
+    // Inline as much as we can and compile whatever is new. Reset the
+    // item_evals_ counter as soon as we're done.
+    program_->inline_all();
+    root_->synchronize(item_evals_);
+    item_evals_ = 0;
+    if (compiler_->error()) {
+      log_compiler_errors();
+    } 
+  }
+  reconfigure_ = false;
 
   // Clear scheduling state
   logic_.clear();
@@ -668,7 +875,13 @@ void Runtime::drain_active() {
     done = true;
     for (auto* m : logic_) {
       if (schedule_all_ || m->engine()->there_are_reads()) {
-        m->engine()->evaluate();
+        if (profile_step_) {
+          const auto begin = chrono::steady_clock::now();
+          m->engine()->evaluate();
+          charge(m, begin);
+        } else {
+          m->engine()->evaluate();
+        }
         done = false;
       }
     }
@@ -679,18 +892,26 @@ void Runtime::drain_active() {
 bool Runtime::drain_updates() {
   auto performed_update = false;
   for (auto* m : logic_) {
+    const auto begin = profile_step_ ? chrono::steady_clock::now() : chrono::steady_clock::time_point();
     if (m->engine()->conditional_update()) {
       performed_update = true;
     }
+    if (profile_step_) {
+      charge(m, begin);
+    }
   }
   if (!performed_update) {
     return false;
   }
   auto performed_evaluate = false;
   for (auto* m : logic_) {
+    const auto begin = profile_step_ ? chrono::steady_clock::now() : chrono::steady_clock::time_point();
     if (m->engine()->conditional_evaluate()) {
       performed_evaluate = true;
     }
+    if (profile_step_) {
+      charge(m, begin);
+    }
   }
   return performed_evaluate;
 }
@@ -731,11 +952,15 @@ void Runtime::open_loop_scheduler() {
   // Record the current time, go open loop, and then record how long we were
   // gone for.  
   const size_t then = ::time(nullptr);
+  const auto begin = chrono::steady_clock::now();
   const auto id = clock_->engine()->get_clock_id();
   const auto val = clock_->engine()->get_clock_val();
   const auto itrs = inlined_logic_->engine()->open_loop(id, val, open_loop_itrs_);
   const size_t now = ::time(nullptr);
 
+  // All of the time spent in open loop belongs to the inlined logic
+  charge(inlined_logic_, begin, 1);
+
   // If we ran for an odd number of iterations, flip the clock
   if (itrs % 2) {
     clock_->engine()->set_clock_val(!val);
@@ -756,6 +981,7 @@ void Runtime::open_loop_scheduler() {
 }
 
 void Runtime::reference_scheduler() {
+  profile_step_ = (logical_time_ % sample_period_) == 0;
   while (schedule_all_ || drain_updates()) {
     drain_active();
   }
@@ -764,6 +990,11 @@ void Runtime::reference_scheduler() {
   ++logical_time_;
 }
 
+void Runtime::charge(Module* m, chrono::steady_clock::time_point begin, uint64_t scale) {
+  const auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - begin).count();
+  m->profile(scale * ns);
+}
+
 void Runtime::log_parse_errors() {
   ostream os(rdbuf(stderr_));
   os << "Parse Error:";
@@ -853,7 +1084,7 @@ void Runtime::log_freq() {
   }
   auto event = [this]{
     last_check_ = ::time(nullptr);
-    ostream(rdbuf(stdlog_)) << "*** PROF @ " << logical_time_ << "\n" << current_frequency() << endl;
+    ostream(rdbuf(stdlog_)) << "*** PROF @ " << logical_time_ << "\n" << current_frequency() << "\n" << compile_queue_status() << endl;
   };
   schedule_interrupt(event, event);
 }
@@ -894,6 +1125,10 @@ void Runtime::list(const Node* n) {
   ostream(rdbuf(stdout_)) << color << n << text << endl;
 }
 
+void Runtime::showqueue() {
+  ostream(rdbuf(stdout_)) << compile_queue_status() << endl;
+}
+
 void Runtime::showscopes(const Node* n) {
   Navigate nav(n);
   for (auto i = nav.child_begin(), ie = nav.child_end(); i != ie; ++i) {
@@ -956,6 +1191,43 @@ void Runtime::recursive_showvars(const Node* n) {
   }
 }
 
+void Runtime::deoptimize(const Node* n) {
+  auto* m = root_->find(n);
+  if (m == nullptr) {
+    ostream(rdbuf(stderr_)) << "Unable to locate an engine for this node!" << endl;
+    return;
+  }
+  m->deoptimize();
+}
+
+void Runtime::inline_module(const Node* n) {
+  auto* m = root_->find(n);
+  if (m == nullptr) {
+    ostream(rdbuf(stderr_)) << "Unable to locate an engine for this node!" << endl;
+    return;
+  }
+  if (!m->inline_source()) {
+    ostream(rdbuf(stderr_)) << "Unable to inline this module!" << endl;
+  }
+}
+
+void Runtime::outline_module(const Node* n) {
+  // Walk up to the instantiation that this code was inlined from
+  while ((n != nullptr) && (!n->is(Node::Tag::module_instantiation) || !Inline().is_inlined(static_cast<const ModuleInstantiation*>(n)))) {
+    n = n->get_parent();
+  }
+  if (n == nullptr) {
+    ostream(rdbuf(stderr_)) << "Unable to locate inlined code for this node!" << endl;
+    return;
+  }
+  const auto* mi = static_cast<const ModuleInstantiation*>(n);
+  auto* m = root_->find(mi);
+  assert(m != nullptr);
+  if (m->outline_source(Elaborate().get_elaboration(mi)) == nullptr) {
+    ostream(rdbuf(stderr_)) << "Unable to outline this module!" << endl;
+  }
+}
+
 string Runtime::current_frequency() const {
   const auto now = ::time(nullptr);
   const auto den = (now == last_time_) ? 1 : (now - last_time_);
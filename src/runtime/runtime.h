@@ -31,12 +31,14 @@
 #ifndef CASCADE_SRC_RUNTIME_RUNTIME_H
 #define CASCADE_SRC_RUNTIME_RUNTIME_H
 
+#include <chrono>
 #include <condition_variable>
 #include <ctime>
 #include <functional>
 #include <iosfwd>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/bits.h"
 #include "common/log.h"
@@ -48,8 +50,10 @@
 
 namespace cascade {
 
+class CompileQueue;
 class Compiler;
 class DataPlane;
+class IrCache;
 class Isolate;
 class Log;
 class Module;
@@ -81,7 +85,52 @@ class Runtime : public Thread {
     Runtime& set_include_dirs(const std::string& s);
     Runtime& set_open_loop_target(size_t olt);
     Runtime& set_disable_inlining(bool di);
+    // Sets the maximum size, measured in identifiers and constants, that a
+    // module may grow to as the result of inlining. Modules which don't fit
+    // are compiled on their own. Zero places no limit on inlining.
+    Runtime& set_inline_budget(size_t n);
+    // Sets the number of milliseconds that a module which was compiled on its
+    // own must spend executing before it is inlined into its parent,
+    // regardless of the inlining budget. Zero disables runtime inlining.
+    Runtime& set_inline_threshold(size_t ms);
     Runtime& set_profile_interval(size_t n);
+    // Sets the directory that transformed IR is cached in. An empty path
+    // disables caching.
+    Runtime& set_cache_path(const std::string& path);
+    // Sets the number of milliseconds that a module must spend executing in
+    // one jit tier before the next tier is compiled. A value of zero (the
+    // default) compiles every tier immediately.
+    Runtime& set_promotion_threshold(size_t ms);
+    // When enabled, fast-pass compilations triggered by eval run in the
+    // background. Engines keep running until their replacements are ready
+    // and are swapped out at a step boundary.
+    Runtime& set_async_fast_pass(bool afp);
+    // Sets the number of slow-pass engines which each module holds on to
+    // after the source they were compiled from is replaced. Zero disables
+    // speculation.
+    Runtime& set_speculative_cache_size(size_t n);
+    // Sets the maximum number of background compilations which may run at
+    // once. Requests beyond this limit wait in the compile queue.
+    Runtime& set_max_compilations(size_t n);
+    // Sets the IR pipeline which is run on modules that target a particular
+    // location, as a semicolon-separated list of target=pipeline pairs. A
+    // pipeline with no target applies to every target without its own
+    // entry. See PassManager for pipeline syntax. Malformed pipelines are
+    // ignored, and cause the runtime to report an error and finish as soon
+    // as it starts.
+    Runtime& set_pass_pipeline(const std::string& spec);
+    // When enabled, per-pass timing and node count statistics are printed
+    // whenever a module is run through the IR pipeline.
+    Runtime& set_pass_stats(bool ps);
+    // When enabled, every variable is simulated, whether or not it can affect
+    // observable behavior, so that the program can be inspected with $__debug.
+    // This removes dead_state_eliminate from every IR pipeline.
+    Runtime& set_enable_debug(bool ed);
+    // When enabled, the runtime assumes that the first program it evaluates
+    // is complete and that no more code will follow. Modules without a pass
+    // pipeline of their own use PassManager::batch_pipeline() rather than
+    // the default.
+    Runtime& set_batch_mode(bool bm);
 
     // Major Component Accessors and Helpers:
     //
@@ -89,9 +138,24 @@ class Runtime : public Thread {
     // use of these pointers should be handled with care, as these objects have
     // their own constraints on defined behavior.
     Compiler* get_compiler();
+    CompileQueue* get_compile_queue();
     DataPlane* get_data_plane();
     Isolate* get_isolate();
+    IrCache* get_ir_cache();
+    Program* get_program();
     Engine::Id get_next_id();
+    // Returns the promotion threshold in nanoseconds
+    uint64_t get_promotion_threshold() const;
+    // Returns the inlining threshold in nanoseconds
+    uint64_t get_inline_threshold() const;
+    // Returns true if fast-pass compilations run in the background
+    bool get_async_fast_pass() const;
+    // Returns the number of slow-pass engines each module may hold on to
+    size_t get_speculative_cache_size() const;
+    // Returns the IR pipeline for modules which target t
+    std::string get_pass_pipeline(const std::string& t) const;
+    // Returns true if IR pipeline statistics are enabled
+    bool get_pass_stats() const;
 
     // Eval Interface:
     //
@@ -129,6 +193,17 @@ class Runtime : public Thread {
     // asynchronous task invokes any of the schedule_xxx_interrupt methods, it
     // must use the two-argument form.
     void schedule_asynchronous(Asynchronous async);
+    // Schedules a background compilation on behalf of owner through the
+    // compile queue. The state of the queue is reported alongside the
+    // profiling output and by $__debug(7). Cost is an estimate of the size of the job and priority is the amount of time
+    // that owner has spent running. This method should only be invoked from
+    // the runtime thread. See CompileQueue::insert() for details.
+    void schedule_compilation(const void* owner, uint64_t key, const std::string& target, uint64_t cost, uint64_t priority, Asynchronous job, Asynchronous abort);
+    // Forces the runtime to recompute its scheduling state at the end of the
+    // current interrupt window. This method should be invoked by interrupts
+    // which swap in an engine that may change its type (ie: a stub being
+    // replaced by logic).
+    void reconfigure();
     // Returns true if the runtime has executed a finish statement.
     bool is_finished() const;
 
@@ -145,6 +220,17 @@ class Runtime : public Thread {
     // Schedules a $save() at the end of this step and returns immediately.
     void save(const std::string& path);
 
+    // Migration Interface:
+    //
+    // Schedules a migration at the end of this step and returns immediately.
+    // Every engine which is located at from is recompiled for to and swapped
+    // in without interrupting the simulation. Subsequent compilations which
+    // request from are redirected to to.
+    void migrate(const std::string& from, const std::string& to);
+    // Returns the location which compilations that request loc are
+    // redirected to.
+    std::string get_location(const std::string& loc) const;
+
     // Stream I/O Interface:
     //
     // Appends a new entry to the stream table and returns its fd
@@ -174,8 +260,10 @@ class Runtime : public Thread {
     Log* log_;
     Parser* parser_;
     Compiler* compiler_;
+    CompileQueue* compile_queue_;
     DataPlane* dp_;
     Isolate* isolate_;
+    IrCache* ir_cache_;
 
     // Program State:
     Program* program_;
@@ -188,6 +276,15 @@ class Runtime : public Thread {
     size_t open_loop_itrs_;
     size_t open_loop_target_;
     size_t profile_interval_;
+    uint64_t promotion_threshold_;
+    uint64_t inline_threshold_;
+    bool async_fast_pass_;
+    size_t speculative_cache_size_;
+    std::unordered_map<std::string, std::string> pass_pipelines_;
+    std::string pass_pipeline_error_;
+    bool pass_stats_;
+    bool enable_debug_;
+    bool batch_mode_;
 
     // Interrupt Queue:
     bool finished_;
@@ -201,11 +298,17 @@ class Runtime : public Thread {
     std::vector<Module*> logic_;
     std::vector<Module*> done_logic_;
     bool schedule_all_;
+    bool reconfigure_;
 
     // Optimized Scheduling State:
     Module* clock_;
     Module* inlined_logic_;
 
+    // JIT Profiling State:
+    // Engine execution time is only measured once every sample_period_ steps
+    static constexpr uint64_t sample_period_ = 64;
+    bool profile_step_;
+
     // Time Keeping:
     time_t begin_time_;
     time_t last_time_;
@@ -213,6 +316,10 @@ class Runtime : public Thread {
     uint64_t last_logical_time_;
     uint64_t logical_time_;
 
+    // Location Table:
+    // Tracks locations which engines have been migrated away from
+    std::unordered_map<std::string, std::string> locs_;
+
     // Stream Table:
     // Tracks streambufs and whether they are owned by the runtime (and can be
     // destroyed on teardown)
@@ -263,6 +370,12 @@ class Runtime : public Thread {
     // Runs a single iteration of the reference scheduling algoirthm
     void reference_scheduler();
 
+    // JIT Profiling Helpers:
+    //
+    // Charges the time elapsed since begin to m, scaled to account for steps
+    // which weren't measured.
+    void charge(Module* m, std::chrono::steady_clock::time_point begin, uint64_t scale = sample_period_);
+
     // Logging Helpers
     //
     // Dumps parse errors to stderr
@@ -296,6 +409,17 @@ class Runtime : public Thread {
     // Prints info for all of the variables below n. This method is undefined
     // for ids which don't point to scopes.
     void recursive_showvars(const Node* n);
+    // Moves the engine for the module which contains n back to software.
+    // Every other engine is left where it is.
+    void deoptimize(const Node* n);
+    // Inlines the module which contains n into its parent.
+    void inline_module(const Node* n);
+    // Outlines the innermost inlined module which contains n.
+    void outline_module(const Node* n);
+    // Prints the depth and estimated time to drain of the compile queue.
+    void showqueue();
+    // Returns a one line summary of the state of the compile queue.
+    std::string compile_queue_status() const;
 
     // Time Keeping Helpers:
     //
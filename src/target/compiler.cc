@@ -94,7 +94,9 @@ Engine* Compiler::compile(Engine::Id id, ModuleDeclaration* md) {
     return nullptr;
   }
 
-  ids_.insert(id);
+  { lock_guard<mutex> lg(lock_);
+    ids_.insert(id);
+  }
   auto* c = cc->compile(id, md, i);
   if (c == nullptr) {
     delete i;
@@ -117,8 +119,12 @@ void Compiler::stop_async() {
 }
 
 void Compiler::stop_compile() {
+  unordered_set<Engine::Id> ids;
+  { lock_guard<mutex> lg(lock_);
+    ids = ids_;
+  }
   for (auto& cc : ccs_) {
-    for (auto id : ids_) {
+    for (auto id : ids) {
       cc.second->stop_compile(id);
     }
   }
@@ -128,7 +128,7 @@ class Compiler {
     // Compilation State:
     std::unordered_set<Engine::Id> ids_;
 
-    // Error State:
+    // Error State (lock_ also guards ids_, since compile() is reentrant):
     std::mutex lock_;
     bool fatal_;
     std::string what_;
@@ -31,12 +31,14 @@
 #include "target/compiler/proxy_compiler.h"
 
 #include <sstream>
+#include <utility>
 
 using namespace std;
 
 namespace cascade {
 
 ProxyCompiler::ProxyCompiler() : CoreCompiler() { 
+  set_compression_threshold(0);
   pool_.set_num_threads(4);
   pool_.run();
   running_ = true;
@@ -53,6 +55,13 @@ ProxyCompiler::~ProxyCompiler() {
     assert(rpc.type_ == Rpc::Type::OKAY);
     delete c.second.async_sock;
     delete c.second.sync_sock;
+
+    // The remote compiler will reclaim these sockets when it notices that
+    // they've been closed.
+    delete c.second.ctrl_sock;
+    for (auto* s : c.second.compile_socks) {
+      delete s;
+    }
   }
 }
 
@@ -127,24 +136,39 @@ void ProxyCompiler::async_loop(sockstream* sock) {
   }
 }
 
+ProxyCompiler& ProxyCompiler::set_compression_threshold(uint32_t n) {
+  threshold_ = n;
+  return *this;
+}
+
 void ProxyCompiler::stop_compile(Engine::Id id) {
   // TODO(eschkufz) Add some better error handling here. We assume that if a
   // connection was opened, all further communication will succeed.
 
-  for (auto& c : conns_) {
-    auto* sock = get_sock(c.first);
-    assert(sock != nullptr);
-    Rpc(Rpc::Type::STOP_COMPILE, c.second.pid, id, 0).serialize(*sock);
+  // Take a snapshot of the control channels, and release lock_ before
+  // talking to them. Connections are never closed before this compiler is
+  // torn down, so the sockets outlive the snapshot.
+  vector<pair<uint32_t, sockstream*>> ctrls;
+  { lock_guard<mutex> lg(lock_);
+    for (const auto& c : conns_) {
+      ctrls.push_back(make_pair(c.second.pid, c.second.ctrl_sock));
+    }
+  }
+
+  lock_guard<mutex> lg(ctrl_lock_);
+  for (const auto& c : ctrls) {
+    auto* sock = c.second;
+    Rpc(Rpc::Type::STOP_COMPILE, c.first, id, 0).serialize(*sock);
     sock->flush();
     Rpc rpc;
     rpc.deserialize(*sock);
     assert(rpc.type_ == Rpc::Type::OKAY);
-    delete sock;
   }
 }
 
 bool ProxyCompiler::open(const string& loc) {
   // Nothing to do if we already have a connection to this location
+  lock_guard<mutex> lg(lock_);
   if (conns_.find(loc) != conns_.end()) {
     return true;
   }
@@ -157,37 +181,71 @@ bool ProxyCompiler::open(const string& loc) {
   // first connection attempt succeded, then all subsequent parts of the
   // handshake will succeed as well.
 
-  // Step 1: Open the asynchronous socket and sent a register request.  The
-  // reply will contain the id the remote compiler associates with this
-  // compiler.
+  // Step 1: Open the asynchronous socket and sent a register request along
+  // with the compression threshold we'd like to use.  The reply will contain
+  // the id the remote compiler associates with this compiler and the
+  // threshold that it agreed to.
   ci.async_sock = get_sock(loc);
   if (ci.async_sock == nullptr) {
     return false;
   }
-  Rpc(Rpc::Type::OPEN_CONN_1, 0, 0, 0).serialize(*ci.async_sock);
+  Rpc(Rpc::Type::OPEN_CONN_1, 0, 0, threshold_).serialize(*ci.async_sock);
   ci.async_sock->flush();
   rpc.deserialize(*ci.async_sock);
   assert(rpc.type_ == Rpc::Type::OKAY);
   ci.pid = rpc.pid_;
+  ci.threshold = rpc.n_;
 
   // Step 2: Open the synchronous socket and send a register request. This
   // time around, send the pid so that the new socket can be associated with
-  // this connection in the remote compiler.
+  // this connection in the remote compiler. State and inputs are sent over
+  // this socket, so both ends compress large messages.
   ci.sync_sock = get_sock(loc);
   assert(ci.sync_sock != nullptr);
-  Rpc(Rpc::Type::OPEN_CONN_2, ci.pid, 0, 0).serialize(*ci.sync_sock);
+  ci.sync_sock->set_compression_threshold(ci.threshold);
+  Rpc(Rpc::Type::OPEN_CONN_2, ci.pid, 0, ci.threshold).serialize(*ci.sync_sock);
   ci.sync_sock->flush();
   rpc.deserialize(*ci.sync_sock);
   assert(rpc.type_ == Rpc::Type::OKAY);
 
-  // Step 3: Create a thread to listen for asynchronous messages 
+  // Step 3: Open the control socket. This socket doesn't require
+  // registration. It's used to send requests which aren't associated with
+  // any particular engine.
+  ci.ctrl_sock = get_sock(loc);
+  assert(ci.ctrl_sock != nullptr);
+
+  // Step 4: Create a thread to listen for asynchronous messages 
   pool_.insert([this, ci]{async_loop(ci.async_sock);});
 
-  // Step 4: Archive the connection
+  // Step 5: Archive the connection
   conns_[loc] = ci;
   return true;
 }
 
+sockstream* ProxyCompiler::acquire_compile_sock(const string& loc) {
+  uint32_t threshold = 0;
+  { lock_guard<mutex> lg(lock_);
+    auto& ci = conns_[loc];
+    if (!ci.compile_socks.empty()) {
+      auto* sock = ci.compile_socks.back();
+      ci.compile_socks.pop_back();
+      return sock;
+    }
+    threshold = ci.threshold;
+  }
+  // Module source is sent over this socket, so compress large messages.
+  auto* sock = get_sock(loc);
+  if (sock != nullptr) {
+    sock->set_compression_threshold(threshold);
+  }
+  return sock;
+}
+
+void ProxyCompiler::release_compile_sock(const string& loc, sockstream* sock) {
+  lock_guard<mutex> lg(lock_);
+  conns_[loc].compile_socks.push_back(sock);
+}
+
 sockstream* ProxyCompiler::get_sock(const string& loc) {
   auto* sock = (loc.find(':') != string::npos) ? get_tcp_sock(loc) : get_unix_sock(loc);
   if (sock->error()) {
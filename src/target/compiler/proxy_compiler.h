@@ -31,8 +31,10 @@
 #ifndef CASCADE_SRC_TARGET_COMPILER_PROXY_COMPILER_H
 #define CASCADE_SRC_TARGET_COMPILER_PROXY_COMPILER_H
 
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "common/sockstream.h"
 #include "common/thread_pool.h"
 #include "target/compiler.h"
@@ -49,13 +51,37 @@ class ProxyCompiler : public CoreCompiler {
     ProxyCompiler();
     ~ProxyCompiler() override;
 
+    // Configuration Interface:
+    //
+    // Sets the minimum size of a message which will be compressed before it's
+    // sent to a remote compiler. A value of zero disables compression. This
+    // value is negotiated when a connection is first opened.
+    ProxyCompiler& set_compression_threshold(uint32_t n);
+
   private:
+    // Configuration State:
+    uint32_t threshold_;
+
     // Connection State:
+    //
+    // Every location is served by a persistent control channel, which is used
+    // for stop_compile() requests, and a pool of compile channels. A compile
+    // request takes exclusive ownership of an idle channel (or opens a new one
+    // if none are available) and returns it to the pool when it's done. This
+    // allows several compilations to be in flight at once without paying for
+    // a new connection each time. lock_ only guards the table of connections;
+    // round trips on the control channels are serialized by ctrl_lock_, so
+    // that they never block access to the compile channels.
     struct ConnInfo {
       uint32_t pid;
       sockstream* async_sock;
       sockstream* sync_sock;
+      sockstream* ctrl_sock;
+      std::vector<sockstream*> compile_socks;
+      uint32_t threshold;
     };
+    std::mutex lock_;
+    std::mutex ctrl_lock_;
     std::unordered_map<std::string, ConnInfo> conns_;
 
     // Asynchronous Control for State-Safe Requests:
@@ -84,6 +110,9 @@ class ProxyCompiler : public CoreCompiler {
     bool open(const std::string& loc);
     bool close(const ConnInfo& ci);
 
+    sockstream* acquire_compile_sock(const std::string& loc);
+    void release_compile_sock(const std::string& loc, sockstream* sock);
+
     sockstream* get_sock(const std::string& loc);
     sockstream* get_tcp_sock(const std::string& loc);
     sockstream* get_unix_sock(const std::string& loc);
@@ -92,17 +121,23 @@ class ProxyCompiler : public CoreCompiler {
 template <typename T>
 inline ProxyCore<T>* ProxyCompiler::generic_compile(Engine::Id id, ModuleDeclaration* md, Interface* interface) {
   // Open a connection to this location if necessary.
-  const auto& loc = md->get_attrs()->get<String>("__loc")->get_readable_val();
+  const auto loc = md->get_attrs()->get<String>("__loc")->get_readable_val();
   if (!open(loc)) {
     get_compiler()->error("Unable to establish connection with remote compiler");
     delete md;
     return nullptr;
   }
-  const auto& conn = conns_[loc];
+  uint32_t pid = 0;
+  sockstream* sync_sock = nullptr;
+  { std::lock_guard<std::mutex> lg(lock_);
+    const auto& conn = conns_[loc];
+    pid = conn.pid;
+    sync_sock = conn.sync_sock;
+  }
 
-  // Change __loc to "remote" and send a compile request via a temp socket.  
+  // Change __loc to "remote" and send a compile request via a pooled socket.
   md->get_attrs()->set_or_replace("__loc", new String("remote"));
-  auto* sock = get_sock(loc);
+  auto* sock = acquire_compile_sock(loc);
   if (sock == nullptr) {
     get_compiler()->error("Unable to establish connection with remote compiler");
     delete md;
@@ -110,21 +145,27 @@ inline ProxyCore<T>* ProxyCompiler::generic_compile(Engine::Id id, ModuleDeclara
   }
 
   // Send a blocking compile request
-  Rpc(Rpc::Type::COMPILE, conn.pid, id, 0).serialize(*sock);
+  Rpc(Rpc::Type::COMPILE, pid, id, 0).serialize(*sock);
   *sock << md << "\n";
   delete md;
   sock->flush();
 
   // If successful, this response will contain the index for this engine in the
-  // remote compiler's engine table
+  // remote compiler's engine table. Either way, the socket can be reused,
+  // unless the connection was lost, in which case it's discarded.
   Rpc res;
   res.deserialize(*sock);
-  delete sock;
+  if (sock->eof() || sock->fail()) {
+    delete sock;
+    get_compiler()->error("Lost connection to the remote compiler during compilation");
+    return nullptr;
+  }
+  release_compile_sock(loc, sock);
   if (res.type_ == Rpc::Type::FAIL) {
     get_compiler()->error("An unhandled error occured during compilation in the remote compiler");
     return nullptr;
   }
-  return new ProxyCore<T>(interface, conn.pid, id, res.n_, conn.sync_sock);
+  return new ProxyCore<T>(interface, pid, id, res.n_, sync_sock);
 }
 
 } // namespace cascade
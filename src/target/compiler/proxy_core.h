@@ -227,20 +227,20 @@ inline void ProxyCore<T>::recv() {
   Rpc rpc;
   while (rpc.deserialize(*sock_)) {
     switch(rpc.type_) {
-      case Rpc::Type::WRITE_BITS: {
+      case Rpc::Type::WRITE_BATCH: {
+        // Writes arrive coalesced: one entry per variable, holding the final
+        // value that was written during the call which just completed.
         VId id = 0;
         Bits bits;
-        sock_->read(reinterpret_cast<char*>(&id), 4);
-        bits.deserialize(*sock_);
-        T::interface()->write(id, &bits);
-        break;
-      }
-      case Rpc::Type::WRITE_BOOL: {
-        VId id = 0;
-        bool b = false;
-        sock_->read(reinterpret_cast<char*>(&id), 4);
-        b = (sock_->get() == 1);
-        T::interface()->write(id, b);
+        for (size_t i = 0; i < rpc.n_; ++i) {
+          sock_->read(reinterpret_cast<char*>(&id), 4);
+          if (sock_->get() == 2) {
+            T::interface()->write(id, sock_->get() == 1);
+          } else {
+            bits.deserialize(*sock_);
+            T::interface()->write(id, &bits);
+          }
+        }
         break;
       }
 
@@ -325,33 +325,6 @@ inline void ProxyCore<T>::recv() {
         sock_->flush();
         break;
       }
-      case Rpc::Type::PUBSYNC: {
-        FId id = 0;
-        sock_->read(reinterpret_cast<char*>(&id), sizeof(id));
-
-        int32_t res = T::interface()->pubsync(id);
-        sock_->write(reinterpret_cast<char*>(&res), sizeof(res));
-        sock_->flush();
-        break;
-      }
-      case Rpc::Type::SBUMPC: {
-        FId id = 0;
-        sock_->read(reinterpret_cast<char*>(&id), sizeof(id));
-
-        int32_t res = T::interface()->sbumpc(id);
-        sock_->write(reinterpret_cast<char*>(&res), sizeof(res));
-        sock_->flush();
-        break;
-      }
-      case Rpc::Type::SGETC: {
-        FId id = 0;
-        sock_->read(reinterpret_cast<char*>(&id), sizeof(id));
-
-        int32_t res = T::interface()->sgetc(id);
-        sock_->write(reinterpret_cast<char*>(&res), sizeof(res));
-        sock_->flush();
-        break;
-      }
       case Rpc::Type::SGETN: {
         FId id = 0;
         uint32_t n = 0;
@@ -366,14 +339,12 @@ inline void ProxyCore<T>::recv() {
         delete[] c;
         break;
       }
-      case Rpc::Type::SPUTC: {
+      // Puts, syncs, and ungets are fire-and-forget. The remote interface doesn't wait
+      // for a reply, so we don't send one.
+      case Rpc::Type::PUBSYNC: {
         FId id = 0;
         sock_->read(reinterpret_cast<char*>(&id), sizeof(id));
-        auto c = sock_->get();
-
-        int32_t res = T::interface()->sputc(id, c);
-        sock_->write(reinterpret_cast<char*>(&res), sizeof(res));
-        sock_->flush();
+        T::interface()->pubsync(id);
         break;
       }
       case Rpc::Type::SPUTN: {
@@ -383,13 +354,18 @@ inline void ProxyCore<T>::recv() {
         sock_->read(reinterpret_cast<char*>(&n), sizeof(n));
         auto* c = new char[n];
         sock_->read(c, n);
-
-        uint32_t res = T::interface()->sputn(id, c, n);
-        sock_->write(reinterpret_cast<char*>(&res), sizeof(res));
-        sock_->flush();
+        T::interface()->sputn(id, c, n);
         delete[] c;
         break;
       }
+      case Rpc::Type::UNGETN: {
+        FId id = 0;
+        uint32_t n = 0;
+        sock_->read(reinterpret_cast<char*>(&id), sizeof(id));
+        sock_->read(reinterpret_cast<char*>(&n), sizeof(n));
+        T::interface()->pubseekoff(id, -static_cast<int32_t>(n), 0, 1);
+        break;
+      }
 
       case Rpc::Type::OKAY:
       default:
@@ -31,6 +31,7 @@
 #include "target/compiler/remote_compiler.h"
 
 #include <cassert>
+#include <unistd.h>
 #include <unordered_map>
 #include "common/log.h"
 #include "common/sockserver.h"
@@ -115,16 +116,22 @@ void RemoteCompiler::run_logic() {
     return;
   }
 
+  if (pipe(wake_) != 0) {
+    return;
+  }
+
   fd_set master_set;
   FD_ZERO(&master_set);
   FD_SET(tl.descriptor(), &master_set);
   FD_SET(ul.descriptor(), &master_set);
+  FD_SET(wake_[0], &master_set);
 
   fd_set read_set;
   FD_ZERO(&read_set);
 
   struct timeval timeout = {1, 0};
-  auto max_fd = max(tl.descriptor(), ul.descriptor());
+  auto max_fd = max(max(tl.descriptor(), ul.descriptor()), wake_[0]);
+  socks_.resize(max_fd+1, nullptr);
 
   pool_.set_num_threads(4);
   pool_.run();
@@ -139,6 +146,21 @@ void RemoteCompiler::run_logic() {
         continue;
       }
 
+      // Wake up logic: Compilation threads have returned their sockets.
+      // Drain the pipe and restore those sockets to the read set.
+      if (i == wake_[0]) {
+        char buf[64];
+        (void) ::read(wake_[0], buf, sizeof(buf));
+        lock_guard<mutex> lg(slock_);
+        for (auto fd : returned_socks_) {
+          if (socks_[fd] != nullptr) {
+            FD_SET(fd, &master_set);
+          }
+        }
+        returned_socks_.clear();
+        continue;
+      }
+
       // Listener logic: New connections are added to the read set Note that
       // this is a write critical section for sockets so it is guarded against
       // race conditions with the state safe interrupt handler.
@@ -164,23 +186,22 @@ void RemoteCompiler::run_logic() {
         rpc.deserialize(*sock);
         switch (rpc.type_) {
 
-          // Compiler ABI: Note that these methods remove elements from the
-          // sock index which aren't used anywhere else and thus don't need to
-          // be guarded.
+          // Compiler ABI: Compile and control sockets are persistent. While a
+          // compilation is in flight, its socket belongs to the compilation
+          // thread and is removed from the read set so that an eof or error
+          // can't cause it to be deleted out from under that thread. It's
+          // restored once the compilation thread is done with it.
           case Rpc::Type::COMPILE: {
+            { lock_guard<mutex> lg(slock_);
+              FD_CLR(i, &master_set);
+            }
             compile(sock, rpc);
             sock = nullptr;
-            socks_[i] = nullptr;
-            FD_CLR(i, &master_set);
             break;
           }
-          case Rpc::Type::STOP_COMPILE: {
+          case Rpc::Type::STOP_COMPILE:
             stop_compile(sock, rpc);
-            sock = nullptr;
-            socks_[i] = nullptr;
-            FD_CLR(i, &master_set);
             break;
-          }
 
           // Core ABI:
           case Rpc::Type::GET_STATE:
@@ -263,8 +284,17 @@ void RemoteCompiler::run_logic() {
             teardown_engine(sock, rpc);
             break;
 
-          // Control reaches here innocuosly when fds are closed remotely
+          // Control reaches here when fds are closed remotely. Sockets which
+          // haven't already been released (ie persistent compile and control
+          // sockets) are released here.
           default:
+            if (sock->eof()) {
+              lock_guard<mutex> lg(slock_);
+              delete sock;
+              sock = nullptr;
+              socks_[i] = nullptr;
+              FD_CLR(i, &master_set);
+            }
             break;
         }
       } while ((sock != nullptr) && (sock->rdbuf()->in_avail() > 0));
@@ -274,6 +304,8 @@ void RemoteCompiler::run_logic() {
   // Stop all asynchronous compilation threads. 
   Compiler::stop_compile();
   pool_.stop_now();
+  close(wake_[0]);
+  close(wake_[1]);
 
   // We have exclusive access to the indices. Delete their contents.
   for (auto& es : engines_) {
@@ -315,8 +347,8 @@ void RemoteCompiler::compile(sockstream* sock, const Rpc& rpc) {
     engines_.resize(engines_.size()+1);
   }
 
-  // Now create a new thread to compile the code, enter it into the
-  // engine table, and close the socket when it's done.
+  // Now create a new thread to compile the code and enter it into the engine
+  // table. The socket is left open so that it can be reused.
   pool_.insert([this, sock, rpc, md, eid]{
     // TODO(eschkufz) Race condition here between when we set sock_ and when
     // it's read.  Also, note the unguarded access to sock_index_
@@ -334,7 +366,13 @@ void RemoteCompiler::compile(sockstream* sock, const Rpc& rpc) {
       Rpc(Rpc::Type::FAIL).serialize(*sock);
       sock->flush();
     }
-    delete sock;
+
+    // Return the socket to the select loop
+    { lock_guard<mutex> lg(slock_);
+      returned_socks_.push_back(sock->descriptor());
+    }
+    const char c = 0;
+    (void) ::write(wake_[1], &c, 1);
   });
 }
 
@@ -352,7 +390,6 @@ void RemoteCompiler::stop_compile(sockstream* sock, const Rpc& rpc) {
   }
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
-  delete sock;
 }
 
 void RemoteCompiler::get_state(sockstream* sock, Engine* e) {
@@ -387,6 +424,7 @@ void RemoteCompiler::finalize(sockstream* sock, Engine* e) {
   e->finalize();
   // This call to finalize will have primed the socket with tasks and writes
   // Appending an OKAY rpc indicates that everything has been sent
+  flush(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
@@ -423,6 +461,7 @@ void RemoteCompiler::evaluate(sockstream* sock, Engine* e) {
   e->evaluate();
   // This call to evaluate will have primed the socket with tasks and writes
   // Appending an OKAY rpc, indicates that everything has been sent.
+  flush(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
@@ -435,6 +474,7 @@ void RemoteCompiler::update(sockstream* sock, Engine* e) {
   e->update();
   // This call to update will have primed the socket with tasks and writes
   // Appending an OKAY rpc, indicates that everything has been sent.
+  flush(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
@@ -447,6 +487,7 @@ void RemoteCompiler::conditional_update(sockstream* sock, Engine* e) {
   const auto res = e->conditional_update();
   // This call to conditional_update will have primed the socket with tasks and
   // writes Appending an OKAY rpc, indicates that everything has been sent.
+  flush(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->put(res ? 1 : 0);
   sock->flush();
@@ -462,34 +503,46 @@ void RemoteCompiler::open_loop(sockstream* sock, Engine* e) {
   const uint32_t res = e->open_loop(clk, val, itr);
   // This call to open_loop  will have primed the socket with tasks and
   // writes Appending an OKAY rpc, indicates that everything has been sent.
+  flush(e);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->write(reinterpret_cast<const char*>(&res), 4);
   sock->flush();
 }
 
 void RemoteCompiler::open_conn_1(sockstream* sock, const Rpc& rpc) {
-  (void) rpc;
+  // We can decode compressed messages of any size, so we always agree to the
+  // compression threshold requested by the proxy compiler.
   const auto pid = sock_index_.size();
   sock_index_.push_back(make_pair(sock->descriptor(), 0));
-  Rpc(Rpc::Type::OKAY, pid, 0, 0).serialize(*sock);
+  Rpc(Rpc::Type::OKAY, pid, 0, rpc.n_).serialize(*sock);
   sock->flush();
 }
 
 void RemoteCompiler::open_conn_2(sockstream* sock, const Rpc& rpc) {
   sock_index_[rpc.pid_].second = sock->descriptor();
+  sock->set_compression_threshold(rpc.n_);
   Rpc(Rpc::Type::OKAY).serialize(*sock);
   sock->flush();
 }
 
 void RemoteCompiler::teardown_engine(sockstream* sock, const Rpc& rpc) {
   { lock_guard<mutex> lg(elock_);
-    delete engines_[engine_index_[rpc.pid_][rpc.eid_]][rpc.n_];
+    // Give back any input this engine read ahead of time. Otherwise it would
+    // be lost to whichever engine replaces this one.
+    auto* e = engines_[engine_index_[rpc.pid_][rpc.eid_]][rpc.n_];
+    static_cast<RemoteInterface*>(e->get_interface())->release();
+    delete e;
     engines_[engine_index_[rpc.pid_][rpc.eid_]][rpc.n_] = nullptr;
     Rpc(Rpc::Type::OKAY).serialize(*sock);
     sock->flush();
   }
 } 
 
+void RemoteCompiler::flush(Engine* e) {
+  // Every interface handed out by this compiler is a remote interface
+  static_cast<RemoteInterface*>(e->get_interface())->flush();
+}
+
 Engine* RemoteCompiler::get_engine(const Rpc& rpc) {
   lock_guard<mutex> lg(elock_);
   return engines_[engine_index_[rpc.pid_][rpc.eid_]][rpc.n_];
@@ -74,6 +74,11 @@ class RemoteCompiler : public Compiler, public Thread {
     std::vector<std::pair<int, int>> sock_index_;
     // Maps a proxy core / engine id to a local engine id
     std::vector<std::vector<int>> engine_index_;
+    // Compile sockets which were checked out to a compilation thread and
+    // have since been returned, but not yet restored to the read set
+    std::vector<int> returned_socks_;
+    // Self-pipe used by compilation threads to wake up the select loop
+    int wake_[2];
 
     // Compiler Interface:
     void schedule_state_safe_interrupt(Runtime::Interrupt int_) override;
@@ -112,6 +117,9 @@ class RemoteCompiler : public Compiler, public Thread {
 
     void teardown_engine(sockstream* sock, const Rpc& rpc);
 
+    // Interface Helpers:
+    void flush(Engine* e);
+
     // Index Helpers:
     Engine* get_engine(const Rpc& rpc);
 };
@@ -31,7 +31,11 @@
 #ifndef CASCADE_SRC_TARGET_INTERFACE_REMOTE_REMOTE_INTERFACE_H
 #define CASCADE_SRC_TARGET_INTERFACE_REMOTE_REMOTE_INTERFACE_H
 
+#include <algorithm>
 #include <cassert>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "common/sockstream.h"
 #include "target/compiler/rpc.h"
 #include "target/interface.h"
@@ -62,9 +66,61 @@ class RemoteInterface : public Interface {
     uint32_t sgetn(FId id, char* c, uint32_t n) override;
     int32_t sputc(FId id, char c) override;
     uint32_t sputn(FId id, const char* c, uint32_t n) override;
+
+    // Sends any buffered messages to the runtime and returns any unused
+    // read-ahead data. This method must be invoked before control is returned
+    // to the runtime at the end of an evaluate(), update(), or any other call
+    // which may have produced writes or reads.
+    void flush();
+    // Identical to flush(). This method must be invoked before the engine
+    // which owns this interface is torn down.
+    void release();
       
   private:
+    // Write Types:
+    enum WriteType : uint8_t {
+      CLEAN = 0,
+      BITS,
+      BOOL
+    };
+
     sockstream* sock_;
+
+    // Write Buffer:
+    //
+    // Writes are coalesced here rather than being sent as they occur. The ith
+    // element of write_buf_ holds the most recent value written to variable i.
+    // Variables are appended to dirty_ the first time they're written.
+    std::vector<Bits> write_buf_;
+    std::vector<WriteType> write_type_;
+    std::vector<VId> dirty_;
+
+    // Stream Buffers:
+    //
+    // Gets are served from a per-stream read-ahead buffer which is refilled
+    // with a single SGETN. Unused read-ahead data is discarded and the
+    // runtime's get pointer is rolled back on sync, seek, put, or at the end
+    // of the step. Seeks fold the roll back into their own request, and
+    // everything else sends a fire-and-forget UNGETN, so giving data back
+    // never costs a round trip. Puts are appended to a per-stream write-behind buffer
+    // which is sent with a single SPUTN on sync, seek, get, system task, or at
+    // the end of the step.
+    struct Stream {
+      std::vector<char> get;
+      size_t gpos = 0;
+      std::vector<char> put;
+    };
+    static constexpr uint32_t buffer_size_ = 4096;
+    std::unordered_map<FId, Stream> streams_;
+
+    void mark_dirty(VId id, WriteType type);
+
+    // Stream Helpers:
+    uint32_t fill(FId id);
+    void flush_get(FId id);
+    void flush_put(FId id);
+    void flush_puts();
+    uint32_t sgetn_remote(FId id, char* c, uint32_t n);
 }; 
 
 inline RemoteInterface::RemoteInterface(sockstream* sock) : Interface() {
@@ -72,18 +128,21 @@ inline RemoteInterface::RemoteInterface(sockstream* sock) : Interface() {
 }
 
 inline void RemoteInterface::write(VId id, const Bits* b) {
-  Rpc(Rpc::Type::WRITE_BITS).serialize(*sock_);
-  sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
-  b->serialize(*sock_);
+  mark_dirty(id, BITS);
+  write_buf_[id] = *b;
 }
 
 inline void RemoteInterface::write(VId id, bool b) {
-  Rpc(Rpc::Type::WRITE_BOOL).serialize(*sock_);
-  sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
-  sock_->put(b ? 1 : 0);
+  mark_dirty(id, BOOL);
+  if (write_buf_[id].size() != 1) {
+    write_buf_[id] = Bits(b);
+  } else if (write_buf_[id].to_bool() != b) {
+    write_buf_[id].flip(0);
+  }
 }
 
 inline void RemoteInterface::debug(uint32_t action, const std::string& arg) {
+  flush_puts();
   Rpc(Rpc::Type::DEBUG).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&action), 4);
   sock_->write(arg.c_str(), arg.length());
@@ -91,23 +150,27 @@ inline void RemoteInterface::debug(uint32_t action, const std::string& arg) {
 }
 
 inline void RemoteInterface::finish(uint32_t arg) {
+  flush_puts();
   Rpc(Rpc::Type::FINISH).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&arg), 4);
 }
 
 inline void RemoteInterface::restart(const std::string& path) {
+  flush_puts();
   Rpc(Rpc::Type::RESTART).serialize(*sock_);
   sock_->write(path.c_str(), path.length());
   sock_->put('\0');
 }
 
 inline void RemoteInterface::retarget(const std::string& s) {
+  flush_puts();
   Rpc(Rpc::Type::RETARGET).serialize(*sock_);
   sock_->write(s.c_str(), s.length());
   sock_->put('\0');
 }
 
 inline void RemoteInterface::save(const std::string& path) {
+  flush_puts();
   Rpc(Rpc::Type::SAVE).serialize(*sock_);
   sock_->write(path.c_str(), path.length());
   sock_->put('\0');
@@ -126,6 +189,14 @@ inline FId RemoteInterface::fopen(const std::string& path, uint8_t mode) {
 }
 
 inline int32_t RemoteInterface::in_avail(FId id) {
+  // Fast Path: Report what's left in the read-ahead buffer
+  auto& s = streams_[id];
+  if (s.gpos < s.get.size()) {
+    return s.get.size() - s.gpos;
+  }
+
+  // Slow Path: Ask the runtime
+  flush_put(id);
   Rpc(Rpc::Type::IN_AVAIL).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->flush();
@@ -136,6 +207,16 @@ inline int32_t RemoteInterface::in_avail(FId id) {
 }
 
 inline uint32_t RemoteInterface::pubseekoff(FId id, int32_t off, uint8_t way, uint8_t which) {
+  // Relative seeks need to account for whatever we've read ahead but haven't
+  // consumed. Either way, the read-ahead buffer is no longer valid.
+  flush_put(id);
+  auto& s = streams_[id];
+  if ((way == 0) && (which & 1)) {
+    off -= static_cast<int32_t>(s.get.size() - s.gpos);
+  }
+  s.get.clear();
+  s.gpos = 0;
+
   Rpc(Rpc::Type::PUBSEEKOFF).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&off), sizeof(off));
@@ -149,6 +230,13 @@ inline uint32_t RemoteInterface::pubseekoff(FId id, int32_t off, uint8_t way, ui
 }
 
 inline uint32_t RemoteInterface::pubseekpos(FId id, int32_t pos, uint8_t which) {
+  // Absolute seeks invalidate the read-ahead buffer without requiring any
+  // adjustment to the runtime's get pointer.
+  flush_put(id);
+  auto& s = streams_[id];
+  s.get.clear();
+  s.gpos = 0;
+
   Rpc(Rpc::Type::PUBSEEKPOS).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&pos), sizeof(pos));
@@ -161,67 +249,175 @@ inline uint32_t RemoteInterface::pubseekpos(FId id, int32_t pos, uint8_t which)
 }
 
 inline int32_t RemoteInterface::pubsync(FId id) {
+  // Syncs are fire-and-forget. Anything in the write-behind buffer is sent
+  // first, and the runtime will sync its stream as soon as it sees this
+  // message. We optimistically report success.
+  flush_get(id);
+  flush_put(id);
   Rpc(Rpc::Type::PUBSYNC).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
-  sock_->flush();
-
-  int32_t res;
-  sock_->read(reinterpret_cast<char*>(&res), sizeof(res));
-  return res;
+  return 0;
 }
 
 inline int32_t RemoteInterface::sbumpc(FId id) {
-  Rpc(Rpc::Type::SBUMPC).serialize(*sock_);
-  sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
-  sock_->flush();
-
-  int32_t res;
-  sock_->read(reinterpret_cast<char*>(&res), sizeof(res));
-  return res;
+  auto& s = streams_[id];
+  if ((s.gpos == s.get.size()) && (fill(id) == 0)) {
+    return std::char_traits<char>::eof();
+  }
+  return std::char_traits<char>::to_int_type(s.get[s.gpos++]);
 }
 
 inline int32_t RemoteInterface::sgetc(FId id) {
-  Rpc(Rpc::Type::SGETC).serialize(*sock_);
-  sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
-  sock_->flush();
-
-  int32_t res;
-  sock_->read(reinterpret_cast<char*>(&res), sizeof(res));
-  return res;
+  auto& s = streams_[id];
+  if ((s.gpos == s.get.size()) && (fill(id) == 0)) {
+    return std::char_traits<char>::eof();
+  }
+  return std::char_traits<char>::to_int_type(s.get[s.gpos]);
 }
 
 inline uint32_t RemoteInterface::sgetn(FId id, char* c, uint32_t n) {
-  Rpc(Rpc::Type::SGETN).serialize(*sock_);
+  // Consume whatever is left in the read-ahead buffer
+  auto& s = streams_[id];
+  const uint32_t avail = s.get.size() - s.gpos;
+  const auto first = std::min(avail, n);
+  std::copy(s.get.begin()+s.gpos, s.get.begin()+s.gpos+first, c);
+  s.gpos += first;
+  if (first == n) {
+    return n;
+  }
+
+  // Requests which are too big to buffer go straight to the runtime.
+  // Everything else is handled by refilling the read-ahead buffer.
+  if ((n - first) >= buffer_size_) {
+    flush_put(id);
+    return first + sgetn_remote(id, c+first, n-first);
+  }
+  const auto second = std::min(fill(id), n-first);
+  std::copy(s.get.begin(), s.get.begin()+second, c+first);
+  s.gpos += second;
+  return first + second;
+}
+
+inline int32_t RemoteInterface::sputc(FId id, char c) {
+  // Puts are appended to the write-behind buffer and sent to the runtime in
+  // bulk. We optimistically report success.
+  flush_get(id);
+  auto& s = streams_[id];
+  s.put.push_back(c);
+  if (s.put.size() >= buffer_size_) {
+    flush_put(id);
+  }
+  return std::char_traits<char>::to_int_type(c);
+}
+
+inline uint32_t RemoteInterface::sputn(FId id, const char* c, uint32_t n) {
+  // See the note on sputc() above.
+  flush_get(id);
+  auto& s = streams_[id];
+  s.put.insert(s.put.end(), c, c+n);
+  if (s.put.size() >= buffer_size_) {
+    flush_put(id);
+  }
+  return n;
+}
+
+inline void RemoteInterface::flush() {
+  // Step boundary: return unused read-ahead data and send everything that's
+  // been buffered in the write-behind buffers. Whatever happens to these
+  // streams before the next step is invisible to us, so the runtime's stream
+  // positions have to be exact once it's processed these messages.
+  for (auto& s : streams_) {
+    flush_get(s.first);
+  }
+  flush_puts();
+  if (dirty_.empty()) {
+    return;
+  }
+  Rpc(Rpc::Type::WRITE_BATCH, 0, 0, dirty_.size()).serialize(*sock_);
+  for (auto id : dirty_) {
+    sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
+    sock_->put(write_type_[id]);
+    if (write_type_[id] == BOOL) {
+      sock_->put(write_buf_[id].to_bool() ? 1 : 0);
+    } else {
+      write_buf_[id].serialize(*sock_);
+    }
+    write_type_[id] = CLEAN;
+  }
+  dirty_.clear();
+}
+
+inline void RemoteInterface::mark_dirty(VId id, WriteType type) {
+  if (id >= write_buf_.size()) {
+    write_buf_.resize(id+1);
+    write_type_.resize(id+1, CLEAN);
+  }
+  if (write_type_[id] == CLEAN) {
+    dirty_.push_back(id);
+  }
+  write_type_[id] = type;
+}
+
+inline uint32_t RemoteInterface::fill(FId id) {
+  flush_put(id);
+  auto& s = streams_[id];
+  s.get.resize(buffer_size_);
+  s.get.resize(sgetn_remote(id, s.get.data(), buffer_size_));
+  s.gpos = 0;
+  return s.get.size();
+}
+
+inline void RemoteInterface::release() {
+  flush();
+}
+
+inline void RemoteInterface::flush_get(FId id) {
+  // Nothing to do if the read-ahead buffer has been consumed. Otherwise, roll
+  // back the runtime's get pointer to the first character we haven't used.
+  // The runtime handles messages in order, so there's no need to wait for it
+  // to do so before sending anything else.
+  auto& s = streams_[id];
+  if (s.gpos == s.get.size()) {
+    return;
+  }
+  const uint32_t n = s.get.size() - s.gpos;
+  s.get.clear();
+  s.gpos = 0;
+  Rpc(Rpc::Type::UNGETN).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&n), sizeof(n));
-  sock_->flush();
-
-  uint32_t res;
-  sock_->read(reinterpret_cast<char*>(&res), sizeof(res));
-  sock_->read(c, res);
-  return res;
 }
 
-inline int32_t RemoteInterface::sputc(FId id, char c) {
-  Rpc(Rpc::Type::SPUTC).serialize(*sock_);
+inline void RemoteInterface::flush_put(FId id) {
+  auto& s = streams_[id];
+  if (s.put.empty()) {
+    return;
+  }
+  // Puts are fire-and-forget. The runtime doesn't send a reply, so there's no
+  // need to flush the socket here.
+  const uint32_t n = s.put.size();
+  Rpc(Rpc::Type::SPUTN).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
-  sock_->put(c);
-  sock_->flush();
+  sock_->write(reinterpret_cast<const char*>(&n), sizeof(n));
+  sock_->write(s.put.data(), n);
+  s.put.clear();
+}
 
-  int32_t res;
-  sock_->read(reinterpret_cast<char*>(&res), sizeof(res));
-  return res;
+inline void RemoteInterface::flush_puts() {
+  for (auto& s : streams_) {
+    flush_put(s.first);
+  }
 }
 
-inline uint32_t RemoteInterface::sputn(FId id, const char* c, uint32_t n) {
-  Rpc(Rpc::Type::SPUTN).serialize(*sock_);
+inline uint32_t RemoteInterface::sgetn_remote(FId id, char* c, uint32_t n) {
+  Rpc(Rpc::Type::SGETN).serialize(*sock_);
   sock_->write(reinterpret_cast<const char*>(&id), sizeof(id));
   sock_->write(reinterpret_cast<const char*>(&n), sizeof(n));
-  sock_->write(c, n);
   sock_->flush();
 
   uint32_t res;
   sock_->read(reinterpret_cast<char*>(&res), sizeof(res));
+  sock_->read(c, res);
   return res;
 }
 
@@ -68,8 +68,7 @@ struct Rpc : Serializable {
     OPEN_LOOP,
 
     // Interface API:
-    WRITE_BITS,
-    WRITE_BOOL,
+    WRITE_BATCH,
 
     DEBUG,
     FINISH,
@@ -82,11 +81,9 @@ struct Rpc : Serializable {
     PUBSEEKOFF,
     PUBSEEKPOS,
     PUBSYNC,
-    SBUMPC,
-    SGETC,
     SGETN,
-    SPUTC,
     SPUTN,
+    UNGETN,
 
     // Proxy Compiler Codes:
     OPEN_CONN_1,
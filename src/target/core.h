@@ -64,6 +64,13 @@ class Core {
     // Target-specific implementations may override this method to perform
     // last minute initialization prior to beginning execution.
     virtual void finalize();
+    // Target-specific implementations may override this method to move the
+    // values of all stateful elements and inputs directly into c, without
+    // going through get_state() and get_input(). It is called at most once
+    // before this core is torn down, and c is finalized afterwards. This
+    // method must return false without modifying c if c is not a compatible
+    // core. The default implementation always returns false.
+    virtual bool transfer_to(Core* c);
 
     // Overriding this method to return true will cause the runtime to call the
     // done_step() method at the end of each logical time step. The default
@@ -190,6 +197,11 @@ inline void Core::finalize() {
   // Does nothing.
 }
 
+inline bool Core::transfer_to(Core* c) {
+  (void) c;
+  return false;
+}
+
 inline bool Core::overrides_done_step() const {
   return false;
 }
@@ -34,9 +34,7 @@
 #include <cassert>
 #include <iostream>
 #include <streambuf>
-#include "common/cachestream.h"
 #include "runtime/runtime.h"
-#include "target/compiler/remote_interface.h"
 #include "target/interface.h"
 
 namespace cascade {
@@ -82,9 +80,6 @@ class interfacestream : public std::iostream {
 
   private:
     interfacebuf buf_;
-    cachebuf cache_;
-
-    std::streambuf* get_buf(Interface* interface);
 };
 
 inline interfacebuf::interfacebuf(Interface* interface, FId id) {
@@ -131,11 +126,7 @@ inline std::streambuf::int_type interfacebuf::overflow(int_type c) {
   return interface_->sputc(id_, c);
 }
 
-inline interfacestream::interfacestream(Interface* interface, FId id) : std::iostream(get_buf(interface)), buf_(interface, id), cache_(&buf_, 1024) { }
-
-inline std::streambuf* interfacestream::get_buf(Interface* interface) {
-  return (dynamic_cast<RemoteInterface*>(interface) != nullptr) ? static_cast<std::streambuf*>(&cache_) : static_cast<std::streambuf*>(&buf_);
-}
+inline interfacestream::interfacestream(Interface* interface, FId id) : std::iostream(&buf_), buf_(interface, id) { }
 
 } // namespace cascade
 
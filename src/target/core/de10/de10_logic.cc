@@ -108,13 +108,21 @@ State* De10Logic::get_state() {
   auto* s = new State();
   for (const auto& sv : state_) {
     table_.read_var(sv.second);
-    s->insert(sv.first, Evaluate().get_array_value(sv.second));
+    if (const auto* pa = Evaluate().get_packed_value(sv.second)) {
+      s->insert(sv.first, *pa);
+    } else {
+      s->insert(sv.first, Evaluate().get_array_value(sv.second));
+    }
   }
   return s;
 }
 
 void De10Logic::set_state(const State* s) {
   for (const auto& sv : state_) {
+    if (const auto* pa = s->find_packed(sv.first)) {
+      table_.write_var(sv.second, *pa);
+      continue;
+    }
     const auto itr = s->find(sv.first);
     if (itr != s->end()) {
       table_.write_var(sv.second, itr->second);
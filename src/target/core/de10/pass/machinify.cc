@@ -256,6 +256,73 @@ void Machinify::Generate::visit(const ConditionalStatement* cs) {
   }
 }
 
+void Machinify::Generate::visit(const ForStatement* fs) {
+  // Loops only reach this point if they were too large to unroll.
+  auto* init = new BlockingAssign(fs->get_init()->get_lhs()->clone(), fs->get_init()->get_rhs()->clone());
+  if (!task_states_.empty() && (task_states_.back() == current().first)) {
+    transition(current().first+1);
+    next_state();
+  }
+  current().second->push_back_stmts(init);
+  loop(fs->get_cond(), fs->get_stmt(), fs->get_update());
+}
+
+void Machinify::Generate::visit(const RepeatStatement* rs) {
+  // LoopUnroll rewrites any repeat statement that it can't unroll into a for
+  // loop over a fresh counter. The only repeats that reach this point are
+  // nested inside of other loops.
+  append(rs);
+}
+
+void Machinify::Generate::visit(const WhileStatement* ws) {
+  if (!task_states_.empty() && (task_states_.back() == current().first)) {
+    transition(current().first+1);
+    next_state();
+  }
+  loop(ws->get_cond(), ws->get_stmt(), nullptr);
+}
+
+void Machinify::Generate::loop(const Expression* cond, const Statement* s, const VariableAssign* update) {
+  // Record the current state. This is where we'll check the loop guard for
+  // the first time.
+  const auto begin = current();
+
+  // The body of the loop gets its own states. If it ends in a task, we'll
+  // need to break before updating the loop variable, since the runtime won't
+  // evaluate the arguments to the task until the end of this state.
+  next_state();
+  const auto body_begin = current();
+  s->accept(this);
+  if (!task_states_.empty() && (task_states_.back() == current().first)) {
+    transition(current().first+1);
+    next_state();
+  }
+  const auto body_end = current();
+  if (update != nullptr) {
+    body_end.second->push_back_stmts(new BlockingAssign(update->get_lhs()->clone(), update->get_rhs()->clone()));
+  }
+
+  // And we need one more state to exit to
+  next_state();
+  const auto exit = current();
+
+  // Both the beginning of the loop and the end of its body check the guard
+  // and either jump back to the top of the body or fall through to the exit.
+  for (auto* sb : {begin.second, body_end.second}) {
+    sb->push_back_stmts(new ConditionalStatement(
+      cond->clone(),
+      new NonblockingAssign(
+        new Identifier(new Id("__state"), new Number(Bits(32, idx_))),
+        new Number(Bits(32, body_begin.first))
+      ),
+      new NonblockingAssign(
+        new Identifier(new Id("__state"), new Number(Bits(32, idx_))),
+        new Number(Bits(32, exit.first))
+      )
+    ));
+  }
+}
+
 pair<size_t, SeqBlock*> Machinify::Generate::current() const {
   const auto n = machine_->size_items()-1;
   auto* sb = static_cast<SeqBlock*>(machine_->back_items()->get_stmt());
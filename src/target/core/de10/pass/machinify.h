@@ -77,6 +77,9 @@ class Machinify {
         void visit(const SeqBlock* sb) override;
         void visit(const CaseStatement* cs) override;
         void visit(const ConditionalStatement* cs) override;
+        void visit(const ForStatement* fs) override;
+        void visit(const RepeatStatement* rs) override;
+        void visit(const WhileStatement* ws) override;
 
         // Returns the index of the current state and a pointer to the
         // corresponding case item.
@@ -93,6 +96,9 @@ class Machinify {
         // non-empty and the current state is not a task state, appends a
         // non-blocking assign task_id <= 0;
         void next_state();
+        // Lowers a loop into a sequence of states which execute one
+        // iteration at a time. Update may be null.
+        void loop(const Expression* cond, const Statement* s, const VariableAssign* update);
         // Transforms an event into a trigger signal
         Identifier* to_guard(const Event* e) const;
     };
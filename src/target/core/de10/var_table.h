@@ -34,6 +34,7 @@
 #include <cassert>
 #include <unordered_map>
 #include "common/bits.h"
+#include "common/packed_array.h"
 #include "common/vector.h"
 #include "target/core/de10/io.h"
 #include "verilog/analyze/evaluate.h"
@@ -120,6 +121,8 @@ class VarTable {
     void write_var(const Identifier* id, const Bits& val);
     // Writes the value of an array variable
     void write_var(const Identifier* id, const Vector<Bits>& val);
+    // Writes the value of an array variable from packed storage
+    void write_var(const Identifier* id, const PackedArray& val);
 
     // Reads the value of an expression
     T read_expr(const Expression* e) const;
@@ -335,6 +338,24 @@ inline void VarTable<T>::write_var(const Identifier* id, const Vector<Bits>& val
   }
 }
 
+template <typename T>
+inline void VarTable<T>::write_var(const Identifier* id, const PackedArray& val) {
+  const auto itr = vtable_.find(id);
+  assert(itr != vtable_.end());
+  assert(val.size() == itr->second.elements);
+
+  Bits b(val.width(), 0);
+  auto idx = itr->second.begin;
+  for (size_t i = 0; i < itr->second.elements; ++i) {
+    val.read(i, &b);
+    for (size_t j = 0; j < itr->second.words_per_element; ++j) {
+      const volatile auto word = b.read_word<T>(j);
+      DE10_WRITE(mangle(idx), word);
+      ++idx;
+    }
+  }
+}
+
 template <typename T>
 inline T VarTable<T>::read_expr(const Expression* e) const {
   const auto itr = etable_.find(e);
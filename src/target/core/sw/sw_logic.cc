@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <unordered_set>
 #include "target/core/common/interfacestream.h"
 #include "target/core/common/printf.h"
 #include "target/core/common/scanf.h"
@@ -49,9 +50,9 @@ using namespace std;
 namespace cascade {
 
 SwLogic::SwLogic(Interface* interface, ModuleDeclaration* md) : Logic(interface), Visitor() { 
-  // Record pointer to source code and provision update pool
+  // Record pointer to source code and provision update slots
   src_ = md;
-  update_pool_.resize(1);
+  schedule_updates();
 
   // Initialize monitors and system tasks
   for (auto i = src_->begin_items(), ie = src_->end_items(); i != ie; ++i) {
@@ -63,6 +64,8 @@ SwLogic::SwLogic(Interface* interface, ModuleDeclaration* md) : Logic(interface)
   });
   EofIndex ei(this);
   src_->accept(&ei);
+  CaseIndex ci(this);
+  src_->accept(&ci);
 
   // Set silent mode, schedule always constructs and continuous assigns, and then
   // place the silent flag in its default, disabled state
@@ -103,13 +106,22 @@ SwLogic& SwLogic::set_output(const Identifier* id, VId vid) {
 State* SwLogic::get_state() {
   auto* s = new State();
   for (const auto& sv : state_) {
-    s->insert(sv.first, eval_.get_array_value(sv.second));
+    if (const auto* pa = eval_.get_packed_value(sv.second)) {
+      s->insert(sv.first, *pa);
+    } else {
+      s->insert(sv.first, eval_.get_array_value(sv.second));
+    }
   }
   return s;
 }
 
 void SwLogic::set_state(const State* s) {
   for (const auto& sv : state_) {
+    if (const auto* pa = s->find_packed(sv.first)) {
+      eval_.assign_packed_value(sv.second, *pa);
+      notify(sv.second);
+      continue;
+    }
     const auto itr = s->find(sv.first);
     if (itr != s->end()) {
       eval_.assign_array_value(sv.second, itr->second);
@@ -147,6 +159,43 @@ void SwLogic::set_input(const Input* i) {
   silent_evaluate();
 }
 
+bool SwLogic::transfer_to(Core* c) {
+  // Nothing to do if c isn't another software core
+  auto* sl = dynamic_cast<SwLogic*>(c);
+  if (sl == nullptr) {
+    return false;
+  }
+
+  // Copy state and inputs straight from our evaluator into c's. Variables are
+  // matched by id, just as they would be by set_state() and set_input().
+  // Packed arrays are copied in bulk.
+  for (const auto& sv : sl->state_) {
+    const auto itr = state_.find(sv.first);
+    if (itr == state_.end()) {
+      continue;
+    }
+    if (const auto* pa = eval_.get_packed_value(itr->second)) {
+      sl->eval_.assign_packed_value(sv.second, *pa);
+    } else {
+      sl->eval_.assign_array_value(sv.second, eval_.get_array_value(itr->second));
+    }
+    sl->notify(sv.second);
+  }
+  for (size_t v = 0, ve = min(inputs_.size(), sl->inputs_.size()); v < ve; ++v) {
+    const auto* id = inputs_[v];
+    const auto* sid = sl->inputs_[v];
+    if ((id == nullptr) || (sid == nullptr)) {
+      continue;
+    }
+    if (sl->eval_.assign_value(sid, eval_.get_value(id))) {
+      sl->notify(sid);
+    }
+  }
+  sl->silent_evaluate();
+
+  return true;
+}
+
 void SwLogic::finalize() {
   // Handle calls to fopen.
   for (auto i = src_->begin_items(), ie = src_->end_items(); i != ie; ++i) {
@@ -209,10 +258,25 @@ void SwLogic::evaluate() {
 }
 
 bool SwLogic::there_are_updates() const {
-  return !updates_.empty();
+  return there_are_slot_updates_ || !updates_.empty();
 }
 
 void SwLogic::update() {
+  // Commit scheduled updates. Each dirty slot holds the last value which was
+  // assigned to its variable.
+  if (there_are_slot_updates_) {
+    for (size_t w = 0, we = dirty_.size(); w < we; ++w) {
+      for (auto bits = dirty_[w]; bits != 0; bits &= (bits-1)) {
+        const auto s = (w << 6) | __builtin_ctzll(bits);
+        if (eval_.assign_value(slot_ids_[s], 0, -1, -1, slot_vals_[s])) {
+          notify(slot_ids_[s]);
+        }
+      }
+      dirty_[w] = 0;
+    }
+    there_are_slot_updates_ = false;
+  }
+
   // This is a for loop. Updates happen simultaneously
   for (size_t i = 0, ie = updates_.size(); i < ie; ++i) {
     const auto& val = update_pool_[i];
@@ -248,6 +312,29 @@ void SwLogic::EofIndex::visit(const FeofExpression* fe) {
   sw_->eofs_.push_back(fe);
 }
 
+SwLogic::CaseIndex::CaseIndex(SwLogic* sw) : Visitor() {
+  sw_ = sw;
+}
+
+void SwLogic::CaseIndex::visit(const CaseStatement* cs) {
+  Visitor::visit(cs);
+  auto& table = const_cast<CaseStatement*>(cs)->table_;
+  if (CaseTable::can_compile(cs)) {
+    table = sw_->cases_.size();
+    sw_->cases_.push_back(CaseTable(cs));
+  } else {
+    table = no_table_;
+  }
+}
+
+SwLogic::UpdateIndex::UpdateIndex(vector<const NonblockingAssign*>* nas) : Visitor() {
+  nas_ = nas;
+}
+
+void SwLogic::UpdateIndex::visit(const NonblockingAssign* na) {
+  nas_->push_back(na);
+}
+
 void SwLogic::schedule_now(const Node* n) {
   n->accept(this);
 }
@@ -293,6 +380,49 @@ void SwLogic::silent_evaluate() {
   silent_ = false;
 }
 
+void SwLogic::schedule_updates() {
+  vector<const NonblockingAssign*> nas;
+  UpdateIndex ui(&nas);
+  src_->accept(&ui);
+
+  // Any variable which is the target of a partial assignment, either to an
+  // array element or to a bit slice, goes through the dynamic update list.
+  unordered_set<const Identifier*> partial;
+  for (auto* na : nas) {
+    const auto* r = Resolve().get_resolution(na->get_lhs());
+    assert(r != nullptr);
+    if (!r->empty_dim() || !na->get_lhs()->empty_dim()) {
+      partial.insert(r);
+    }
+  }
+
+  // Everything else gets a slot, numbered in the order it first appears
+  unordered_map<const Identifier*, size_t> slots;
+  size_t dynamic = 0;
+  for (auto* na : nas) {
+    const auto* r = Resolve().get_resolution(na->get_lhs());
+    auto& slot = const_cast<NonblockingAssign*>(na)->update_slot_;
+    if (partial.find(r) != partial.end()) {
+      slot = no_slot_;
+      ++dynamic;
+      continue;
+    }
+    auto itr = slots.find(r);
+    if (itr == slots.end()) {
+      itr = slots.insert(make_pair(r, slot_ids_.size())).first;
+      slot_ids_.push_back(r);
+    }
+    slot = itr->second;
+  }
+  slot_vals_.resize(slot_ids_.size());
+  dirty_.resize((slot_ids_.size() + 63) / 64, 0);
+  there_are_slot_updates_ = false;
+
+  // Provision the dynamic update pool with one entry per assignment. It will
+  // only grow beyond this if an assignment runs more than once per step.
+  update_pool_.resize(max(dynamic, static_cast<size_t>(1)));
+}
+
 interfacestream* SwLogic::get_stream(FId fd) {
   const auto itr = streams_.find(fd);
   if (itr != streams_.end()) {
@@ -310,6 +440,18 @@ void SwLogic::update_eofs() {
   }
 }
 
+void SwLogic::write_back() {
+  // Memories which were initialized from a file image can optionally be
+  // written back to that file. There's nowhere to report a failure here, so we
+  // don't try.
+  for (const auto& sv : state_) {
+    const auto* d = static_cast<const Declaration*>(sv.second->get_parent());
+    if (d->get_attrs()->find("__write_back")) {
+      eval_.write_back(sv.second);
+    }
+  }
+}
+
 void SwLogic::visit(const Event* e) {
   // TODO(eschkufz) Support for complex expressions 
   assert(e->get_expr()->is(Node::Tag::identifier));
@@ -344,20 +486,32 @@ void SwLogic::visit(const NonblockingAssign* na) {
   // TODO(eschkufz) Support for timing control
   assert(na->is_null_ctrl());
   
-  if (!silent_) {
-    const auto* r = Resolve().get_resolution(na->get_lhs());
-    assert(r != nullptr);
-    const auto target = eval_.dereference(r, na->get_lhs());
-    const auto& res = eval_.get_value(na->get_rhs());
-
-    const auto idx = updates_.size();
-    if (idx >= update_pool_.size()) {
-      update_pool_.resize(2*update_pool_.size());
-    } 
+  if (silent_) {
+    return;
+  }
 
-    updates_.push_back(make_tuple(r, get<0>(target), get<1>(target), get<2>(target)));
-    update_pool_[idx].copy(res);
+  // Fast Path: Overwrite this variable's shadow slot
+  const auto slot = na->update_slot_;
+  if (slot != no_slot_) {
+    slot_vals_[slot].copy(eval_.get_value(na->get_rhs()));
+    dirty_[slot >> 6] |= (uint64_t(1) << (slot & 63));
+    there_are_slot_updates_ = true;
+    return;
   }
+
+  // Slow Path: Record the target and value of this update
+  const auto* r = Resolve().get_resolution(na->get_lhs());
+  assert(r != nullptr);
+  const auto target = eval_.dereference(r, na->get_lhs());
+  const auto& res = eval_.get_value(na->get_rhs());
+
+  const auto idx = updates_.size();
+  if (idx >= update_pool_.size()) {
+    update_pool_.resize(2*update_pool_.size());
+  } 
+
+  updates_.push_back(make_tuple(r, get<0>(target), get<1>(target), get<2>(target)));
+  update_pool_[idx].copy(res);
 }
 
 void SwLogic::visit(const SeqBlock* sb) { 
@@ -368,6 +522,17 @@ void SwLogic::visit(const SeqBlock* sb) {
 
 void SwLogic::visit(const CaseStatement* cs) {
   const auto s = eval_.get_value(cs->get_cond()).to_uint();
+
+  // Fast Path: Look up the selector in this statement's table
+  if (cs->table_ != no_table_) {
+    const auto* stmt = cases_[cs->table_].find(s);
+    if (stmt != nullptr) {
+      schedule_now(stmt);
+    }
+    return;
+  }
+
+  // Slow Path: Check each item in order
   for (auto i = cs->begin_items(), ie = cs->end_items(); i != ie; ++i) { 
     for (auto j = (*i)->begin_exprs(), je = (*i)->end_exprs(); j != je; ++j) { 
       const auto c = eval_.get_value(*j).to_uint();
@@ -391,6 +556,26 @@ void SwLogic::visit(const ConditionalStatement* cs) {
   }
 }
 
+void SwLogic::visit(const ForStatement* fs) {
+  // Loops only reach this point if they were too large to unroll.
+  for (schedule_now(fs->get_init()); eval_.get_value(fs->get_cond()).to_bool(); schedule_now(fs->get_update())) {
+    schedule_now(fs->get_stmt());
+  }
+}
+
+void SwLogic::visit(const RepeatStatement* rs) {
+  const auto n = eval_.get_value(rs->get_cond()).to_uint();
+  for (size_t i = 0; i < n; ++i) {
+    schedule_now(rs->get_stmt());
+  }
+}
+
+void SwLogic::visit(const WhileStatement* ws) {
+  while (eval_.get_value(ws->get_cond()).to_bool()) {
+    schedule_now(ws->get_stmt());
+  }
+}
+
 void SwLogic::visit(const FflushStatement* fs) {
   if (!silent_) {
     const auto fd = eval_.get_value(fs->get_fd()).to_uint();
@@ -403,6 +588,7 @@ void SwLogic::visit(const FflushStatement* fs) {
 
 void SwLogic::visit(const FinishStatement* fs) {
   if (!silent_) {
+    write_back();
     interface()->finish(eval_.get_value(fs->get_arg()).to_uint());
     there_were_tasks_ = true;
   }
@@ -473,11 +659,19 @@ void SwLogic::visit(const RetargetStatement* rs) {
 
 void SwLogic::visit(const SaveStatement* ss) {
   if (!silent_) {
+    write_back();
     interface()->save(ss->get_arg()->get_readable_val());
     there_were_tasks_ = true;
   }
 }
 
+void SwLogic::visit(const VariableAssign* va) {
+  const auto& res = eval_.get_value(va->get_rhs());
+  if (eval_.assign_value(va->get_lhs(), res)) {
+    notify(Resolve().get_resolution(va->get_lhs()));
+  }
+}
+
 void SwLogic::log(const string& op, const Node* n) {
   cout << "[" << src_->get_id() << "] " << op << " " << n << endl;
 }
@@ -31,12 +31,14 @@
 #ifndef CASCADE_SRC_TARGET_CORE_SW_SW_LOGIC_H
 #define CASCADE_SRC_TARGET_CORE_SW_SW_LOGIC_H
 
+#include <stdint.h>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
 #include "common/bits.h"
 #include "target/core.h"
+#include "verilog/analyze/case_table.h"
 #include "verilog/analyze/evaluate.h"
 #include "verilog/ast/visitors/visitor.h"
 
@@ -60,6 +62,7 @@ class SwLogic : public Logic, public Visitor {
     Input* get_input() override;
     void set_input(const Input* i) override;
     void finalize() override; 
+    bool transfer_to(Core* c) override;
 
     void read(VId vid, const Bits* b) override;
     void evaluate() override;
@@ -75,6 +78,20 @@ class SwLogic : public Logic, public Visitor {
       private:
         SwLogic* sw_;
     };
+    class CaseIndex : public Visitor {
+      public:
+        CaseIndex(SwLogic* sw);
+        void visit(const CaseStatement* cs);
+      private:
+        SwLogic* sw_;
+    };
+    class UpdateIndex : public Visitor {
+      public:
+        UpdateIndex(std::vector<const NonblockingAssign*>* nas);
+        void visit(const NonblockingAssign* na);
+      private:
+        std::vector<const NonblockingAssign*>* nas_;
+    };
 
     // Source Management:
     ModuleDeclaration* src_;
@@ -82,6 +99,10 @@ class SwLogic : public Logic, public Visitor {
     std::vector<std::pair<const Identifier*, VId>> outputs_;
     std::unordered_map<VId, const Identifier*> state_;
     std::vector<const FeofExpression*> eofs_;
+    // Case statements whose labels are all constants are compiled to tables
+    // (see case_table.h). Everything else is evaluated by a linear scan.
+    static constexpr size_t no_table_ = CaseStatement::no_table_;
+    std::vector<CaseTable> cases_;
 
     // Control State:
     bool silent_;
@@ -89,6 +110,21 @@ class SwLogic : public Logic, public Visitor {
     std::vector<const Node*> active_;
     std::vector<std::tuple<const Identifier*,size_t,int,int>> updates_;
     std::vector<Bits> update_pool_;
+
+    // Update Schedule:
+    //
+    // Variables which are only ever the target of whole-variable nonblocking
+    // assignments are given a statically allocated shadow slot. Writes to
+    // these variables overwrite the slot and set its bit in the dirty set, and
+    // are committed in a single pass over that set. Everything else (array
+    // elements and bit slices) goes through updates_, which preserves
+    // execution order. Because a variable is never split across both, no
+    // ordering between the two is required.
+    static constexpr size_t no_slot_ = NonblockingAssign::no_slot_;
+    std::vector<const Identifier*> slot_ids_;
+    std::vector<Bits> slot_vals_;
+    std::vector<uint64_t> dirty_;
+    bool there_are_slot_updates_;
     Evaluate eval_;
     std::unordered_map<FId, interfacestream*> streams_;
 
@@ -99,10 +135,12 @@ class SwLogic : public Logic, public Visitor {
 
     // Finalize Helpers:
     void silent_evaluate();
+    void schedule_updates();
 
     // Control Helpers:
     interfacestream* get_stream(FId fd);
     void update_eofs();
+    void write_back();
 
     // Visitor Interface:
     void visit(const Event* e) override;
@@ -112,6 +150,9 @@ class SwLogic : public Logic, public Visitor {
     void visit(const SeqBlock* sb) override;
     void visit(const CaseStatement* cs) override;
     void visit(const ConditionalStatement* cs) override;
+    void visit(const ForStatement* fs) override;
+    void visit(const RepeatStatement* rs) override;
+    void visit(const WhileStatement* ws) override;
     void visit(const FflushStatement* fs) override;
     void visit(const FinishStatement* fs) override;
     void visit(const FseekStatement* fs) override;
@@ -121,6 +162,7 @@ class SwLogic : public Logic, public Visitor {
     void visit(const RestartStatement* rs) override;
     void visit(const RetargetStatement* rs) override;
     void visit(const SaveStatement* ss) override;
+    void visit(const VariableAssign* va) override;
 
     // Debug Printing:
     void log(const std::string& op, const Node* n);
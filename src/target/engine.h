@@ -87,6 +87,7 @@ class Engine {
     void set_clock_val(bool t);
 
     // Compiler Interface:
+    Interface* get_interface();
     void replace_with(Engine* e);
 
   private:
@@ -228,14 +229,21 @@ inline void Engine::set_clock_val(bool v) {
   c->set_val(v);
 }
 
+inline Interface* Engine::get_interface() {
+  return i_;
+}
+
 inline void Engine::replace_with(Engine* e) {
-  // Move state and inputs from this engine into the new engine
-  const auto* s = c_->get_state();
-  e->c_->set_state(s);
-  delete s;
-  const auto* i = c_->get_input();
-  e->c_->set_input(i);
-  delete i;
+  // Move state and inputs from this engine into the new engine. Compatible
+  // cores can do this directly. Everything else goes through State and Input.
+  if (!c_->transfer_to(e->c_)) {
+    const auto* s = c_->get_state();
+    e->c_->set_state(s);
+    delete s;
+    const auto* i = c_->get_input();
+    e->c_->set_input(i);
+    delete i;
+  }
   e->c_->finalize();
 
   // Now that we're done with our core and interface, delete them.
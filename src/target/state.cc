@@ -36,6 +36,10 @@ namespace cascade {
 
 void State::read(istream& is, size_t base) {
   state_.clear();
+  for (auto& p : packed_) {
+    delete p.second;
+  }
+  packed_.clear();
 
   size_t n = 0;
   is >> n;
@@ -55,13 +59,13 @@ void State::read(istream& is, size_t base) {
       bits.read(is, base);
       bits.resize(width);
       bits.reinterpret_type(static_cast<Bits::Type>(type));
-      state_[id].push_back(bits);
+      insert_element(id, arity, j, bits);
     }
   }  
 }
 
 void State::write(ostream& os, size_t base) const {
-  os << state_.size() << endl;
+  os << (state_.size() + packed_.size()) << endl;
   for (const auto& s : state_) {
     os << "  " << s.first << " " << s.second.size() << " " << s.second[0].size() << " " << static_cast<size_t>(s.second[0].get_type()) << endl;
     for (const auto& b : s.second) {
@@ -70,10 +74,25 @@ void State::write(ostream& os, size_t base) const {
       os << endl;
     }
   }
+  // Packed arrays are written one element at a time, in the same format.
+  for (const auto& p : packed_) {
+    os << "  " << p.first << " " << p.second->size() << " " << p.second->width() << " " << static_cast<size_t>(Bits::Type::UNSIGNED) << endl;
+    Bits b(p.second->width(), 0);
+    for (size_t i = 0, ie = p.second->size(); i < ie; ++i) {
+      p.second->read(i, &b);
+      os << "    ";
+      b.write(os, base);
+      os << endl;
+    }
+  }
 }
 
 size_t State::deserialize(istream& is) {
   state_.clear();
+  for (auto& p : packed_) {
+    delete p.second;
+  }
+  packed_.clear();
 
   // How many elements are in this state?
   uint32_t n = 0;
@@ -93,7 +112,7 @@ size_t State::deserialize(istream& is) {
     for (size_t j = 0; j < arity; ++j) {
       Bits bits;
       res += bits.deserialize(is);
-      state_[id].push_back(bits);
+      insert_element(id, arity, j, bits);
     }
   }
   return res;
@@ -101,7 +120,7 @@ size_t State::deserialize(istream& is) {
 
 size_t State::serialize(ostream& os) const {
   // How many elements are in this state?
-  uint32_t n = state_.size();
+  uint32_t n = state_.size() + packed_.size();
   os.write(reinterpret_cast<char*>(&n), 4);
   size_t res = 4;
 
@@ -118,8 +137,35 @@ size_t State::serialize(ostream& os) const {
       res += b.serialize(os);
     }
   }
+  // Packed arrays are serialized one element at a time, in the same format.
+  for (const auto& p : packed_) {
+    os.write(const_cast<char*>(reinterpret_cast<const char*>(&p.first)), 4);
+    res += 4;
+
+    uint32_t arity = p.second->size();
+    os.write(reinterpret_cast<char*>(&arity), 4);
+    res += 4;
+
+    Bits b(p.second->width(), 0);
+    for (size_t i = 0; i < arity; ++i) {
+      p.second->read(i, &b);
+      res += b.serialize(os);
+    }
+  }
   return res;
 }
 
+void State::insert_element(VId id, size_t arity, size_t idx, const Bits& b) {
+  // Arrays which are too large to store as a Vector are stored in packed form
+  if (arity <= 0xffff) {
+    state_[id].push_back(b);
+    return;
+  }
+  if (idx == 0) {
+    packed_.insert(make_pair(id, new PackedArray(arity, b.size())));
+  }
+  packed_[id]->write(idx, b);
+}
+
 } // namespace cascade
 
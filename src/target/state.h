@@ -33,6 +33,7 @@
 
 #include <unordered_map>
 #include "common/bits.h"
+#include "common/packed_array.h"
 #include "common/serializable.h"
 #include "common/vector.h"
 #include "runtime/ids.h"
@@ -41,19 +42,25 @@ namespace cascade {
 
 // This class is a target-angnostic representation of an Engine's internal
 // state. State generated by one engine, must be readable by another engine
-// whose implementation details are unknown to the first. 
+// whose implementation details are unknown to the first. Arrays which an
+// engine stores in packed form are copied in bulk and kept separately, since
+// they may contain more elements than a Vector can hold.
 
 class State : public Serializable {
   public:
     typedef std::unordered_map<VId, Vector<Bits>>::const_iterator const_iterator;
 
     State() = default;
-    ~State() override = default;
+    State(const State& rhs) = delete;
+    State& operator=(const State& rhs) = delete;
+    ~State() override;
 
     void insert(VId id, const Bits& b);
     void insert(VId id, const Vector<Bits>& bs);
+    void insert(VId id, const PackedArray& pa);
 
     const_iterator find(VId id) const;
+    const PackedArray* find_packed(VId id) const;
     const_iterator begin() const;
     const_iterator end() const;
 
@@ -64,8 +71,18 @@ class State : public Serializable {
 
   private:
     std::unordered_map<VId, Vector<Bits>> state_; 
+    std::unordered_map<VId, PackedArray*> packed_;
+
+    // Helper Methods:
+    void insert_element(VId id, size_t arity, size_t idx, const Bits& b);
 };
 
+inline State::~State() {
+  for (auto& p : packed_) {
+    delete p.second;
+  }
+}
+
 inline void State::insert(VId id, const Bits& b) {
   Vector<Bits> bs;
   bs.push_back(b);
@@ -76,10 +93,24 @@ inline void State::insert(VId id, const Vector<Bits>& bs) {
   state_.insert(std::make_pair(id, bs));
 }
 
+inline void State::insert(VId id, const PackedArray& pa) {
+  if (packed_.find(id) != packed_.end()) {
+    return;
+  }
+  auto* copy = new PackedArray(pa.size(), pa.width());
+  copy->assign(pa);
+  packed_.insert(std::make_pair(id, copy));
+}
+
 inline State::const_iterator State::find(VId id) const {
   return state_.find(id);
 }
 
+inline const PackedArray* State::find_packed(VId id) const {
+  const auto itr = packed_.find(id);
+  return (itr == packed_.end()) ? nullptr : itr->second;
+}
+
 inline State::const_iterator State::begin() const {
   return state_.begin();
 }
@@ -0,0 +1,91 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/analyze/case_table.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include "verilog/analyze/constant.h"
+#include "verilog/analyze/evaluate.h"
+#include "verilog/ast/ast.h"
+
+using namespace std;
+
+namespace cascade {
+
+bool CaseTable::can_compile(const CaseStatement* cs) {
+  for (auto i = cs->begin_items(), ie = cs->end_items(); i != ie; ++i) {
+    for (auto j = (*i)->begin_exprs(), je = (*i)->end_exprs(); j != je; ++j) {
+      if (!Constant().is_static_constant(*j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+CaseTable::CaseTable(const CaseStatement* cs) {
+  base_ = 0;
+  default_ = nullptr;
+
+  // Collect labels in order. Only the first occurrence of a label can ever be
+  // selected, and nothing after a default item can ever be selected.
+  unordered_set<uint64_t> seen;
+  for (auto i = cs->begin_items(), ie = cs->end_items(); i != ie; ++i) {
+    if ((*i)->empty_exprs()) {
+      default_ = (*i)->get_stmt();
+      break;
+    }
+    for (auto j = (*i)->begin_exprs(), je = (*i)->end_exprs(); j != je; ++j) {
+      const auto c = Evaluate().get_value(*j).to_uint();
+      if (seen.insert(c).second) {
+        sparse_.push_back(make_pair(c, (*i)->get_stmt()));
+      }
+    }
+  }
+  if (sparse_.empty()) {
+    return;
+  }
+  sort(sparse_.begin(), sparse_.end());
+
+  // Use a jump table if no more than three quarters of it would be empty
+  const auto lo = sparse_.front().first;
+  const auto hi = sparse_.back().first;
+  if ((hi - lo) < 4 * sparse_.size()) {
+    base_ = lo;
+    dense_.resize(hi - lo + 1, nullptr);
+    for (const auto& s : sparse_) {
+      dense_[s.first - lo] = s.second;
+    }
+    sparse_.clear();
+  }
+}
+
+} // namespace cascade
@@ -0,0 +1,107 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_ANALYZE_CASE_TABLE_H
+#define CASCADE_SRC_VERILOG_ANALYZE_CASE_TABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "verilog/ast/ast_fwd.h"
+
+namespace cascade {
+
+// This class compiles a case statement whose labels are all compile-time
+// constants into a lookup structure. Label sets which are dense are stored as
+// a jump table. Sparse label sets are stored as a sorted array which is
+// searched by bisection, which amounts to a balanced decision tree. Lookups
+// select the same statement as a linear scan would: selectors and labels are
+// compared by their integer values, the first item with a matching label
+// wins, and a default item is taken as soon as it is reached. This class does
+// not store any decorations in the AST, but does require up-to-date resolution
+// decorations (see resolve.h) to function correctly.
+
+class CaseTable {
+  public:
+    // Returns true if every label in this case statement is a compile-time
+    // constant. 
+    static bool can_compile(const CaseStatement* cs);
+
+    // Constructors:
+    //
+    // Builds a table for this case statement. Undefined if can_compile() is
+    // false.
+    explicit CaseTable(const CaseStatement* cs);
+
+    // Returns the statement which is selected by this value, or nullptr if no
+    // item matches.
+    const Statement* find(uint64_t val) const;
+    // Returns true if this table is stored as a jump table.
+    bool is_dense() const;
+
+  private:
+    // Jump table, indexed by val - base_:
+    uint64_t base_;
+    std::vector<const Statement*> dense_;
+    // Decision tree, sorted by label:
+    std::vector<std::pair<uint64_t, const Statement*>> sparse_;
+    // Default case:
+    const Statement* default_;
+};
+
+inline const Statement* CaseTable::find(uint64_t val) const {
+  if (!dense_.empty()) {
+    const auto idx = val - base_;
+    if ((idx < dense_.size()) && (dense_[idx] != nullptr)) {
+      return dense_[idx];
+    }
+    return default_;
+  }
+  size_t lo = 0;
+  size_t hi = sparse_.size();
+  while (lo < hi) {
+    const auto mid = lo + (hi - lo) / 2;
+    if (sparse_[mid].first < val) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return ((lo < sparse_.size()) && (sparse_[lo].first == val)) ? sparse_[lo].second : default_;
+}
+
+inline bool CaseTable::is_dense() const {
+  return !dense_.empty();
+}
+
+} // namespace cascade
+
+#endif
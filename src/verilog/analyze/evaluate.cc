@@ -30,6 +30,8 @@
 
 #include "verilog/analyze/evaluate.h"
 
+#include "verilog/analyze/memory.h"
+
 using namespace std;
 
 namespace cascade {
@@ -117,9 +119,29 @@ const Vector<Bits>& Evaluate::get_array_value(const Identifier* i) {
     const_cast<Identifier*>(i)->accept(this);
     const_cast<Identifier*>(i)->set_flag<0>(false);
   }
+  // Packed arrays are copied out on demand. This method is never invoked
+  // along the critical path, and the copy is released the next time that an
+  // individual element is accessed. Arrays with more than 2^16 elements can't
+  // be copied this way; use get_packed_value() instead.
+  if (i->packed_val_ != nullptr) {
+    auto* id = const_cast<Identifier*>(i);
+    const auto n = id->packed_val_->size();
+    const auto elem = id->bit_val_[0];
+    id->bit_val_.resize(n, elem);
+    for (size_t j = 0; j < n; ++j) {
+      id->packed_val_->read(j, &id->bit_val_[j]);
+    }
+  }
   return i->bit_val_;
 }
 
+const PackedArray* Evaluate::get_packed_value(const Identifier* i) {
+  if (i->bit_val_.empty()) {
+    init(const_cast<Identifier*>(i));
+  }
+  return i->packed_val_;
+}
+
 pair<size_t, size_t> Evaluate::get_range(const Expression* e) {
   if (e->is(Node::Tag::range_expression)) {
     const auto* re = static_cast<const RangeExpression*>(e);
@@ -164,13 +186,15 @@ bool Evaluate::assign_value(const Identifier* id, const Bits& val) {
   const auto idx = static_cast<size_t>(get<0>(dres));
 
   // Corner Case: Ignore writes to out of range indices
-  if (idx >= r->bit_val_.size()) {
+  if (idx >= get_size(r)) {
     return false;
   }
   // Simple Case: Full Assignment
   if (get<1>(dres) == -1) {
-    if (!r->bit_val_[idx].eq(val)) {
-      const_cast<Identifier*>(r)->bit_val_[idx].assign(val);
+    auto& elem = load(r, idx);
+    if (!elem.eq(val)) {
+      elem.assign(val);
+      store(r, idx);
       flag_changed(r);
       return true;
     }
@@ -183,8 +207,10 @@ bool Evaluate::assign_value(const Identifier* id, const Bits& val) {
   // Partial Case: Write as much as possible to a partially valid range
   const auto msb = min(static_cast<size_t>(get<1>(dres)), get_width(r)-1);
   const auto lsb = min(static_cast<size_t>(get<2>(dres)), get_width(r)-1);
-  if (!r->bit_val_[idx].eq(msb, lsb, val)) {
-    const_cast<Identifier*>(r)->bit_val_[idx].assign(msb, lsb, val);
+  auto& elem = load(r, idx);
+  if (!elem.eq(msb, lsb, val)) {
+    elem.assign(msb, lsb, val);
+    store(r, idx);
     flag_changed(r);
     return true;
   }
@@ -201,9 +227,34 @@ void Evaluate::assign_array_value(const Identifier* id, const Vector<Bits>& val)
 
   // Perform the assignment. This method is never invoked along the critical
   // path. There's no need to short-circuit after performing an equality check.
-  assert(val.size() == id->bit_val_.size());
-  for (size_t i = 0, ie = id->bit_val_.size(); i < ie; ++i) {
-    const_cast<Identifier*>(r)->bit_val_[i].assign(val[i]);
+  assert(val.size() == get_size(r));
+  for (size_t i = 0, ie = val.size(); i < ie; ++i) {
+    load(r, i).assign(val[i]);
+    store(r, i);
+  }
+  flag_changed(r);
+}
+
+void Evaluate::assign_packed_value(const Identifier* id, const PackedArray& val) {
+  // Find the variable that we're referring to. 
+  const auto* r = Resolve().get_resolution(id);
+  assert(r != nullptr);
+  if (r->bit_val_.empty()) {
+    init(const_cast<Identifier*>(r));
+  }
+
+  // Perform the assignment. Copy in bulk if possible, and element by element
+  // otherwise.
+  assert(val.size() == get_size(r));
+  if ((r->packed_val_ != nullptr) && (r->packed_val_->width() == val.width())) {
+    r->packed_val_->assign(val);
+  } else {
+    Bits b(val.width(), 0);
+    for (size_t i = 0, ie = val.size(); i < ie; ++i) {
+      val.read(i, &b);
+      load(r, i).assign(b);
+      store(r, i);
+    }
   }
   flag_changed(r);
 }
@@ -226,7 +277,7 @@ tuple<size_t,int,int> Evaluate::dereference(const Identifier* r, const Identifie
   // The index we're looking for
   size_t idx = 0;
   // Multiplier for multi-dimensional arrays
-  size_t mul = r->bit_val_.size();
+  size_t mul = get_size(r);
 
   // Walk along subscripts 
   for (auto re = r->end_dim(); ritr != re; ++iitr, ++ritr) {
@@ -251,13 +302,15 @@ bool Evaluate::assign_value(const Identifier* id, size_t idx, int msb, int lsb,
   }
 
   // Corner Case: Ignore writes to out of bounds indices
-  if (idx >= id->bit_val_.size()) {
+  if (idx >= get_size(id)) {
     return false;
   }
   // Fast Path: Single bit assignments are easy to check
   if (msb == -1) {
-    if (!id->bit_val_[idx].eq(val)) {
-      const_cast<Identifier*>(id)->bit_val_[idx].assign(val);
+    auto& elem = load(id, idx);
+    if (!elem.eq(val)) {
+      elem.assign(val);
+      store(id, idx);
       flag_changed(id);
       return true;
     }
@@ -270,14 +323,29 @@ bool Evaluate::assign_value(const Identifier* id, size_t idx, int msb, int lsb,
   // Partial Case: Perform as much of the assignment as possible
   const auto m = min(static_cast<size_t>(msb), get_width(id)-1);
   const auto l = min(static_cast<size_t>(lsb), get_width(id)-1);
-  if (!id->bit_val_[idx].eq(m, l, val)) {
-    const_cast<Identifier*>(id)->bit_val_[idx].assign(m, l, val);
+  auto& elem = load(id, idx);
+  if (!elem.eq(m, l, val)) {
+    elem.assign(m, l, val);
+    store(id, idx);
     flag_changed(id);
     return true;
   }
   return false;
 }
 
+bool Evaluate::write_back(const Identifier* id) {
+  const auto* r = Resolve().get_resolution(id);
+  assert(r != nullptr);
+  if (r->packed_val_ == nullptr) {
+    return true;
+  }
+  const auto* image = static_cast<const Declaration*>(r->get_parent())->get_attrs()->get<Expression>("__image");
+  if ((image == nullptr) || !image->is(Node::Tag::string)) {
+    return true;
+  }
+  return r->packed_val_->write_back(static_cast<const String*>(image)->get_readable_val());
+}
+
 void Evaluate::flag_changed(const Identifier* id) {
   for (auto i = Resolve().use_begin(id), ie = Resolve().use_end(id); i != ie; ++i) {
     const_cast<Expression*>(*i)->set_flag<0>(true);
@@ -423,18 +491,21 @@ void Evaluate::edit(Identifier* id) {
   const auto idx = static_cast<size_t>(get<0>(dres));
 
   // Corner Case: Ignore reads from out of bounds indices
-  if (idx >= get_array_value(r).size()) {
+  if (r->bit_val_.empty()) {
+    init(const_cast<Identifier*>(r));
+  }
+  if (idx >= get_size(r)) {
     return;
   }
   // Simple Case: Full value assignment
   else if (get<1>(dres) == -1) {
-    id->bit_val_[0].assign(get_array_value(r)[idx]);
+    id->bit_val_[0].assign(load(r, idx));
   } 
   // Partial Case: Ignore reads from bit ranges which are out of bounds
   else {
     const auto msb = min(static_cast<size_t>(get<1>(dres)), get_width(r)-1);
     const auto lsb = min(static_cast<size_t>(get<2>(dres)), get_width(r)-1);
-    id->bit_val_[0].assign(get_array_value(r)[idx], msb, lsb);
+    id->bit_val_[0].assign(load(r, idx), msb, lsb);
   }
 }
 
@@ -555,6 +626,29 @@ void Evaluate::init(Expression* e) {
   const_cast<Node*>(root)->accept(&cd);
 }
 
+size_t Evaluate::get_size(const Identifier* r) const {
+  return (r->packed_val_ != nullptr) ? r->packed_val_->size() : r->bit_val_.size();
+}
+
+Bits& Evaluate::load(const Identifier* r, size_t idx) {
+  auto* id = const_cast<Identifier*>(r);
+  if (id->packed_val_ == nullptr) {
+    return id->bit_val_[idx];
+  }
+  // Release the copy made by get_array_value() if there is one
+  if (id->bit_val_.size() > 1) {
+    Vector<Bits>(1, id->bit_val_[0]).swap(id->bit_val_);
+  }
+  id->packed_val_->read(idx, &id->bit_val_[0]);
+  return id->bit_val_[0];
+}
+
+void Evaluate::store(const Identifier* r, size_t idx) {
+  if (r->packed_val_ != nullptr) {
+    r->packed_val_->write(idx, r->bit_val_[0]);
+  }
+}
+
 void Evaluate::Invalidate::edit(BinaryExpression* be) {
   be->bit_val_.clear();
   be->set_flag<0>(true);
@@ -587,6 +681,10 @@ void Evaluate::Invalidate::edit(Concatenation* c) {
 
 void Evaluate::Invalidate::edit(Identifier* id) {
   id->bit_val_.clear();
+  if (id->packed_val_ != nullptr) {
+    delete id->packed_val_;
+    id->packed_val_ = nullptr;
+  }
   id->set_flag<0>(true);
   // Don't descend into a different subtree
 }
@@ -901,6 +999,22 @@ void Evaluate::SelfDetermine::edit(RegDeclaration* rd) {
     const auto rng = eval_->get_range(rd->get_dim());
     w = (rng.first-rng.second)+1;
   }
+  // Large memories and memories with file images are stored in packed form.
+  // We only need a single element to record width and type.
+  const auto* image = rd->get_attrs()->get<Expression>("__image");
+  const auto has_image = (image != nullptr) && image->is(Node::Tag::string);
+  if ((rd->get_id()->packed_val_ == nullptr) && ((arity >= min_packed_size_) || has_image) && Memory().is_memory(rd->get_id())) {
+    rd->get_id()->packed_val_ = new PackedArray(arity, w);
+    // Missing and short images are reported by the type checker. If the
+    // image has disappeared since then or can't be mapped, map() leaves the
+    // array zero-filled, just like any other packed array.
+    if (has_image) {
+      rd->get_id()->packed_val_->map(static_cast<const String*>(image)->get_readable_val());
+    }
+  }
+  if (rd->get_id()->packed_val_ != nullptr) {
+    arity = 1;
+  }
   // Allocate bits:
   rd->get_id()->bit_val_.resize(arity);
   for (size_t i = 0; i < arity; ++i) {
@@ -37,6 +37,7 @@
 #include <utility>
 #include <vector>
 #include "common/bits.h"
+#include "common/packed_array.h"
 #include "common/vector.h"
 #include "verilog/analyze/resolve.h"
 #include "verilog/ast/ast.h"
@@ -60,6 +61,13 @@ namespace cascade {
 // lexicographically ascending order. The array r[1:0][1:0] would be linearized
 // as follows: r[0][0] r[0][1] r[1][0] r[1][1].
 
+// Large arrays which behave like memories (see memory.h) are the exception to
+// this rule. Their values are stored in a packed array (see packed_array.h),
+// and their declarations are decorated with a single element which holds
+// their width and type, and serves as scratch space for accessing elements.
+// Memories which are annotated with an (*__image = "path"*) attribute are
+// always stored in packed form, and are initialized from that file.
+
 class Evaluate : public Editor {
   public:
     // Typedefs:
@@ -98,6 +106,10 @@ class Evaluate : public Editor {
     // Returns the array value of an identifier. Invoking this method on an identifier
     // which evaluates to a scalar returns a single element array.
     const Vector<Bits>& get_array_value(const Identifier* i);
+    // Returns the packed storage for an identifier, or nullptr if its value
+    // is stored element by element. Packed arrays may be too large for
+    // get_array_value() and should be read this way instead.
+    const PackedArray* get_packed_value(const Identifier* i);
     // Returns upper and lower values for ranges, get_value() twice otherwise.
     std::pair<size_t, size_t> get_range(const Expression* e);
 
@@ -109,6 +121,10 @@ class Evaluate : public Editor {
     // val. Invoking this method on an unresolvable id or one which refers to
     // an array subscript is undefined.
     void assign_array_value(const Identifier* id, const Vector<Bits>& val);
+    // High-level interface: Identical to assign_array_value(), but for
+    // packed arrays. If id's target is also packed, the copy is performed in
+    // bulk.
+    void assign_packed_value(const Identifier* id, const PackedArray& val);
 
     // Low-level interface: Returns an index into r's underlying array, as well
     // as bit range, based on the expressions in i's dimensions. This method is
@@ -125,6 +141,10 @@ class Evaluate : public Editor {
     // DOES NOT resolve id and then update the value which it finds there.
     template <typename B>
     void assign_word(const Identifier* id, size_t idx, size_t n, B b);
+    // Writes the value of a memory which was initialized from a file image
+    // back to that file. Does nothing for any other variable. Returns false
+    // on failure.
+    bool write_back(const Identifier* id);
 
     // Forced a recomputation for the next evaluation of any expression that
     // depends on this variable.
@@ -153,6 +173,11 @@ class Evaluate : public Editor {
     void edit(String* s) override;
     void edit(UnaryExpression* ue) override;
 
+    // The smallest array that we'll consider storing in packed form.
+    // Everything smaller than this is cheap enough to store element by
+    // element and slightly faster to access that way.
+    static constexpr size_t min_packed_size_ = 256;
+
     // Helper Methods:
     //
     // Returns the root of the expression tree containing e. See implementation
@@ -161,6 +186,16 @@ class Evaluate : public Editor {
     // Initializes the bit value associated with an identifier using the rules
     // of self- and context- determination to determine bit-width and sign.
     void init(Expression* e);
+    // Returns the number of elements in r's underlying array
+    size_t get_size(const Identifier* r) const;
+    // Returns a reference to the idx'th element in r's underlying array. For
+    // packed arrays, this is a copy which is only valid until the next call to
+    // this method, and which must be written back using store() if it is
+    // modified.
+    Bits& load(const Identifier* r, size_t idx);
+    // Writes back the element returned by load(). Does nothing for arrays
+    // which aren't packed.
+    void store(const Identifier* r, size_t idx);
 
     // Invalidates bit, size, and type info for the expressions in this subtree
     struct Invalidate : Editor {
@@ -233,8 +268,9 @@ inline void Evaluate::assign_word(const Identifier* id, size_t idx, size_t n, B
   if (id->bit_val_.empty()) {      
     init(const_cast<Identifier*>(id));
   }
-  assert(idx < id->bit_val_.size());
-  const_cast<Identifier*>(id)->bit_val_[idx].write_word<B>(n, b);
+  assert(idx < get_size(id));
+  load(id, idx).write_word<B>(n, b);
+  store(id, idx);
   flag_changed(id);
 }
 
@@ -0,0 +1,72 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/analyze/memory.h"
+
+#include <cassert>
+#include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
+
+using namespace std;
+
+namespace cascade {
+
+bool Memory::is_memory(const Identifier* id) {
+  const auto* r = Resolve().get_resolution(id);
+  assert(r != nullptr);
+
+  // Memories are one-dimensional arrays of integer-valued registers. The
+  // parser guarantees that array declarations don't have initial values.
+  const auto* p = r->get_parent();
+  if (!p->is(Node::Tag::reg_declaration) || (r->size_dim() != 1)) {
+    return false;
+  }
+  if (static_cast<const RegDeclaration*>(p)->get_type() == Declaration::Type::REAL) {
+    return false;
+  }
+  // Declarations which aren't part of a module yet don't have any uses that
+  // we can examine.
+  if (Resolve().get_origin(r) == nullptr) {
+    return false;
+  }
+  // Every reference to this variable must subscript a single element. We
+  // don't care whether the reference goes on to select bits from it.
+  for (auto i = Resolve().use_begin(r), ie = Resolve().use_end(r); i != ie; ++i) {
+    if (!(*i)->is(Node::Tag::identifier) || (*i == r)) {
+      continue;
+    }
+    if (static_cast<const Identifier*>(*i)->empty_dim()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace cascade
@@ -0,0 +1,56 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_ANALYZE_MEMORY_H
+#define CASCADE_SRC_VERILOG_ANALYZE_MEMORY_H
+
+#include "verilog/ast/ast_fwd.h"
+
+namespace cascade {
+
+// This class is used to determine whether an array behaves like a random
+// access memory: a one-dimensional array of integer-valued registers which is
+// only ever read or written one element at a time, through a subscript.
+// Arrays of this form can be stored in a flat block of memory (see
+// packed_array.h) rather than as an array of independent bit strings. This
+// class does not store any decorations in the AST, but does require
+// up-to-date resolution decorations (see resolve.h) to function correctly.
+
+class Memory {
+  public:
+    // Returns true if the variable that this identifier refers to is a
+    // memory. This method is undefined for identifiers which cannot be
+    // resolved.
+    bool is_memory(const Identifier* id);
+};
+
+} // namespace cascade
+
+#endif
@@ -66,12 +66,17 @@ class CaseStatement : public Statement {
     VAL_ATTR(Type, type);
     PTR_ATTR(Expression, cond);
     MANY_ATTR(CaseItem, items);
+
+    friend class SwLogic;
+    static constexpr size_t no_table_ = static_cast<size_t>(-1);
+    DECORATION(size_t, table);
 };
 
 inline CaseStatement::CaseStatement(Type type__, Expression* cond__) : Statement(Node::Tag::case_statement) {
   VAL_SETUP(type);
   PTR_SETUP(cond);
   parent_ = nullptr;
+  table_ = no_table_;
 }
 
 template <typename ItemsItr>
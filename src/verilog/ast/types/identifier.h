@@ -32,6 +32,7 @@
 #define CASCADE_SRC_VERILOG_AST_IDENTIFIER_H
 
 #include <string>
+#include "common/packed_array.h"
 #include "verilog/ast/types/expression.h"
 #include "verilog/ast/types/id.h"
 #include "verilog/ast/types/macro.h"
@@ -71,6 +72,8 @@ class Identifier : public Primary {
 
     friend class Resolve;
     DECORATION(const Identifier*, resolution);
+    friend class Evaluate;
+    DECORATION(PackedArray*, packed_val);
     friend class Monitor;
     friend class SwLogic;
     DECORATION(Vector<const Node*>, monitor);
@@ -81,6 +84,7 @@ inline Identifier::Identifier() : Primary(Node::Tag::identifier) {
   MANY_DEFAULT_SETUP(dim);
   parent_ = nullptr;
   resolution_ = nullptr;
+  packed_val_ = nullptr;
 }
 
 inline Identifier::Identifier(const std::string& id__) : Identifier(new Id(id__)) { }
@@ -108,6 +112,9 @@ inline Identifier::Identifier(IdsItr ids_begin__, IdsItr ids_end__, DimItr dim_b
 inline Identifier::~Identifier() {
   MANY_TEARDOWN(ids);
   MANY_TEARDOWN(dim);
+  if (packed_val_ != nullptr) {
+    delete packed_val_;
+  }
 }
 
 inline Identifier* Identifier::clone() const {
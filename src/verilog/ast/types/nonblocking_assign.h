@@ -68,6 +68,10 @@ class NonblockingAssign : public AssignStatement {
     MANY_ATTR(Identifier, lhs);
     PTR_ATTR(Expression, rhs);
 
+    friend class SwLogic;
+    static constexpr size_t no_slot_ = static_cast<size_t>(-1);
+    DECORATION(size_t, update_slot);
+
     explicit NonblockingAssign(Expression* rhs__);
 };
 
@@ -119,6 +123,7 @@ inline NonblockingAssign::NonblockingAssign(Expression* rhs__) : AssignStatement
   MANY_DEFAULT_SETUP(lhs); 
   PTR_SETUP(rhs); 
   parent_ = nullptr;
+  update_slot_ = no_slot_;
 }
 
 } // namespace cascade 
@@ -36,6 +36,7 @@
 #include <vector>
 #include "verilog/analyze/evaluate.h"
 #include "verilog/analyze/navigate.h"
+#include "verilog/analyze/read_set.h"
 #include "verilog/analyze/resolve.h"
 #include "verilog/ast/ast.h"
 #include "verilog/program/elaborate.h"
@@ -60,6 +61,24 @@ void Inline::outline_source(ModuleDeclaration* md) {
   ModuleInfo(md).invalidate();
 }
 
+void Inline::inline_source(ModuleDeclaration* md, const vector<ModuleInstantiation*>& mis) {
+  inline_ = true;
+  info_ = new ModuleInfo(md);
+  for (auto* mi : mis) {
+    inline_source(mi);
+  }
+  info_->invalidate();
+  delete info_;
+}
+
+void Inline::outline_source(ModuleDeclaration* md, const vector<ModuleInstantiation*>& mis) {
+  inline_ = false;
+  for (auto* mi : mis) {
+    outline_source(mi);
+  }
+  ModuleInfo(md).invalidate();
+}
+
 bool Inline::can_inline(const ModuleDeclaration* md) const {
   const auto* std = md->get_attrs()->get<String>("__std");
   const auto* no_inline = md->get_attrs()->get<String>("__no_inline");
@@ -232,11 +251,6 @@ void Inline::inline_source(ModuleInstantiation* mi) {
 }
 
 void Inline::outline_source(ModuleInstantiation* mi) {
-  // TODO(eschkufz) It's been a long time since this method was actually used. I'm adding
-  // an assertion here to flag the fact that it's almost certainly bit-rotted. If and when
-  // it goes back into production, we can remove this.
-  assert(false);
-
   // Nothing to do for code which has already been outlined
   if (!is_inlined(mi)) {
     return;
@@ -275,7 +289,7 @@ void Inline::outline_source(ModuleInstantiation* mi) {
           annot->eq("input") ? PortDeclaration::Type::INPUT : annot->eq("output") ? PortDeclaration::Type::OUTPUT : PortDeclaration::Type::INOUT,
           d->clone()
         );
-        pd->get_decl()->replace_attrs(new Attributes());
+        pd->get_decl()->get_attrs()->erase("__inline");
         pd->get_decl()->swap_id(d);
         src->push_back_items(pd);
         delete d;
@@ -284,6 +298,26 @@ void Inline::outline_source(ModuleInstantiation* mi) {
     } 
     src->push_back_items(item);
   }
+  // What's left of the inlined code are the connections. Drop the cached use
+  // sets of the variables they refer to before deleting them. These will be
+  // rebuilt on demand.
+  for (auto i = mi->inline_->front_clauses()->get_then()->begin_items(), ie = mi->inline_->front_clauses()->get_then()->end_items(); i != ie; ++i) {
+    assert((*i)->is(Node::Tag::continuous_assign));
+    auto* ca = static_cast<ContinuousAssign*>(*i);
+    for (const auto* e : vector<const Expression*>{ca->get_lhs(), ca->get_rhs()}) {
+      ReadSet rs(e);
+      for (auto* r : rs) {
+        if (!r->is(Node::Tag::identifier)) {
+          continue;
+        }
+        const auto* d = Resolve().get_resolution(static_cast<const Identifier*>(r));
+        if (d != nullptr) {
+          Resolve().invalidate(d->get_parent());
+        }
+      }
+    }
+  }
+
   // Remove what's left of the inlined code and revert decorations
   delete mi->inline_;
   mi->inline_ = nullptr;
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_VERILOG_PROGRAM_INLINE_H
 #define CASCADE_SRC_VERILOG_PROGRAM_INLINE_H
 
+#include <vector>
 #include "verilog/analyze/module_info.h"
 #include "verilog/ast/visitors/builder.h"
 #include "verilog/ast/visitors/editor.h"
@@ -46,6 +47,10 @@ class Inline : public Editor {
     // Source Generate Interface:
     void inline_source(ModuleDeclaration* md);
     void outline_source(ModuleDeclaration* md);
+    // Inlines or outlines a subset of the instantiations which appear in md,
+    // including those which appear in code that was inlined into md.
+    void inline_source(ModuleDeclaration* md, const std::vector<ModuleInstantiation*>& mis);
+    void outline_source(ModuleDeclaration* md, const std::vector<ModuleInstantiation*>& mis);
 
     // Query Interface:
     bool can_inline(const ModuleDeclaration* md) const;
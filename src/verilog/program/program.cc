@@ -32,6 +32,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <string>
+#include <tuple>
 #include "common/log.h"
 #include "verilog/analyze/evaluate.h"
 #include "verilog/analyze/module_info.h"
@@ -52,6 +54,7 @@ Program::Program() : Editor() {
   root_ditr_ = decls_.end();
   root_eitr_ = elabs_.end();
   typecheck(true);
+  set_inline_budget(0);
 }
 
 Program::Program(ModuleDeclaration* md) : Program() {
@@ -79,6 +82,11 @@ Program& Program::typecheck(bool tc) {
   return *this;
 }
 
+Program& Program::set_inline_budget(size_t n) {
+  inline_budget_ = n;
+  return *this;
+}
+
 bool Program::declare(ModuleDeclaration* md, Log* log, const Parser* p) {
   // Declarations inherit defaults from the root declaration. 
   if (root_decl() != decl_end()) {
@@ -150,6 +158,33 @@ void Program::outline_all() {
   }
 }
 
+bool Program::inline_module(const ModuleDeclaration* md) {
+  auto* mi = get_inst(md);
+  if ((mi == nullptr) || Inline().is_inlined(mi)) {
+    return false;
+  }
+  auto* host = get_host(mi);
+  auto* src = Elaborate().get_elaboration(mi);
+  if ((host == nullptr) || !Inline().can_inline(src)) {
+    return false;
+  }
+  separate_.erase(src);
+  Inline().inline_source(host, {mi});
+  return true;
+}
+
+bool Program::outline_module(const ModuleDeclaration* md) {
+  auto* mi = get_inst(md);
+  if ((mi == nullptr) || !Inline().is_inlined(mi)) {
+    return false;
+  }
+  auto* host = get_host(mi);
+  assert(host != nullptr);
+  separate_.insert(Elaborate().get_elaboration(mi));
+  Inline().outline_source(host, {mi});
+  return true;
+}
+
 const ModuleDeclaration* Program::src() const {
   return (root_eitr_ == elab_end()) ? nullptr : root_eitr_->second;
 }
@@ -339,15 +374,109 @@ void Program::edit(LoopGenerateConstruct* lgc) {
   gen_queue_.push_back(lgc);
 }
 
+Program::Size::Size() : Visitor() { }
+
+size_t Program::Size::count(const ModuleDeclaration* md) {
+  n_ = 0;
+  md->accept(this);
+  return n_;
+}
+
+void Program::Size::visit(const Attributes* as) {
+  // Attributes don't contribute to the size of generated code
+  (void) as;
+}
+
+void Program::Size::visit(const Identifier* id) {
+  Visitor::visit(id);
+  ++n_;
+}
+
+void Program::Size::visit(const Number* n) {
+  (void) n;
+  ++n_;
+}
+
+void Program::Size::visit(const CaseGenerateConstruct* cgc) {
+  if (Elaborate().is_elaborated(cgc)) {
+    Elaborate().get_elaboration(cgc)->accept(this);
+  }
+}
+
+void Program::Size::visit(const IfGenerateConstruct* igc) {
+  if (Elaborate().is_elaborated(igc)) {
+    Elaborate().get_elaboration(igc)->accept(this);
+  }
+}
+
+void Program::Size::visit(const LoopGenerateConstruct* lgc) {
+  if (Elaborate().is_elaborated(lgc)) {
+    for (auto* b : Elaborate().get_elaboration(lgc)) {
+      b->accept(this);
+    }
+  }
+}
+
+void Program::Size::visit(const ModuleInstantiation* mi) {
+  // Code which has been inlined counts towards the size of this module, but
+  // the contents of separate modules don't.
+  if (Inline().is_inlined(mi)) {
+    Inline().get_source(mi)->accept(this);
+  } else {
+    Visitor::visit(mi);
+  }
+}
+
 void Program::inline_all(ModuleDeclaration* md) {
+  // Inline from the leaves up, and collect the children which are still
+  // candidates for inlining along the way. This includes children which
+  // appear in code that was inlined into md.
+  vector<tuple<size_t, string, ModuleDeclaration*>> cs;
   for (auto& c : ModuleInfo(md).children()) {
     const auto* fid = Resolve().get_full_id(c.first);
     auto itr = elabs_.find(fid);
     delete fid;
     assert(itr != elabs_.end());
     inline_all(itr->second);
+
+    auto* src = itr->second;
+    if (Inline().is_inlined(static_cast<ModuleInstantiation*>(src->get_parent()))) {
+      continue;
+    }
+    if (!Inline().can_inline(src) || (separate_.find(src) != separate_.end())) {
+      continue;
+    }
+    if (inline_budget_ == 0) {
+      cs.push_back(make_tuple(0, "", src));
+    } else {
+      cs.push_back(make_tuple(Size().count(src), Resolve().get_readable_full_id(c.first), src));
+    }
+  }
+
+  // Consider the smallest children first. This maximizes the number of
+  // modules which fit within the budget. Ties are broken by name to keep code
+  // generation deterministic. Children which don't fit are left alone for
+  // good; they may already have been compiled on their own.
+  vector<ModuleInstantiation*> mis;
+  if (inline_budget_ == 0) {
+    for (auto& c : cs) {
+      mis.push_back(static_cast<ModuleInstantiation*>(get<2>(c)->get_parent()));
+    }
+  } else {
+    sort(cs.begin(), cs.end());
+    auto total = Size().count(md);
+    for (auto& c : cs) {
+      if ((total + get<0>(c)) <= inline_budget_) {
+        mis.push_back(static_cast<ModuleInstantiation*>(get<2>(c)->get_parent()));
+        total += get<0>(c);
+      } else {
+        separate_.insert(get<2>(c));
+      }
+    }
+  }
+  if (!mis.empty()) {
+    Inline().inline_source(md, mis);
   }
-  Inline().inline_source(md);
 }
 
 void Program::outline_all(ModuleDeclaration* md) {
@@ -361,4 +490,30 @@ void Program::outline_all(ModuleDeclaration* md) {
   }
 }
 
+ModuleInstantiation* Program::get_inst(const ModuleDeclaration* md) {
+  const auto* p = md->get_parent();
+  if ((p == nullptr) || !p->is(Node::Tag::module_instantiation)) {
+    return nullptr;
+  }
+  const auto* fid = Resolve().get_full_id(static_cast<const ModuleInstantiation*>(p)->get_iid());
+  auto itr = elabs_.find(fid);
+  delete fid;
+  if ((itr == elabs_.end()) || (itr->second != md)) {
+    return nullptr;
+  }
+  return static_cast<ModuleInstantiation*>(itr->second->get_parent());
+}
+
+ModuleDeclaration* Program::get_host(ModuleInstantiation* mi) {
+  // Follow parent pointers out of any code that mi was inlined into. Inlined
+  // code hangs off of the instantiation it replaced, so the first declaration
+  // we find is the module which mi is actually compiled as part of.
+  for (auto* n = mi->get_parent(); n != nullptr; n = n->get_parent()) {
+    if (n->is(Node::Tag::module_declaration)) {
+      return static_cast<ModuleDeclaration*>(n);
+    }
+  }
+  return nullptr;
+}
+
 } // namespace cascade
@@ -31,10 +31,12 @@
 #ifndef CASCADE_SRC_VERILOG_PROGRAM_PROGRAM_H
 #define CASCADE_SRC_VERILOG_PROGRAM_PROGRAM_H
 
+#include <unordered_set>
 #include <vector>
 #include "common/undo_map.h"
 #include "verilog/analyze/indices.h"
 #include "verilog/ast/visitors/editor.h"
+#include "verilog/ast/visitors/visitor.h"
 
 namespace cascade {
 
@@ -66,6 +68,10 @@ class Program : public Editor {
     //
     // Determines whether or not to disable typechecking
     Program& typecheck(bool tc);
+    // Sets the maximum size, measured in identifiers and constants, that a
+    // module may grow to as the result of inlining. Zero places no limit on
+    // inlining.
+    Program& set_inline_budget(size_t n);
 
     // Program Building Interface:
     //
@@ -90,10 +96,22 @@ class Program : public Editor {
 
     // Program Transformation Interface:
     // 
-    // Inline all modules with type __std == logic
+    // Inline all modules with type __std == logic. Modules are inlined from
+    // the leaves up. If there is an inlining budget, the smallest children of
+    // each module are inlined first, and children which would push their
+    // parent over budget are left alone. Modules which are left alone are
+    // never reconsidered by subsequent calls.
     void inline_all();
     // Outline all modules
     void outline_all();
+    // Inlines the module whose elaborated source is md into the module which
+    // contains it, regardless of the inlining budget. Returns false if md is
+    // the root, has already been inlined, or can't be inlined.
+    bool inline_module(const ModuleDeclaration* md);
+    // Outlines the module whose elaborated source is md. Returns false if md
+    // hasn't been inlined. Outlined modules are left alone by subsequent calls
+    // to inline_all().
+    bool outline_module(const ModuleDeclaration* md);
 
     // Top-level Source Interface:
     // 
@@ -132,6 +150,11 @@ class Program : public Editor {
     bool local_only_;
     bool expand_insts_;
     bool expand_gens_;
+    size_t inline_budget_;
+
+    // Inlining State:
+    // Modules which inline_all() has left alone, or which have been outlined
+    std::unordered_set<const ModuleDeclaration*> separate_;
 
     // Elaboration Helpers:
     void elaborate(Node* n, Log* log, const Parser* p);
@@ -148,8 +171,25 @@ class Program : public Editor {
     void edit(LoopGenerateConstruct* lgc) override;
 
     // Inlining Helpers:
+    class Size : public Visitor {
+      public:
+        Size();
+        ~Size() override = default;
+        size_t count(const ModuleDeclaration* md);
+      private:
+        size_t n_;
+        void visit(const Attributes* as) override;
+        void visit(const Identifier* id) override;
+        void visit(const Number* n) override;
+        void visit(const CaseGenerateConstruct* cgc) override;
+        void visit(const IfGenerateConstruct* igc) override;
+        void visit(const LoopGenerateConstruct* lgc) override;
+        void visit(const ModuleInstantiation* mi) override;
+    };
     void inline_all(ModuleDeclaration* md);
     void outline_all(ModuleDeclaration* md);
+    ModuleInstantiation* get_inst(const ModuleDeclaration* md);
+    ModuleDeclaration* get_host(ModuleInstantiation* mi);
 };
 
 } // namespace cascade
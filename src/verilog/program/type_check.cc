@@ -31,6 +31,7 @@
 #include "verilog/program/type_check.h"
 
 #include <sstream>
+#include <sys/stat.h>
 #include "common/log.h"
 #include "verilog/analyze/constant.h"
 #include "verilog/analyze/evaluate.h"
@@ -642,6 +643,17 @@ void TypeCheck::visit(const RegDeclaration* rd) {
   if (rd->is_non_null_val() && !Constant().is_static_constant(rd->get_val())) {
     error("Register initialization requires constant value", rd);
   }
+  // CHECK: File images are string literals attached to one-dimensional arrays
+  if (rd->get_attrs()->find("__image")) {
+    const auto* image = rd->get_attrs()->get<Expression>("__image");
+    if ((image == nullptr) || !image->is(Node::Tag::string)) {
+      error("The __image attribute requires a string literal path", rd);
+    } else if ((rd->get_id()->size_dim() != 1) || (rd->get_type() == Declaration::Type::REAL)) {
+      warn("The __image attribute is ignored for variables which are not one-dimensional arrays of integers", rd);
+    } else {
+      check_image(rd, static_cast<const String*>(image)->get_readable_val());
+    }
+  }
 }
 
 void TypeCheck::visit(const ModuleInstantiation* mi) {
@@ -712,17 +724,17 @@ void TypeCheck::visit(const ConditionalStatement* cs) {
 }
 
 void TypeCheck::visit(const ForStatement* fs) {
-  warn("Cascade attempts to statically unroll all loop statements and may hang if it is not possible to do so", fs);
+  warn("Cascade attempts to statically unroll loop statements and may hang if a loop does not terminate", fs);
   Visitor::visit(fs);
 }
 
 void TypeCheck::visit(const RepeatStatement* rs) {
-  warn("Cascade attempts to statically unroll all loop statements and may hang if it is not possible to do so", rs);
+  warn("Cascade attempts to statically unroll loop statements and may hang if a loop does not terminate", rs);
   Visitor::visit(rs);
 }
 
 void TypeCheck::visit(const WhileStatement* ws) {
-  warn("Cascade attempts to statically unroll all loop statements and may hang if it is not possible to do so", ws);
+  warn("Cascade attempts to statically unroll loop statements and may hang if a loop does not terminate", ws);
   Visitor::visit(ws);
 }
 
@@ -809,6 +821,36 @@ void TypeCheck::check_array(Identifier::const_iterator_dim begin, Identifier::co
   }
 }
 
+void TypeCheck::check_image(const RegDeclaration* rd, const string& path) {
+  // EXIT: We can't compute the size of this memory if its bounds aren't constant
+  const auto* dim = rd->get_id()->front_dim();
+  if (!Constant().is_static_constant(dim)) {
+    return;
+  }
+  if (rd->is_non_null_dim() && !Constant().is_static_constant(rd->get_dim())) {
+    return;
+  }
+  const auto arng = Evaluate().get_range(dim);
+  if (arng.first < arng.second) {
+    return;
+  }
+  const auto arity = (arng.first - arng.second) + 1;
+  size_t w = 1;
+  if (rd->is_non_null_dim()) {
+    const auto wrng = Evaluate().get_range(rd->get_dim());
+    w = (wrng.first - wrng.second) + 1;
+  }
+
+  // CHECK: The image exists and is at least as large as this memory
+  struct stat st;
+  if (stat(path.c_str(), &st) == -1) {
+    return error("Unable to open the file image for this memory", rd);
+  }
+  if (static_cast<size_t>(st.st_size) < arity * PackedArray::stride_for(w)) {
+    warn("The file image for this memory is too small, elements past the end of the file will be set to zero", rd);
+  }
+}
+
 Identifier::const_iterator_dim TypeCheck::check_deref(const Identifier* r, const Identifier* i) {
   const int diff = i->size_dim() - r->size_dim();
 
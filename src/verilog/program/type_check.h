@@ -125,6 +125,8 @@ class TypeCheck : public Visitor {
     void check_width(const RangeExpression* re);
     // Checks whether array dimensions are little-endian and begin at 0
     void check_array(Identifier::const_iterator_dim begin, Identifier::const_iterator_dim end);
+    // Checks whether the file image for a memory exists and covers it
+    void check_image(const RegDeclaration* rd, const std::string& path);
     // Checks whether a potentially subscripted identifier is a valid array
     // dereference, returns a pointer to the last unused element in its
     // dimensions so that further operations may check its slice.
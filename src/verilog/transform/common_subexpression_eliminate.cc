@@ -0,0 +1,444 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/transform/common_subexpression_eliminate.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include "verilog/analyze/evaluate.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/analyze/navigate.h"
+#include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
+#include "verilog/print/print.h"
+
+using namespace std;
+
+namespace cascade {
+
+CommonSubexpressionEliminate::CommonSubexpressionEliminate() : Rewriter() {
+  next_id_ = 0;
+}
+
+void CommonSubexpressionEliminate::run(ModuleDeclaration* md) {
+  // Don't reuse the names of temporaries introduced by a previous run
+  next_id_ = 0;
+  for (auto i = md->begin_items(), ie = md->end_items(); i != ie; ++i) {
+    if ((*i)->is_subclass_of(Node::Tag::declaration)) {
+      const auto& n = static_cast<const Declaration*>(*i)->get_id()->front_ids()->get_readable_sid();
+      if ((n.compare(0, 6, "__cse_") == 0) && (n.length() > 6) && isdigit(n[6])) {
+        next_id_ = max(next_id_, static_cast<size_t>(stoul(n.substr(6))) + 1);
+      }
+    }
+  }
+  const auto first_id = next_id_;
+
+  // Continuous assignments form a single region. Nothing is ever assigned in
+  // between them, and temporaries can be shared by any of them.
+  vector<ContinuousAssign*> cas;
+  for (auto i = md->begin_items(), ie = md->end_items(); i != ie; ++i) {
+    if ((*i)->is(Node::Tag::continuous_assign)) {
+      auto* ca = static_cast<ContinuousAssign*>(*i);
+      vector<size_t> tops;
+      unordered_set<const Identifier*> reads;
+      scan(ca->get_rhs(), 0, &tops, &reads);
+      cas.push_back(ca);
+    }
+  }
+  if (select(true)) {
+    Replace r(this);
+    for (auto* ca : cas) {
+      ca->accept_rhs(&r);
+      Evaluate().invalidate(ca->get_rhs());
+    }
+    for (auto i : defined_) {
+      auto& g = groups_[i];
+      cas_.push_back(new ContinuousAssign(new Identifier(g.temp), g.def));
+      g.def = nullptr;
+    }
+  }
+  reset();
+
+  // Everything else happens inside of always blocks
+  md->accept_items(this);
+  if (next_id_ == first_id) {
+    return;
+  }
+
+  for (auto* d : decls_) {
+    md->push_front_items(d);
+  }
+  for (auto* ca : cas_) {
+    md->push_back_items(ca);
+  }
+  decls_.clear();
+  cas_.clear();
+  Resolve().invalidate(md);
+  Navigate(md).invalidate();
+  ModuleInfo(md).invalidate();
+}
+
+CommonSubexpressionEliminate::Replace::Replace(CommonSubexpressionEliminate* cse) : Rewriter() {
+  cse_ = cse;
+}
+
+Expression* CommonSubexpressionEliminate::Replace::rewrite(BinaryExpression* be) {
+  Rewriter::rewrite(be);
+  return replace(be);
+}
+
+Expression* CommonSubexpressionEliminate::Replace::rewrite(ConditionalExpression* ce) {
+  Rewriter::rewrite(ce);
+  return replace(ce);
+}
+
+Expression* CommonSubexpressionEliminate::Replace::rewrite(Concatenation* c) {
+  Rewriter::rewrite(c);
+  return replace(c);
+}
+
+Expression* CommonSubexpressionEliminate::Replace::rewrite(Identifier* id) {
+  Rewriter::rewrite(id);
+  return replace(id);
+}
+
+Expression* CommonSubexpressionEliminate::Replace::rewrite(MultipleConcatenation* mc) {
+  Rewriter::rewrite(mc);
+  return replace(mc);
+}
+
+Expression* CommonSubexpressionEliminate::Replace::rewrite(UnaryExpression* ue) {
+  Rewriter::rewrite(ue);
+  return replace(ue);
+}
+
+Expression* CommonSubexpressionEliminate::Replace::replace(Expression* e) {
+  const auto itr = cse_->replace_.find(e);
+  if (itr == cse_->replace_.end()) {
+    return e;
+  }
+  const auto idx = itr->second;
+  cse_->replace_.erase(itr);
+
+  // The first occurrence we see becomes the definition of the temporary.
+  // Rewrites are bottom-up, so any smaller groups that it contains have
+  // already been replaced.
+  auto& g = cse_->groups_[idx];
+  if (g.def == nullptr) {
+    g.def = e->clone();
+    cse_->defined_.push_back(idx);
+  }
+  return new Identifier(g.temp);
+}
+
+ModuleItem* CommonSubexpressionEliminate::rewrite(AlwaysConstruct* ac) {
+  ac->accept_stmt(this);
+  return ac;
+}
+
+ModuleItem* CommonSubexpressionEliminate::rewrite(InitialConstruct* ic) {
+  // Initial blocks only run once. There's nothing to be gained here.
+  return ic;
+}
+
+Statement* CommonSubexpressionEliminate::rewrite(SeqBlock* sb) {
+  Rewriter::rewrite(sb);
+
+  // Find runs of assignments. Everything in a run executes in order and with
+  // nothing in between, so temporaries can be assigned at the top of the
+  // run and read anywhere below it until one of their inputs changes.
+  vector<pair<size_t, Statement*>> defs;
+  for (size_t i = 0, ie = sb->size_stmts(); i < ie; ) {
+    size_t j = i;
+    for (; j < ie; ++j) {
+      const auto* s = sb->get_stmts(j);
+      if (s->is(Node::Tag::blocking_assign)) {
+        if (static_cast<const BlockingAssign*>(s)->is_non_null_ctrl()) {
+          break;
+        }
+      } else if (s->is(Node::Tag::nonblocking_assign)) {
+        if (static_cast<const NonblockingAssign*>(s)->is_non_null_ctrl()) {
+          break;
+        }
+      } else {
+        break;
+      }
+    }
+
+    // Index the run. Subscripts on the left hand side of an assignment are
+    // evaluated before it takes effect. Assignments end the lifetime of
+    // anything which reads the variables they write. This is conservative
+    // for nonblocking assignments, whose writes don't take effect until the
+    // end of the time step, but it means that a temporary never spans a
+    // write to one of its inputs.
+    for (auto k = i; k < j; ++k) {
+      auto* s = sb->get_stmts(k);
+      vector<size_t> tops;
+      unordered_set<const Identifier*> reads;
+      auto* lhs = s->is(Node::Tag::blocking_assign) ?
+        static_cast<BlockingAssign*>(s)->get_lhs() :
+        static_cast<NonblockingAssign*>(s)->get_lhs();
+      auto* rhs = s->is(Node::Tag::blocking_assign) ?
+        static_cast<BlockingAssign*>(s)->get_rhs() :
+        static_cast<NonblockingAssign*>(s)->get_rhs();
+      for (size_t d = 0, de = lhs->size_dim(); d < de; ++d) {
+        scan(lhs->get_dim(d), k, &tops, &reads);
+      }
+      scan(rhs, k, &tops, &reads);
+      kill(Resolve().get_resolution(lhs));
+    }
+
+    // Replace members of this run and record where temporaries go
+    if (select(false)) {
+      Replace r(this);
+      for (auto k = i; k < j; ++k) {
+        auto* s = sb->get_stmts(k);
+        s->accept(&r);
+        if (s->is(Node::Tag::blocking_assign)) {
+          Evaluate().invalidate(static_cast<BlockingAssign*>(s)->get_rhs());
+        } else {
+          Evaluate().invalidate(static_cast<NonblockingAssign*>(s)->get_rhs());
+        }
+      }
+      for (auto i : defined_) {
+        auto& g = groups_[i];
+        defs.push_back(make_pair(g.hoist, new BlockingAssign(new Identifier(g.temp), g.def)));
+        g.def = nullptr;
+      }
+    }
+    reset();
+    i = (j == i) ? (j+1) : j;
+  }
+  if (defs.empty()) {
+    return sb;
+  }
+
+  // Splice temporaries into the block. Definitions were created in the order
+  // that their first occurrences were rewritten, so anything that a
+  // temporary depends on is assigned before it.
+  stable_sort(defs.begin(), defs.end(), [](const pair<size_t, Statement*>& a, const pair<size_t, Statement*>& b) {
+    return a.first < b.first;
+  });
+  vector<Statement*> ss;
+  auto d = defs.begin();
+  for (size_t i = 0; !sb->empty_stmts(); ++i) {
+    for (; (d != defs.end()) && (d->first == i); ++d) {
+      ss.push_back(d->second);
+    }
+    ss.push_back(sb->remove_front_stmts());
+  }
+  for (auto* s : ss) {
+    sb->push_back_stmts(s);
+  }
+  return sb;
+}
+
+bool CommonSubexpressionEliminate::scan(Expression* e, size_t stmt, vector<size_t>* tops, unordered_set<const Identifier*>* reads) {
+  // Collect the occurrences and reads beneath this expression
+  vector<size_t> below;
+  auto pure = true;
+  auto candidate = true;
+  switch (e->get_tag()) {
+    case Node::Tag::binary_expression: {
+      auto* be = static_cast<BinaryExpression*>(e);
+      pure = scan(be->get_lhs(), stmt, &below, reads) && pure;
+      pure = scan(be->get_rhs(), stmt, &below, reads) && pure;
+      break;
+    }
+    case Node::Tag::conditional_expression: {
+      auto* ce = static_cast<ConditionalExpression*>(e);
+      pure = scan(ce->get_cond(), stmt, &below, reads) && pure;
+      pure = scan(ce->get_lhs(), stmt, &below, reads) && pure;
+      pure = scan(ce->get_rhs(), stmt, &below, reads) && pure;
+      break;
+    }
+    case Node::Tag::concatenation: {
+      auto* c = static_cast<Concatenation*>(e);
+      for (auto i = c->begin_exprs(), ie = c->end_exprs(); i != ie; ++i) {
+        pure = scan(*i, stmt, &below, reads) && pure;
+      }
+      break;
+    }
+    case Node::Tag::multiple_concatenation: {
+      auto* mc = static_cast<MultipleConcatenation*>(e);
+      pure = scan(mc->get_expr(), stmt, &below, reads) && pure;
+      pure = scan(mc->get_concat(), stmt, &below, reads) && pure;
+      break;
+    }
+    case Node::Tag::unary_expression: {
+      auto* ue = static_cast<UnaryExpression*>(e);
+      pure = scan(ue->get_lhs(), stmt, &below, reads) && pure;
+      break;
+    }
+    case Node::Tag::range_expression: {
+      auto* re = static_cast<RangeExpression*>(e);
+      pure = scan(re->get_upper(), stmt, &below, reads) && pure;
+      pure = scan(re->get_lower(), stmt, &below, reads) && pure;
+      candidate = false;
+      break;
+    }
+    case Node::Tag::identifier: {
+      auto* id = static_cast<Identifier*>(e);
+      for (auto i = id->begin_dim(), ie = id->end_dim(); i != ie; ++i) {
+        pure = scan(*i, stmt, &below, reads) && pure;
+      }
+      const auto* r = Resolve().get_resolution(id);
+      if (r == nullptr) {
+        pure = false;
+        break;
+      }
+      reads->insert(r);
+      // Plain variable references are as cheap as the temporary would be,
+      // and references to entire arrays can't be stored in one.
+      candidate = !id->empty_dim() && (id->size_dim() >= Evaluate().get_arity(r).size());
+      break;
+    }
+    case Node::Tag::number:
+      candidate = false;
+      break;
+    default:
+      pure = false;
+      break;
+  }
+
+  // Anything which is impure or constant stays where it is. So do signed
+  // and real-valued expressions, whose operands can be reinterpreted by the
+  // context they appear in. Their subexpressions can still be shared.
+  candidate = candidate && pure && !reads->empty() && (Evaluate().get_type(e) == Bits::Type::UNSIGNED);
+  if (!candidate) {
+    tops->insert(tops->end(), below.begin(), below.end());
+    return pure;
+  }
+
+  stringstream ss;
+  ss << e;
+  const auto w = Evaluate().get_width(e);
+  ss << "$" << w;
+  const auto key = ss.str();
+
+  auto itr = live_.find(key);
+  if (itr == live_.end()) {
+    Group g;
+    g.key = key;
+    g.width = w;
+    g.hoist = stmt;
+    g.def = nullptr;
+    itr = live_.insert(make_pair(key, groups_.size())).first;
+    groups_.push_back(g);
+  }
+  auto& g = groups_[itr->second];
+  g.reads.insert(reads->begin(), reads->end());
+  g.occs.push_back(occs_.size());
+
+  Occurrence o;
+  o.expr = e;
+  o.group = itr->second;
+  o.stmt = stmt;
+  o.children = below;
+  o.dead = false;
+  tops->push_back(occs_.size());
+  occs_.push_back(o);
+
+  return true;
+}
+
+void CommonSubexpressionEliminate::kill(const Identifier* r) {
+  for (auto i = live_.begin(); i != live_.end(); ) {
+    const auto& reads = groups_[i->second].reads;
+    if (reads.find(r) != reads.end()) {
+      i = live_.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+bool CommonSubexpressionEliminate::select(bool net) {
+  // Larger expressions contain smaller ones, so consider them first. Once a
+  // group is selected, everything inside of its other occurrences
+  // disappears along with them.
+  vector<size_t> order;
+  for (size_t i = 0, ie = groups_.size(); i < ie; ++i) {
+    order.push_back(i);
+  }
+  stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    return groups_[a].key.length() > groups_[b].key.length();
+  });
+
+  auto res = false;
+  for (auto i : order) {
+    auto& g = groups_[i];
+    vector<size_t> live;
+    for (auto o : g.occs) {
+      if (!occs_[o].dead) {
+        live.push_back(o);
+      }
+    }
+    if (live.size() < 2) {
+      continue;
+    }
+
+    g.temp = "__cse_" + to_string(next_id_++);
+    g.hoist = occs_[live[0]].stmt;
+    for (auto o : live) {
+      replace_[occs_[o].expr] = i;
+    }
+    for (size_t j = 1, je = live.size(); j < je; ++j) {
+      vector<size_t> work = occs_[live[j]].children;
+      while (!work.empty()) {
+        auto& c = occs_[work.back()];
+        work.pop_back();
+        c.dead = true;
+        work.insert(work.end(), c.children.begin(), c.children.end());
+      }
+    }
+
+    auto* id = new Identifier(g.temp);
+    auto* dim = new RangeExpression(g.width);
+    if (net) {
+      decls_.push_back(new NetDeclaration(new Attributes(), id, Declaration::Type::UNSIGNED, dim));
+    } else {
+      decls_.push_back(new RegDeclaration(new Attributes(), id, Declaration::Type::UNSIGNED, dim, nullptr));
+    }
+    res = true;
+  }
+  return res;
+}
+
+void CommonSubexpressionEliminate::reset() {
+  groups_.clear();
+  occs_.clear();
+  live_.clear();
+  replace_.clear();
+  defined_.clear();
+}
+
+} // namespace cascade
@@ -0,0 +1,133 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_TRANSFORM_COMMON_SUBEXPRESSION_ELIMINATE_H
+#define CASCADE_SRC_VERILOG_TRANSFORM_COMMON_SUBEXPRESSION_ELIMINATE_H
+
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "verilog/ast/ast_fwd.h"
+#include "verilog/ast/visitors/rewriter.h"
+
+namespace cascade {
+
+// This pass replaces repeated pure subexpressions with a single temporary
+// variable. Subexpressions are shared between continuous assignments by
+// introducing a fresh wire, and between runs of consecutive assignments
+// inside of always blocks by introducing a fresh reg which is assigned
+// immediately before its first use. Two subexpressions are only considered
+// equivalent if they print identically, are unsigned and have the same width
+// in their respective contexts, and (inside of always blocks) none of the
+// variables that they read are assigned in between them.
+
+class CommonSubexpressionEliminate : public Rewriter {
+  public:
+    CommonSubexpressionEliminate();
+    ~CommonSubexpressionEliminate() override = default;
+
+    void run(ModuleDeclaration* md);
+
+  private:
+    // A set of equivalent subexpressions. Hoist is the index of the statement
+    // that contains the first occurrence which will be replaced.
+    struct Group {
+      std::string key;
+      size_t width;
+      std::unordered_set<const Identifier*> reads;
+      std::vector<size_t> occs;
+      size_t hoist;
+      std::string temp;
+      Expression* def;
+    };
+    // An occurrence of a group member. Children are the occurrences of other
+    // groups which appear directly beneath this one.
+    struct Occurrence {
+      Expression* expr;
+      size_t group;
+      size_t stmt;
+      std::vector<size_t> children;
+      bool dead;
+    };
+    // Replaces the members of selected groups with their temporaries
+    struct Replace : Rewriter {
+      explicit Replace(CommonSubexpressionEliminate* cse);
+      ~Replace() override = default;
+
+      Expression* rewrite(BinaryExpression* be) override;
+      Expression* rewrite(ConditionalExpression* ce) override;
+      Expression* rewrite(Concatenation* c) override;
+      Expression* rewrite(Identifier* id) override;
+      Expression* rewrite(MultipleConcatenation* mc) override;
+      Expression* rewrite(UnaryExpression* ue) override;
+
+      Expression* replace(Expression* e);
+
+      CommonSubexpressionEliminate* cse_;
+    };
+
+    // Rewriter Interface:
+    ModuleItem* rewrite(AlwaysConstruct* ac) override;
+    ModuleItem* rewrite(InitialConstruct* ic) override;
+    Statement* rewrite(SeqBlock* sb) override;
+
+    // Module-wide state:
+    std::vector<Declaration*> decls_;
+    std::vector<ModuleItem*> cas_;
+    size_t next_id_;
+
+    // Per-region state:
+    std::vector<Group> groups_;
+    std::vector<Occurrence> occs_;
+    std::unordered_map<std::string, size_t> live_;
+    std::unordered_map<const Expression*, size_t> replace_;
+    std::vector<size_t> defined_;
+
+    // Region Helpers:
+    //
+    // Records the candidate subexpressions in e, which is part of the
+    // stmt'th statement in the current region. Returns false if e is impure.
+    // Appends the top-most occurrences in e to tops and the variables that e
+    // reads to reads.
+    bool scan(Expression* e, size_t stmt, std::vector<size_t>* tops, std::unordered_set<const Identifier*>* reads);
+    // Ends the lifetime of every group which reads r
+    void kill(const Identifier* r);
+    // Chooses which groups to replace, largest first, and returns true if
+    // there were any. Temporaries are declared as wires if net is true.
+    bool select(bool net);
+    // Clears per-region state
+    void reset();
+};
+
+} // namespace cascade
+
+#endif
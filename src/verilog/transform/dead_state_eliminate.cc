@@ -0,0 +1,458 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/transform/dead_state_eliminate.h"
+
+#include "verilog/analyze/module_info.h"
+#include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
+
+using namespace std;
+
+namespace cascade {
+
+DeadStateEliminate::DeadStateEliminate() : Rewriter() { 
+  save_ = false;
+}
+
+void DeadStateEliminate::run(ModuleDeclaration* md) {
+  // Build the dependence graph. Nothing to do if this module saves its state.
+  Index idx(this);
+  md->accept_items(&idx);
+  if (save_) {
+    return;
+  }
+
+  // Mark observable variables and delete everything else 
+  propagate();
+  md->accept_items(this);
+  for (auto i = md->begin_items(); i != md->end_items(); ) {
+    if ((*i)->is(Node::Tag::continuous_assign) && !is_live(static_cast<ContinuousAssign*>(*i))) {
+      i = md->purge_items(i);
+    } else {
+      ++i;
+    }
+  }
+
+  // Invalidate cached state. We haven't deleted any declarations, so there's
+  // no need to invalidate the scope tree.
+  Resolve().invalidate(md);
+  ModuleInfo(md).invalidate();
+}
+
+DeadStateEliminate::Index::Index(DeadStateEliminate* dse) : Visitor() {
+  dse_ = dse;
+  ctrl_ = -1;
+}
+
+void DeadStateEliminate::Index::visit(const Attributes* as) {
+  // Does nothing. 
+  (void) as;
+}
+
+void DeadStateEliminate::Index::visit(const ContinuousAssign* ca) {
+  assign(ca);
+}
+
+void DeadStateEliminate::Index::visit(const PortDeclaration* pd) {
+  // Anything other than an input is visible to the rest of the program
+  if (pd->get_type() != PortDeclaration::Type::INPUT) {
+    Use u;
+    u.reads.push_back(pd->get_decl()->get_id());
+    u.ctrl = -1;
+    dse_->seeds_.push_back(push(u));
+  }
+  pd->accept_decl(this);
+}
+
+void DeadStateEliminate::Index::visit(const RegDeclaration* rd) {
+  // Memories which are written back to their image are visible outside of
+  // the program
+  if (rd->get_attrs()->find("__write_back")) {
+    Use u;
+    u.reads.push_back(rd->get_id());
+    u.ctrl = -1;
+    dse_->seeds_.push_back(push(u));
+  }
+  if (rd->is_null_val()) {
+    return;
+  }
+  // Streams are always observable. Other initial values are only needed if
+  // the variable they initialize is.
+  Use u;
+  u.ctrl = -1;
+  Reads r(&u.reads);
+  rd->accept_val(&r);
+  if (rd->get_val()->is(Node::Tag::fopen_expression)) {
+    u.reads.push_back(rd->get_id());
+    dse_->seeds_.push_back(push(u));
+  } else {
+    dse_->writers_[rd->get_id()].push_back(push(u));
+  }
+}
+
+void DeadStateEliminate::Index::visit(const BlockingAssign* ba) {
+  assign(ba);
+}
+
+void DeadStateEliminate::Index::visit(const NonblockingAssign* na) {
+  assign(na);
+}
+
+void DeadStateEliminate::Index::visit(const CaseStatement* cs) {
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  cs->accept_cond(&r);
+  for (auto i = cs->begin_items(), ie = cs->end_items(); i != ie; ++i) {
+    (*i)->accept_exprs(&r);
+  }
+
+  const auto ctrl = ctrl_;
+  ctrl_ = push(u);
+  for (auto i = cs->begin_items(), ie = cs->end_items(); i != ie; ++i) {
+    (*i)->accept_stmt(this);
+  }
+  ctrl_ = ctrl;
+}
+
+void DeadStateEliminate::Index::visit(const ConditionalStatement* cs) {
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  cs->accept_if(&r);
+
+  const auto ctrl = ctrl_;
+  ctrl_ = push(u);
+  cs->accept_then(this);
+  cs->accept_else(this);
+  ctrl_ = ctrl;
+}
+
+void DeadStateEliminate::Index::visit(const ForStatement* fs) {
+  // The initial assignment is unconditional. The update only happens as long
+  // as the loop condition holds.
+  fs->accept_init(this);
+
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  fs->accept_cond(&r);
+
+  const auto ctrl = ctrl_;
+  ctrl_ = push(u);
+  fs->accept_update(this);
+  fs->accept_stmt(this);
+  ctrl_ = ctrl;
+}
+
+void DeadStateEliminate::Index::visit(const RepeatStatement* rs) {
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  rs->accept_cond(&r);
+
+  const auto ctrl = ctrl_;
+  ctrl_ = push(u);
+  rs->accept_stmt(this);
+  ctrl_ = ctrl;
+}
+
+void DeadStateEliminate::Index::visit(const WhileStatement* ws) {
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  ws->accept_cond(&r);
+
+  const auto ctrl = ctrl_;
+  ctrl_ = push(u);
+  ws->accept_stmt(this);
+  ctrl_ = ctrl;
+}
+
+void DeadStateEliminate::Index::visit(const TimingControlStatement* tcs) {
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  tcs->accept_ctrl(&r);
+
+  const auto ctrl = ctrl_;
+  ctrl_ = push(u);
+  tcs->accept_stmt(this);
+  ctrl_ = ctrl;
+}
+
+void DeadStateEliminate::Index::visit(const DebugStatement* ds) {
+  effect(ds);
+}
+
+void DeadStateEliminate::Index::visit(const FflushStatement* fs) {
+  effect(fs);
+}
+
+void DeadStateEliminate::Index::visit(const FinishStatement* fs) {
+  effect(fs);
+}
+
+void DeadStateEliminate::Index::visit(const FseekStatement* fs) {
+  effect(fs);
+}
+
+void DeadStateEliminate::Index::visit(const GetStatement* gs) {
+  effect(gs);
+}
+
+void DeadStateEliminate::Index::visit(const PutStatement* ps) {
+  effect(ps);
+}
+
+void DeadStateEliminate::Index::visit(const RestartStatement* rs) {
+  effect(rs);
+}
+
+void DeadStateEliminate::Index::visit(const RetargetStatement* rs) {
+  effect(rs);
+}
+
+void DeadStateEliminate::Index::visit(const SaveStatement* ss) {
+  dse_->save_ = true;
+  effect(ss);
+}
+
+void DeadStateEliminate::Index::visit(const VariableAssign* va) {
+  assign(va);
+}
+
+template <typename T>
+void DeadStateEliminate::Index::assign(const T* t) {
+  // The right hand side and any subscripts on the left hand side are needed
+  // if any of the variables on the left hand side are observable.
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  t->accept_rhs(&r);
+  for (auto i = t->begin_lhs(), ie = t->end_lhs(); i != ie; ++i) {
+    (*i)->accept_dim(&r);
+  }
+  const auto idx = push(u);
+  for (auto i = t->begin_lhs(), ie = t->end_lhs(); i != ie; ++i) {
+    const auto* d = Resolve().get_resolution(*i);
+    if (d != nullptr) {
+      dse_->writers_[d].push_back(idx);
+    }
+  }
+}
+
+void DeadStateEliminate::Index::effect(const Node* n) {
+  Use u;
+  u.ctrl = ctrl_;
+  Reads r(&u.reads);
+  n->accept(&r);
+  dse_->seeds_.push_back(push(u));
+}
+
+size_t DeadStateEliminate::Index::push(const Use& u) {
+  dse_->uses_.push_back(u);
+  return dse_->uses_.size() - 1;
+}
+
+DeadStateEliminate::Reads::Reads(vector<const Identifier*>* res) : Visitor() {
+  res_ = res;
+}
+
+void DeadStateEliminate::Reads::visit(const Attributes* as) {
+  // Does nothing. 
+  (void) as;
+}
+
+void DeadStateEliminate::Reads::visit(const Identifier* id) {
+  Visitor::visit(id);
+  const auto* r = Resolve().get_resolution(id);
+  if (r != nullptr) {
+    res_->push_back(r);
+  }
+}
+
+DeadStateEliminate::Live::Live(const DeadStateEliminate* dse) : Visitor() {
+  dse_ = dse;
+}
+
+bool DeadStateEliminate::Live::check(const Node* n) {
+  res_ = false;
+  n->accept(this);
+  return res_;
+}
+
+void DeadStateEliminate::Live::visit(const Attributes* as) {
+  // Does nothing. 
+  (void) as;
+}
+
+void DeadStateEliminate::Live::visit(const BlockingAssign* ba) {
+  res_ = res_ || dse_->is_live(ba);
+}
+
+void DeadStateEliminate::Live::visit(const NonblockingAssign* na) {
+  res_ = res_ || dse_->is_live(na);
+}
+
+void DeadStateEliminate::Live::visit(const VariableAssign* va) {
+  res_ = res_ || dse_->is_live(va);
+}
+
+void DeadStateEliminate::Live::visit(const DebugStatement* ds) {
+  (void) ds;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const FflushStatement* fs) {
+  (void) fs;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const FinishStatement* fs) {
+  (void) fs;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const FseekStatement* fs) {
+  (void) fs;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const GetStatement* gs) {
+  (void) gs;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const PutStatement* ps) {
+  (void) ps;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const RestartStatement* rs) {
+  (void) rs;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const RetargetStatement* rs) {
+  (void) rs;
+  res_ = true;
+}
+
+void DeadStateEliminate::Live::visit(const SaveStatement* ss) {
+  (void) ss;
+  res_ = true;
+}
+
+Statement* DeadStateEliminate::rewrite(BlockingAssign* ba) {
+  return is_live(ba) ? ba : static_cast<Statement*>(new SeqBlock());
+}
+
+Statement* DeadStateEliminate::rewrite(NonblockingAssign* na) {
+  return is_live(na) ? na : static_cast<Statement*>(new SeqBlock());
+}
+
+Statement* DeadStateEliminate::rewrite(CaseStatement* cs) {
+  Rewriter::rewrite(cs);
+  return prune(cs);
+}
+
+Statement* DeadStateEliminate::rewrite(ConditionalStatement* cs) {
+  Rewriter::rewrite(cs);
+  return prune(cs);
+}
+
+Statement* DeadStateEliminate::rewrite(ForStatement* fs) {
+  Rewriter::rewrite(fs);
+  return prune(fs);
+}
+
+Statement* DeadStateEliminate::rewrite(RepeatStatement* rs) {
+  Rewriter::rewrite(rs);
+  return prune(rs);
+}
+
+Statement* DeadStateEliminate::rewrite(WhileStatement* ws) {
+  Rewriter::rewrite(ws);
+  return prune(ws);
+}
+
+Statement* DeadStateEliminate::rewrite(TimingControlStatement* tcs) {
+  Rewriter::rewrite(tcs);
+  return prune(tcs);
+}
+
+void DeadStateEliminate::propagate() {
+  // Once a use is observable, so is everything that it reads and the control
+  // flow which guards it. Once a variable is observable, so is every use
+  // which writes it.
+  vector<bool> done(uses_.size(), false);
+  auto work = seeds_;
+  while (!work.empty()) {
+    const auto u = work.back();
+    work.pop_back();
+    if (done[u]) {
+      continue;
+    }
+    done[u] = true;
+
+    for (const auto* r : uses_[u].reads) {
+      if (!live_.insert(r).second) {
+        continue;
+      }
+      const auto itr = writers_.find(r);
+      if (itr != writers_.end()) {
+        work.insert(work.end(), itr->second.begin(), itr->second.end());
+      }
+    }
+    if (uses_[u].ctrl != -1) {
+      work.push_back(uses_[u].ctrl);
+    }
+  }
+}
+
+template <typename T>
+bool DeadStateEliminate::is_live(const T* t) const {
+  for (auto i = t->begin_lhs(), ie = t->end_lhs(); i != ie; ++i) {
+    // Err on the side of caution for anything we can't resolve
+    const auto* d = Resolve().get_resolution(*i);
+    if ((d == nullptr) || (live_.find(d) != live_.end())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Statement* DeadStateEliminate::prune(Statement* s) {
+  return Live(this).check(s) ? s : new SeqBlock();
+}
+
+} // namespace cascade
@@ -0,0 +1,175 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_TRANSFORM_DEAD_STATE_ELIMINATE_H
+#define CASCADE_SRC_VERILOG_TRANSFORM_DEAD_STATE_ELIMINATE_H
+
+#include <stddef.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "verilog/ast/visitors/rewriter.h"
+#include "verilog/ast/visitors/visitor.h"
+
+namespace cascade {
+
+// This pass removes logic which cannot affect observable behavior. A variable
+// is observable if it is an output port, a stream, a memory which is written
+// back to its image, or if its value can reach a system task, either as an
+// argument or through the control flow which guards it. Assignments to unobservable variables are deleted along with any
+// control flow that is left without an effect. The declarations which this
+// leaves behind are cleaned up by DeadCodeEliminate.
+//
+// Once a module has been inlined into the root, its isolated source is the
+// whole of the program's logic, so this analysis subsumes the program. Output
+// ports are the only values which can be seen by other engines, and are
+// always treated as observable. Modules containing a $save are left alone,
+// since every variable they declare is observable through the saved state.
+//
+// Note that variables removed by this pass are no longer simulated. If code
+// which observes them is eval'ed later, they restart from their initial
+// values.
+
+class DeadStateEliminate : public Rewriter {
+  public:
+    DeadStateEliminate();
+    ~DeadStateEliminate() override = default;
+
+    void run(ModuleDeclaration* md);
+
+  private:
+    // A set of variables which becomes observable along with this use, and the
+    // index of the control flow which guards it, or -1 for none. 
+    struct Use {
+      std::vector<const Identifier*> reads;
+      int ctrl;
+    };
+
+    // Dependence Graph:
+    std::vector<Use> uses_;
+    std::unordered_map<const Identifier*, std::vector<size_t>> writers_;
+    std::vector<size_t> seeds_;
+    bool save_;
+    // Observable Variables:
+    std::unordered_set<const Identifier*> live_;
+
+    // Builds the dependence graph
+    struct Index : Visitor {
+      explicit Index(DeadStateEliminate* dse);
+      ~Index() override = default;
+
+      void visit(const Attributes* as) override;
+      void visit(const ContinuousAssign* ca) override;
+      void visit(const PortDeclaration* pd) override;
+      void visit(const RegDeclaration* rd) override;
+      void visit(const BlockingAssign* ba) override;
+      void visit(const NonblockingAssign* na) override;
+      void visit(const CaseStatement* cs) override;
+      void visit(const ConditionalStatement* cs) override;
+      void visit(const ForStatement* fs) override;
+      void visit(const RepeatStatement* rs) override;
+      void visit(const WhileStatement* ws) override;
+      void visit(const TimingControlStatement* tcs) override;
+      void visit(const DebugStatement* ds) override;
+      void visit(const FflushStatement* fs) override;
+      void visit(const FinishStatement* fs) override;
+      void visit(const FseekStatement* fs) override;
+      void visit(const GetStatement* gs) override;
+      void visit(const PutStatement* ps) override;
+      void visit(const RestartStatement* rs) override;
+      void visit(const RetargetStatement* rs) override;
+      void visit(const SaveStatement* ss) override;
+      void visit(const VariableAssign* va) override;
+
+      template <typename T>
+      void assign(const T* t);
+      void effect(const Node* n);
+      size_t push(const Use& u);
+
+      DeadStateEliminate* dse_;
+      int ctrl_;
+    };
+    // Collects the variables which are read by a subtree
+    struct Reads : Visitor {
+      explicit Reads(std::vector<const Identifier*>* res);
+      ~Reads() override = default;
+
+      void visit(const Attributes* as) override;
+      void visit(const Identifier* id) override;
+
+      std::vector<const Identifier*>* res_;
+    };
+    // Returns true if a subtree contains a statement with an observable effect
+    struct Live : Visitor {
+      explicit Live(const DeadStateEliminate* dse);
+      ~Live() override = default;
+
+      bool check(const Node* n);
+
+      void visit(const Attributes* as) override;
+      void visit(const BlockingAssign* ba) override;
+      void visit(const NonblockingAssign* na) override;
+      void visit(const VariableAssign* va) override;
+      void visit(const DebugStatement* ds) override;
+      void visit(const FflushStatement* fs) override;
+      void visit(const FinishStatement* fs) override;
+      void visit(const FseekStatement* fs) override;
+      void visit(const GetStatement* gs) override;
+      void visit(const PutStatement* ps) override;
+      void visit(const RestartStatement* rs) override;
+      void visit(const RetargetStatement* rs) override;
+      void visit(const SaveStatement* ss) override;
+
+      const DeadStateEliminate* dse_;
+      bool res_;
+    };
+
+    // Rewriter Interface:
+    Statement* rewrite(BlockingAssign* ba) override;
+    Statement* rewrite(NonblockingAssign* na) override;
+    Statement* rewrite(CaseStatement* cs) override;
+    Statement* rewrite(ConditionalStatement* cs) override;
+    Statement* rewrite(ForStatement* fs) override;
+    Statement* rewrite(RepeatStatement* rs) override;
+    Statement* rewrite(WhileStatement* ws) override;
+    Statement* rewrite(TimingControlStatement* tcs) override;
+
+    // Marks everything which is reachable from the seeds as observable
+    void propagate();
+    // Returns true if any of the targets of an assignment are observable
+    template <typename T>
+    bool is_live(const T* t) const;
+    // Replaces s with an empty block if it no longer has any effect
+    Statement* prune(Statement* s);
+};
+
+} // namespace cascade
+
+#endif
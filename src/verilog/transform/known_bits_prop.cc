@@ -0,0 +1,945 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/transform/known_bits_prop.h"
+
+#include <algorithm>
+#include "verilog/analyze/evaluate.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
+
+using namespace std;
+
+namespace cascade {
+
+KnownBitsProp::KnownBitsProp() : Rewriter() { }
+
+void KnownBitsProp::run(ModuleDeclaration* md) {
+  md->accept_items(this);
+
+  // Invalidate cached state (we haven't added or deleted declarations, so
+  // there's no need to invalidate the scope tree).
+  Resolve().invalidate(md);
+  ModuleInfo(md).invalidate();
+}
+
+Attributes* KnownBitsProp::rewrite(Attributes* as) {
+  // Does nothing. Attributes contain identifiers which don't resolve.
+  return as;
+}
+
+Expression* KnownBitsProp::rewrite(BinaryExpression* be) {
+  Rewriter::rewrite(be);
+  narrow_compare(be);
+  return fold(be);
+}
+
+Expression* KnownBitsProp::rewrite(ConditionalExpression* ce) {
+  Rewriter::rewrite(ce);
+  return fold(ce);
+}
+
+Expression* KnownBitsProp::rewrite(Concatenation* c) {
+  Rewriter::rewrite(c);
+  return fold(c);
+}
+
+Expression* KnownBitsProp::rewrite(FopenExpression* fe) {
+  // Does nothing. $fopen() expressions must be preserved through to 
+  // target-specific compilation.
+  return fe;
+}
+
+Expression* KnownBitsProp::rewrite(MultipleConcatenation* mc) {
+  Rewriter::rewrite(mc);
+  return fold(mc);
+}
+
+Expression* KnownBitsProp::rewrite(UnaryExpression* ue) {
+  Rewriter::rewrite(ue);
+  return fold(ue);
+}
+
+ModuleItem* KnownBitsProp::rewrite(ContinuousAssign* ca) {
+  Rewriter::rewrite(ca);
+  if (ca->size_lhs() == 1) {
+    auto* res = narrow(ca->front_lhs(), ca->get_rhs());
+    if (res != ca->get_rhs()) {
+      ca->replace_rhs(res);
+      Evaluate().invalidate(res);
+    }
+  }
+  return ca;
+}
+
+ModuleItem* KnownBitsProp::rewrite(GenvarDeclaration* gd) {
+  // Does nothing. Declarations are only ever evaluated once.
+  return gd;
+}
+
+ModuleItem* KnownBitsProp::rewrite(LocalparamDeclaration* ld) {
+  // Does nothing. Declarations are only ever evaluated once.
+  return ld;
+}
+
+ModuleItem* KnownBitsProp::rewrite(NetDeclaration* nd) {
+  // Does nothing. Declarations are only ever evaluated once.
+  return nd;
+}
+
+ModuleItem* KnownBitsProp::rewrite(ParameterDeclaration* pd) {
+  // Does nothing. Declarations are only ever evaluated once.
+  return pd;
+}
+
+ModuleItem* KnownBitsProp::rewrite(RegDeclaration* rd) {
+  // Does nothing. Declarations are only ever evaluated once.
+  return rd;
+}
+
+Statement* KnownBitsProp::rewrite(BlockingAssign* ba) {
+  Rewriter::rewrite(ba);
+  if (ba->size_lhs() == 1) {
+    auto* res = narrow(ba->front_lhs(), ba->get_rhs());
+    if (res != ba->get_rhs()) {
+      ba->replace_rhs(res);
+      Evaluate().invalidate(res);
+    }
+  }
+  return ba;
+}
+
+Statement* KnownBitsProp::rewrite(NonblockingAssign* na) {
+  Rewriter::rewrite(na);
+  if (na->size_lhs() == 1) {
+    auto* res = narrow(na->front_lhs(), na->get_rhs());
+    if (res != na->get_rhs()) {
+      na->replace_rhs(res);
+      Evaluate().invalidate(res);
+    }
+  }
+  return na;
+}
+
+Statement* KnownBitsProp::rewrite(DebugStatement* ds) {
+  // Don't descend past here
+  return ds;
+}
+
+KnownBitsProp::Known KnownBitsProp::known(const Expression* e) const {
+  const auto w = Evaluate().get_width(e);
+  Known res = {Bits(w, 0), Bits(w, 0)};
+  if (Evaluate().get_type(e) != Bits::Type::UNSIGNED) {
+    return res;
+  }
+
+  if (e->is(Node::Tag::binary_expression)) {
+    return known(static_cast<const BinaryExpression*>(e), w);
+  } 
+  if (e->is(Node::Tag::unary_expression)) {
+    return known(static_cast<const UnaryExpression*>(e), w);
+  }
+  if (e->is(Node::Tag::conditional_expression)) {
+    const auto* ce = static_cast<const ConditionalExpression*>(e);
+    const auto t = truth(known(ce->get_cond()));
+    const auto l = (t == 0) ? res : known(ce->get_lhs());
+    const auto r = (t == 1) ? res : known(ce->get_rhs());
+    if ((l.mask.size() != w) || (r.mask.size() != w)) {
+      return res;
+    }
+    for (size_t i = 0; i < w; ++i) {
+      if (t == 1) {
+        res.mask.set(i, l.mask.get(i));
+        res.val.set(i, l.val.get(i));
+      } else if (t == 0) {
+        res.mask.set(i, r.mask.get(i));
+        res.val.set(i, r.val.get(i));
+      } else if (l.mask.get(i) && r.mask.get(i) && (l.val.get(i) == r.val.get(i))) {
+        res.mask.set(i, true);
+        res.val.set(i, l.val.get(i));
+      }
+    }
+    return res;
+  }
+  if (e->is(Node::Tag::concatenation)) {
+    // Concatenations are unsigned, so anything above the last element is zero
+    const auto* c = static_cast<const Concatenation*>(e);
+    size_t idx = 0;
+    for (size_t i = c->size_exprs(); i > 0; --i) {
+      const auto k = known(c->get_exprs(i-1));
+      for (size_t j = 0, je = k.mask.size(); (j < je) && (idx < w); ++j, ++idx) {
+        res.mask.set(idx, k.mask.get(j));
+        res.val.set(idx, k.val.get(j));
+      }
+    }
+    for (; idx < w; ++idx) {
+      res.mask.set(idx, true);
+    }
+    return res;
+  }
+  if (e->is(Node::Tag::multiple_concatenation)) {
+    const auto* mc = static_cast<const MultipleConcatenation*>(e);
+    const auto n = Evaluate().get_value(mc->get_expr()).to_uint();
+    const auto k = known(mc->get_concat());
+    size_t idx = 0;
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0, je = k.mask.size(); (j < je) && (idx < w); ++j, ++idx) {
+        res.mask.set(idx, k.mask.get(j));
+        res.val.set(idx, k.val.get(j));
+      }
+    }
+    for (; idx < w; ++idx) {
+      res.mask.set(idx, true);
+    }
+    return res;
+  }
+  if (e->is(Node::Tag::identifier)) {
+    // Nothing is known about the value of a variable, but unsigned variables
+    // and slices are zero-extended to their context-determined width.
+    const auto* id = static_cast<const Identifier*>(e);
+    const auto* r = Resolve().get_resolution(id);
+    if (r == nullptr) {
+      return res;
+    }
+    size_t sw = w;
+    if (id->size_dim() == r->size_dim()) {
+      sw = Evaluate().get_width(r);
+    } else if (id->back_dim()->is(Node::Tag::range_expression)) {
+      const auto* re = static_cast<const RangeExpression*>(id->back_dim());
+      const auto lower = Evaluate().get_value(re->get_lower()).to_uint();
+      if (re->get_type() == RangeExpression::Type::CONSTANT) {
+        const auto upper = Evaluate().get_value(re->get_upper()).to_uint();
+        sw = (upper-lower)+1;
+      } else {
+        sw = lower;
+      }
+    } else {
+      sw = 1;
+    }
+    for (size_t i = sw; i < w; ++i) {
+      res.mask.set(i, true);
+    }
+    return res;
+  }
+  if (e->is(Node::Tag::number)) {
+    res.val = Evaluate().get_value(e);
+    res.mask.bitwise_not(res.mask);
+    return res;
+  }
+  return res;
+}
+
+KnownBitsProp::Known KnownBitsProp::known_unsigned(const Expression* e) const {
+  if (!e->is(Node::Tag::number) || (Evaluate().get_type(e) == Bits::Type::REAL)) {
+    return known(e);
+  }
+  Known res = {Bits(Evaluate().get_width(e), 0), Evaluate().get_value(e)};
+  res.mask.bitwise_not(res.mask);
+  res.val.reinterpret_type(Bits::Type::UNSIGNED);
+  return res;
+}
+
+KnownBitsProp::Known KnownBitsProp::known(const BinaryExpression* be, size_t w) const {
+  Known res = {Bits(w, 0), Bits(w, 0)};
+
+  switch (be->get_op()) {
+    case BinaryExpression::Op::AMP:
+    case BinaryExpression::Op::PIPE:
+    case BinaryExpression::Op::CARAT:
+    case BinaryExpression::Op::TCARAT: {
+      const auto l = known(be->get_lhs());
+      const auto r = known(be->get_rhs());
+      if ((l.mask.size() != w) || (r.mask.size() != w)) {
+        break;
+      }
+      for (size_t i = 0; i < w; ++i) {
+        const auto lk = l.mask.get(i);
+        const auto rk = r.mask.get(i);
+        const auto lv = l.val.get(i);
+        const auto rv = r.val.get(i);
+        switch (be->get_op()) {
+          case BinaryExpression::Op::AMP:
+            res.mask.set(i, (lk && rk) || (lk && !lv) || (rk && !rv));
+            res.val.set(i, lk && rk && lv && rv);
+            break;
+          case BinaryExpression::Op::PIPE:
+            res.mask.set(i, (lk && rk) || (lk && lv) || (rk && rv));
+            res.val.set(i, (lk && lv) || (rk && rv));
+            break;
+          case BinaryExpression::Op::CARAT:
+            res.mask.set(i, lk && rk);
+            res.val.set(i, lk && rk && (lv != rv));
+            break;
+          default:
+            res.mask.set(i, lk && rk);
+            res.val.set(i, lk && rk && (lv == rv));
+            break;
+        }
+      }
+      break;
+    }
+
+    case BinaryExpression::Op::PLUS:
+    case BinaryExpression::Op::MINUS:
+    case BinaryExpression::Op::TIMES: {
+      // The low-order bits of these operators only depend on the low-order
+      // bits of their operands.
+      const auto l = known(be->get_lhs());
+      const auto r = known(be->get_rhs());
+      if ((l.mask.size() != w) || (r.mask.size() != w)) {
+        break;
+      }
+      Bits val(w, 0);
+      if (be->get_op() == BinaryExpression::Op::PLUS) {
+        val.arithmetic_plus(l.val, r.val);
+      } else if (be->get_op() == BinaryExpression::Op::MINUS) {
+        val.arithmetic_minus(l.val, r.val);
+      } else {
+        val.arithmetic_multiply(l.val, r.val);
+      }
+      for (size_t i = 0, ie = min(known_low(l), known_low(r)); i < ie; ++i) {
+        res.mask.set(i, true);
+        res.val.set(i, val.get(i));
+      }
+      // Sums and products of small values are small as well. Products of
+      // even values are even as well.
+      size_t hi = w;
+      if (be->get_op() == BinaryExpression::Op::PLUS) {
+        hi = max(w-zeros_high(l), w-zeros_high(r)) + 1;
+      } else if (be->get_op() == BinaryExpression::Op::TIMES) {
+        hi = (w-zeros_high(l)) + (w-zeros_high(r));
+        for (size_t i = 0, ie = min(w, zeros_low(l)+zeros_low(r)); i < ie; ++i) {
+          res.mask.set(i, true);
+          res.val.set(i, false);
+        }
+      }
+      for (size_t i = hi; i < w; ++i) {
+        res.mask.set(i, true);
+        res.val.set(i, false);
+      }
+      break;
+    }
+
+    case BinaryExpression::Op::LLT:
+    case BinaryExpression::Op::LLLT:
+    case BinaryExpression::Op::GGT: {
+      const auto l = known(be->get_lhs());
+      const auto r = known_unsigned(be->get_rhs());
+      if ((l.mask.size() != w) || (known_low(r) != r.mask.size())) {
+        break;
+      }
+      size_t s = 0;
+      for (size_t i = 0, ie = r.val.size(); i < ie; ++i) {
+        if (r.val.get(i)) {
+          s = (i < 8*sizeof(size_t)-1) ? (s | (static_cast<size_t>(1) << i)) : w;
+        }
+      }
+      s = min(s, w);
+      const auto left = be->get_op() != BinaryExpression::Op::GGT;
+      for (size_t i = 0; i < w; ++i) {
+        if (left ? (i < s) : (i+s >= w)) {
+          res.mask.set(i, true);
+        } else {
+          const auto j = left ? (i-s) : (i+s);
+          res.mask.set(i, l.mask.get(j));
+          res.val.set(i, l.val.get(j));
+        }
+      }
+      break;
+    }
+
+    case BinaryExpression::Op::EEEQ:
+    case BinaryExpression::Op::EEQ:
+    case BinaryExpression::Op::BEEQ:
+    case BinaryExpression::Op::BEQ: {
+      const auto l = known(be->get_lhs());
+      const auto r = known(be->get_rhs());
+      if (l.mask.size() == r.mask.size()) {
+        auto all = true;
+        auto diff = false;
+        for (size_t i = 0, ie = l.mask.size(); i < ie; ++i) {
+          if (l.mask.get(i) && r.mask.get(i)) {
+            diff = diff || (l.val.get(i) != r.val.get(i));
+          } else {
+            all = false;
+          }
+        }
+        const auto eq = (be->get_op() == BinaryExpression::Op::EEEQ) || (be->get_op() == BinaryExpression::Op::EEQ);
+        res.mask.set(0, all || diff);
+        res.val.set(0, (all || diff) && (eq != diff));
+      }
+      for (size_t i = 1; i < w; ++i) {
+        res.mask.set(i, true);
+      }
+      break;
+    }
+
+    case BinaryExpression::Op::AAMP:
+    case BinaryExpression::Op::PPIPE: {
+      const auto l = truth(known(be->get_lhs()));
+      const auto r = truth(known(be->get_rhs()));
+      if (be->get_op() == BinaryExpression::Op::AAMP) {
+        res.mask.set(0, (l == 0) || (r == 0) || ((l == 1) && (r == 1)));
+        res.val.set(0, (l == 1) && (r == 1));
+      } else {
+        res.mask.set(0, (l == 1) || (r == 1) || ((l == 0) && (r == 0)));
+        res.val.set(0, (l == 1) || (r == 1));
+      }
+      for (size_t i = 1; i < w; ++i) {
+        res.mask.set(i, true);
+      }
+      break;
+    }
+
+    case BinaryExpression::Op::GT:
+    case BinaryExpression::Op::GEQ:
+    case BinaryExpression::Op::LT:
+    case BinaryExpression::Op::LEQ:
+      // Comparisons only ever produce a single bit
+      for (size_t i = 1; i < w; ++i) {
+        res.mask.set(i, true);
+      }
+      break;
+
+    default:
+      break;
+  }
+  return res;
+}
+
+KnownBitsProp::Known KnownBitsProp::known(const UnaryExpression* ue, size_t w) const {
+  Known res = {Bits(w, 0), Bits(w, 0)};
+  const auto l = known(ue->get_lhs());
+
+  switch (ue->get_op()) {
+    case UnaryExpression::Op::PLUS:
+      if (l.mask.size() == w) {
+        res = l;
+      }
+      break;
+    case UnaryExpression::Op::MINUS:
+      if (l.mask.size() == w) {
+        Bits val(w, 0);
+        val.arithmetic_minus(l.val);
+        for (size_t i = 0, ie = known_low(l); i < ie; ++i) {
+          res.mask.set(i, true);
+          res.val.set(i, val.get(i));
+        }
+      }
+      break;
+    case UnaryExpression::Op::TILDE:
+      if (l.mask.size() == w) {
+        res.mask = l.mask;
+        res.val.bitwise_not(l.val);
+        res.val.bitwise_and(res.val, res.mask);
+      }
+      break;
+
+    default: {
+      // Reductions only ever produce a single bit
+      auto all = true;
+      auto zero = false;
+      auto one = false;
+      auto parity = false;
+      for (size_t i = 0, ie = l.mask.size(); i < ie; ++i) {
+        if (l.mask.get(i)) {
+          zero = zero || !l.val.get(i);
+          one = one || l.val.get(i);
+          parity = parity != l.val.get(i);
+        } else {
+          all = false;
+        }
+      }
+      switch (ue->get_op()) {
+        case UnaryExpression::Op::AMP:
+        case UnaryExpression::Op::TAMP:
+          res.mask.set(0, all || zero);
+          res.val.set(0, (all || zero) && (zero != (ue->get_op() == UnaryExpression::Op::AMP)));
+          break;
+        case UnaryExpression::Op::PIPE:
+        case UnaryExpression::Op::TPIPE:
+        case UnaryExpression::Op::BANG:
+          res.mask.set(0, all || one);
+          res.val.set(0, (all || one) && (one == (ue->get_op() == UnaryExpression::Op::PIPE)));
+          break;
+        default:
+          res.mask.set(0, all);
+          res.val.set(0, all && (parity == (ue->get_op() == UnaryExpression::Op::CARAT)));
+          break;
+      }
+      for (size_t i = 1; i < w; ++i) {
+        res.mask.set(i, true);
+      }
+      break;
+    }
+  }
+  return res;
+}
+
+size_t KnownBitsProp::known_low(const Known& k) const {
+  size_t i = 0;
+  for (size_t ie = k.mask.size(); (i < ie) && k.mask.get(i); ++i);
+  return i;
+}
+
+size_t KnownBitsProp::zeros_low(const Known& k) const {
+  size_t i = 0;
+  for (size_t ie = k.mask.size(); (i < ie) && k.mask.get(i) && !k.val.get(i); ++i);
+  return i;
+}
+
+size_t KnownBitsProp::ones_low(const Known& k) const {
+  size_t i = 0;
+  for (size_t ie = k.mask.size(); (i < ie) && k.mask.get(i) && k.val.get(i); ++i);
+  return i;
+}
+
+size_t KnownBitsProp::zeros_high(const Known& k) const {
+  size_t i = 0;
+  for (size_t ie = k.mask.size(); (i < ie) && k.mask.get(ie-i-1) && !k.val.get(ie-i-1); ++i);
+  return i;
+}
+
+bool KnownBitsProp::is_one(const Known& k, size_t n) const {
+  if ((known_low(k) < min(n, k.mask.size())) || !k.val.get(0)) {
+    return false;
+  }
+  for (size_t i = 1, ie = min(n, k.val.size()); i < ie; ++i) {
+    if (k.val.get(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t KnownBitsProp::significant(const Expression* e) const {
+  // Non-negative signed numbers are zero-extended in an unsigned context
+  const auto w = Evaluate().get_width(e);
+  if (e->is(Node::Tag::number) && (Evaluate().get_type(e) == Bits::Type::SIGNED)) {
+    const auto& val = Evaluate().get_value(e);
+    if (val.get(val.size()-1)) {
+      return w;
+    }
+    size_t i = val.size();
+    for (; (i > 0) && !val.get(i-1); --i);
+    return i;
+  }
+  if (Evaluate().get_type(e) != Bits::Type::UNSIGNED) {
+    return w;
+  }
+  return w - zeros_high(known(e));
+}
+
+int KnownBitsProp::truth(const Known& k) const {
+  for (size_t i = 0, ie = k.mask.size(); i < ie; ++i) {
+    if (k.mask.get(i) && k.val.get(i)) {
+      return 1;
+    }
+  }
+  return (known_low(k) == k.mask.size()) ? 0 : -1;
+}
+
+Expression* KnownBitsProp::fold(Expression* e) {
+  const auto k = known(e);
+  if (known_low(k) < k.mask.size()) {
+    return e;
+  }
+  auto* res = new Number(k.val, Number::Format::HEX);
+  Evaluate().invalidate(e);
+  return res;
+}
+
+void KnownBitsProp::narrow_compare(BinaryExpression* be) {
+  switch (be->get_op()) {
+    case BinaryExpression::Op::EEEQ:
+    case BinaryExpression::Op::EEQ:
+    case BinaryExpression::Op::BEEQ:
+    case BinaryExpression::Op::BEQ:
+    case BinaryExpression::Op::GT:
+    case BinaryExpression::Op::GEQ:
+    case BinaryExpression::Op::LT:
+    case BinaryExpression::Op::LEQ:
+      break;
+    default:
+      return;
+  }
+
+  // The operands of a comparison are extended to the width of the wider of
+  // the two. If the comparison is unsigned and the upper bits of both
+  // operands are known to be zero, only the remaining low bits need to be
+  // compared. Narrowing may change the width of the comparison, so we only
+  // touch operands whose value, and not just whose low bits, is preserved.
+  const auto* l = be->get_lhs();
+  const auto* r = be->get_rhs();
+  const auto is_unsigned = (Evaluate().get_type(l) == Bits::Type::UNSIGNED) || (Evaluate().get_type(r) == Bits::Type::UNSIGNED);
+  if (!is_unsigned || !exact(l) || !exact(r)) {
+    return;
+  }
+  const auto w = Evaluate().get_width(l);
+  const auto n = max(max(significant(l), significant(r)), static_cast<size_t>(1));
+  if (n >= w) {
+    return;
+  }
+  narrow_operands(be, n, true);
+}
+
+bool KnownBitsProp::exact(const Expression* e) const {
+  // Narrowing these expressions only ever removes bits which are known to be
+  // zero. Signed operands other than non-negative numbers are sign-extended
+  // and can't be narrowed.
+  if (e->is(Node::Tag::number)) {
+    return Evaluate().get_type(e) != Bits::Type::REAL;
+  }
+  if (e->is(Node::Tag::identifier) || e->is(Node::Tag::concatenation)) {
+    return Evaluate().get_type(e) == Bits::Type::UNSIGNED;
+  }
+  return false;
+}
+
+bool KnownBitsProp::narrowable(const Expression* e) const {
+  if (Evaluate().get_type(e) == Bits::Type::REAL) {
+    return false;
+  }
+  switch (e->get_tag()) {
+    // Self-determined expressions have the same value in any context, and
+    // extending them to a wider context doesn't change their low bits.
+    case Node::Tag::concatenation:
+    case Node::Tag::identifier:
+    case Node::Tag::multiple_concatenation:
+    case Node::Tag::number:
+      return true;
+    case Node::Tag::binary_expression: {
+      const auto* be = static_cast<const BinaryExpression*>(e);
+      switch (be->get_op()) {
+        case BinaryExpression::Op::EEEQ:
+        case BinaryExpression::Op::EEQ:
+        case BinaryExpression::Op::BEEQ:
+        case BinaryExpression::Op::BEQ:
+        case BinaryExpression::Op::AAMP:
+        case BinaryExpression::Op::PPIPE:
+        case BinaryExpression::Op::LT:
+        case BinaryExpression::Op::LEQ:
+        case BinaryExpression::Op::GT:
+        case BinaryExpression::Op::GEQ:
+          return true;
+        // The low bits of these operators only depend on the low bits of
+        // their operands. Signed operators are left alone, since narrowing
+        // makes operands unsigned, and that changes how their siblings are
+        // extended.
+        case BinaryExpression::Op::PLUS:
+        case BinaryExpression::Op::MINUS:
+        case BinaryExpression::Op::TIMES:
+        case BinaryExpression::Op::AMP:
+        case BinaryExpression::Op::PIPE:
+        case BinaryExpression::Op::CARAT:
+        case BinaryExpression::Op::TCARAT:
+          return (Evaluate().get_type(be) == Bits::Type::UNSIGNED) && narrowable(be->get_lhs()) && narrowable(be->get_rhs());
+        // Shift amounts are self-determined
+        case BinaryExpression::Op::LLT:
+        case BinaryExpression::Op::LLLT:
+          return (Evaluate().get_type(be) == Bits::Type::UNSIGNED) && narrowable(be->get_lhs());
+        // Everything else (right shifts, division, modulus, and powers)
+        // depends on the upper bits of its operands.
+        default:
+          return false;
+      }
+    }
+    case Node::Tag::conditional_expression: {
+      const auto* ce = static_cast<const ConditionalExpression*>(e);
+      return (Evaluate().get_type(ce) == Bits::Type::UNSIGNED) && narrowable(ce->get_lhs()) && narrowable(ce->get_rhs());
+    }
+    case Node::Tag::unary_expression: {
+      const auto* ue = static_cast<const UnaryExpression*>(e);
+      switch (ue->get_op()) {
+        case UnaryExpression::Op::PLUS:
+        case UnaryExpression::Op::MINUS:
+        case UnaryExpression::Op::TILDE:
+          return (Evaluate().get_type(ue) == Bits::Type::UNSIGNED) && narrowable(ue->get_lhs());
+        // Reductions and logical negation are self-determined
+        default:
+          return true;
+      }
+    }
+    default:
+      return false;
+  }
+}
+
+Expression* KnownBitsProp::narrow(const Identifier* lhs, Expression* rhs) {
+  // Only the low-order bits of the right-hand side of an assignment are ever
+  // written, and the left-hand side is part of the context which determines
+  // its width. Anything we do below preserves those bits.
+  if (Evaluate().get_type(lhs) == Bits::Type::REAL) {
+    return rhs;
+  }
+  return narrow(rhs, Evaluate().get_width(lhs));
+}
+
+Expression* KnownBitsProp::narrow(Expression* e, size_t n) {
+  if (Evaluate().get_type(e) == Bits::Type::REAL) {
+    return e;
+  }
+  if (e->is(Node::Tag::number)) {
+    if (Evaluate().get_width(e) <= n) {
+      return e;
+    }
+    auto val = Evaluate().get_value(e);
+    val.resize(n);
+    val.reinterpret_type(Bits::Type::UNSIGNED);
+    return new Number(val, Number::Format::HEX);
+  }
+  const auto k = known(e);
+  if (known_low(k) >= min(n, k.mask.size())) {
+    auto val = k.val;
+    val.resize(min(n, val.size()));
+    return new Number(val, Number::Format::HEX);
+  }
+
+  // Narrowing an operand also shrinks the context-determined width of its
+  // siblings. Unless that can't change the low n bits of any of them, leave
+  // the whole expression alone.
+  if (!narrowable(e)) {
+    return e;
+  }
+
+  switch (e->get_tag()) {
+    case Node::Tag::binary_expression:
+      return narrow(static_cast<BinaryExpression*>(e), n);
+    case Node::Tag::conditional_expression:
+      return narrow(static_cast<ConditionalExpression*>(e), n);
+    case Node::Tag::concatenation:
+      return narrow(static_cast<Concatenation*>(e), n);
+    case Node::Tag::identifier:
+      return narrow(static_cast<Identifier*>(e), n);
+    case Node::Tag::unary_expression:
+      return narrow(static_cast<UnaryExpression*>(e), n);
+    default:
+      return e;
+  }
+}
+
+Expression* KnownBitsProp::narrow(BinaryExpression* be, size_t n) {
+  switch (be->get_op()) {
+    case BinaryExpression::Op::PLUS:
+    case BinaryExpression::Op::PIPE:
+    case BinaryExpression::Op::CARAT:
+      if (zeros_low(known(be->get_rhs())) >= n) {
+        return take(be, n, true);
+      } 
+      if (zeros_low(known(be->get_lhs())) >= n) {
+        return take(be, n, false);
+      }
+      narrow_operands(be, n, true);
+      return be;
+    case BinaryExpression::Op::MINUS:
+      if (zeros_low(known(be->get_rhs())) >= n) {
+        return take(be, n, true);
+      } 
+      narrow_operands(be, n, true);
+      return be;
+    case BinaryExpression::Op::TIMES: {
+      const auto l = known(be->get_lhs());
+      const auto r = known(be->get_rhs());
+      if (is_one(r, n)) {
+        return take(be, n, true);
+      }
+      if (is_one(l, n)) {
+        return take(be, n, false);
+      }
+      narrow_operands(be, n, true);
+      return be;
+    }
+    case BinaryExpression::Op::AMP:
+      if (ones_low(known(be->get_rhs())) >= n) {
+        return take(be, n, true);
+      } 
+      if (ones_low(known(be->get_lhs())) >= n) {
+        return take(be, n, false);
+      }
+      narrow_operands(be, n, true);
+      return be;
+    case BinaryExpression::Op::TCARAT:
+      narrow_operands(be, n, true);
+      return be;
+    case BinaryExpression::Op::LLT:
+    case BinaryExpression::Op::LLLT: {
+      // The shift amount is self-determined and can't be narrowed.
+      const auto r = known_unsigned(be->get_rhs());
+      if (zeros_low(r) == r.mask.size()) {
+        return take(be, n, true);
+      }
+      narrow_operands(be, n, false);
+      return be;
+    }
+    default:
+      return be;
+  }
+}
+
+void KnownBitsProp::narrow_operands(BinaryExpression* be, size_t n, bool rhs) {
+  auto* l = narrow(be->get_lhs(), n);
+  if (l != be->get_lhs()) {
+    be->replace_lhs(l);
+    Evaluate().invalidate(be);
+  }
+  if (!rhs) {
+    return;
+  }
+  auto* r = narrow(be->get_rhs(), n);
+  if (r != be->get_rhs()) {
+    be->replace_rhs(r);
+    Evaluate().invalidate(be);
+  }
+}
+
+Expression* KnownBitsProp::take(BinaryExpression* be, size_t n, bool lhs) {
+  if (lhs) {
+    auto* res = narrow(be->get_lhs(), n);
+    if (res == be->get_lhs()) {
+      be->set_lhs(new Identifier("ignore"));
+    }
+    return res;
+  } 
+  auto* res = narrow(be->get_rhs(), n);
+  if (res == be->get_rhs()) {
+    be->set_rhs(new Identifier("ignore"));
+  }
+  return res;
+}
+
+Expression* KnownBitsProp::narrow(ConditionalExpression* ce, size_t n) {
+  // The condition is self-determined and can't be narrowed
+  const auto t = truth(known(ce->get_cond()));
+  if (t == 1) {
+    auto* res = narrow(ce->get_lhs(), n);
+    if (res == ce->get_lhs()) {
+      ce->set_lhs(new Identifier("ignore"));
+    }
+    return res;
+  } 
+  if (t == 0) {
+    auto* res = narrow(ce->get_rhs(), n);
+    if (res == ce->get_rhs()) {
+      ce->set_rhs(new Identifier("ignore"));
+    }
+    return res;
+  }
+
+  auto* l = narrow(ce->get_lhs(), n);
+  if (l != ce->get_lhs()) {
+    ce->replace_lhs(l);
+    Evaluate().invalidate(ce);
+  }
+  auto* r = narrow(ce->get_rhs(), n);
+  if (r != ce->get_rhs()) {
+    ce->replace_rhs(r);
+    Evaluate().invalidate(ce);
+  }
+  return ce;
+}
+
+Expression* KnownBitsProp::narrow(Concatenation* c, size_t n) {
+  // The elements of a concatenation are self-determined. The best we can do
+  // is to drop the elements which lie entirely above the low n bits.
+  size_t w = 0;
+  size_t keep = 0;
+  for (size_t i = c->size_exprs(); (i > 0) && (w < n); --i, ++keep) {
+    w += Evaluate().get_width(c->get_exprs(i-1));
+  }
+  if (keep < c->size_exprs()) {
+    while (c->size_exprs() > keep) {
+      c->purge_exprs(c->begin_exprs());
+    }
+    Evaluate().invalidate(c);
+  }
+
+  // If all that's left is a single unsigned variable or number, we can get
+  // rid of the concatenation altogether. This isn't true of anything else,
+  // since the width of the element would no longer be self-determined.
+  if (c->size_exprs() != 1) {
+    return c;
+  }
+  auto* e = c->front_exprs();
+  const auto primary = e->is(Node::Tag::identifier) || e->is(Node::Tag::number);
+  if (!primary || (Evaluate().get_type(e) != Bits::Type::UNSIGNED)) {
+    return c;
+  }
+  auto* res = narrow(e, n);
+  if (res == e) {
+    c->set_exprs(0, new Identifier("ignore"));
+  }
+  return res;
+}
+
+Expression* KnownBitsProp::narrow(Identifier* id, size_t n) {
+  // Variables which are wider than n are replaced by a slice of their low
+  // order bits. We don't touch anything which is already subscripted.
+  if (Evaluate().get_width(id) <= n) {
+    return id;
+  }
+  const auto* r = Resolve().get_resolution(id);
+  if ((r == nullptr) || (id->size_dim() != r->size_dim()) || (Evaluate().get_type(r) != Bits::Type::UNSIGNED)) {
+    return id;
+  }
+  const auto msb = Evaluate().get_msb(id);
+  const auto lsb = Evaluate().get_lsb(id);
+  if ((msb < lsb) || ((msb-lsb+1) <= n)) {
+    return id;
+  }
+  id->push_back_dim(new RangeExpression(lsb+n, lsb));
+  Evaluate().invalidate(id);
+  return id;
+}
+
+Expression* KnownBitsProp::narrow(UnaryExpression* ue, size_t n) {
+  switch (ue->get_op()) {
+    case UnaryExpression::Op::PLUS: {
+      auto* res = narrow(ue->get_lhs(), n);
+      if (res == ue->get_lhs()) {
+        ue->set_lhs(new Identifier("ignore"));
+      }
+      return res;
+    }
+    case UnaryExpression::Op::MINUS:
+    case UnaryExpression::Op::TILDE: {
+      auto* l = narrow(ue->get_lhs(), n);
+      if (l != ue->get_lhs()) {
+        ue->replace_lhs(l);
+        Evaluate().invalidate(ue);
+      }
+      return ue;
+    }
+    default:
+      return ue;
+  }
+}
+
+} // namespace cascade
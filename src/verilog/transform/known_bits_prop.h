@@ -0,0 +1,142 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_TRANSFORM_KNOWN_BITS_PROP_H
+#define CASCADE_SRC_VERILOG_TRANSFORM_KNOWN_BITS_PROP_H
+
+#include <stddef.h>
+#include "common/bits.h"
+#include "verilog/ast/ast_fwd.h"
+#include "verilog/ast/visitors/rewriter.h"
+
+namespace cascade {
+
+// This pass tracks which bits of every unsigned expression are known at
+// compile time, even when the expression as a whole is not a constant. Any
+// expression whose bits are all known is replaced by a number. In addition,
+// the right-hand side of every assignment is rewritten so that its
+// context-determined width is no larger than its target: operands which only
+// contribute discarded upper bits are replaced by slices, numbers are
+// truncated, and identities like x&1...1, x|0, x+0, x*1, and x<<0 are
+// removed. This only happens when the low bits of every operator in the
+// context depend only on the low bits of its operands. Unsigned comparisons
+// between variables, concatenations, and numbers whose upper bits are known
+// to be zero are narrowed to the bits which remain. Declarations are never narrowed; their widths are observable
+// across re-evaluation and state transfer.
+
+class KnownBitsProp : public Rewriter {
+  public:
+    KnownBitsProp();
+    ~KnownBitsProp() override = default;
+
+    void run(ModuleDeclaration* md);
+
+  private:
+    // The bits of an expression at its context-determined width. Val is only
+    // meaningful where the corresponding bit of mask is set.
+    struct Known {
+      Bits mask;
+      Bits val;
+    };
+
+    // Rewriter Interface:
+    Attributes* rewrite(Attributes* as) override;
+    Expression* rewrite(BinaryExpression* be) override;
+    Expression* rewrite(ConditionalExpression* ce) override;
+    Expression* rewrite(Concatenation* c) override;
+    Expression* rewrite(FopenExpression* fe) override;
+    Expression* rewrite(MultipleConcatenation* mc) override;
+    Expression* rewrite(UnaryExpression* ue) override;
+    ModuleItem* rewrite(ContinuousAssign* ca) override;
+    ModuleItem* rewrite(GenvarDeclaration* gd) override;
+    ModuleItem* rewrite(LocalparamDeclaration* ld) override;
+    ModuleItem* rewrite(NetDeclaration* nd) override;
+    ModuleItem* rewrite(ParameterDeclaration* pd) override;
+    ModuleItem* rewrite(RegDeclaration* rd) override;
+    Statement* rewrite(BlockingAssign* ba) override;
+    Statement* rewrite(NonblockingAssign* na) override;
+    Statement* rewrite(DebugStatement* ds) override;
+
+    // Known-bits analysis:
+    Known known(const Expression* e) const;
+    Known known(const BinaryExpression* be, size_t w) const;
+    Known known(const UnaryExpression* ue, size_t w) const;
+    // Like known(), but treats numbers as unsigned regardless of their type.
+    // This is how self-determined operands like shift amounts are used.
+    Known known_unsigned(const Expression* e) const;
+    // Returns the number of low-order bits of k which are known
+    size_t known_low(const Known& k) const;
+    // Returns the number of low-order bits of k which are known to be zero
+    size_t zeros_low(const Known& k) const;
+    // Returns the number of low-order bits of k which are known to be one
+    size_t ones_low(const Known& k) const;
+    // Returns the number of high-order bits of k which are known to be zero
+    size_t zeros_high(const Known& k) const;
+    // Returns true if the low n bits of k are known to equal one
+    bool is_one(const Known& k, size_t n) const;
+    // Returns 1 or 0 if the truth value of k is known, and -1 otherwise
+    int truth(const Known& k) const;
+    // Returns the number of low-order bits of e which may be non-zero at its
+    // context-determined width
+    size_t significant(const Expression* e) const;
+
+    // Rewriting:
+    //
+    // Replaces e by a number if all of its bits are known. Returns e otherwise.
+    Expression* fold(Expression* e);
+    // Narrows the operands of a comparison to the bits which may be non-zero
+    void narrow_compare(BinaryExpression* be);
+    // Returns true if narrowing e preserves its value rather than just its
+    // low-order bits
+    bool exact(const Expression* e) const;
+    // Returns true if only using the low bits of e, and narrowing the context
+    // that it's evaluated in, preserves the low bits of every subexpression
+    // in that context
+    bool narrowable(const Expression* e) const;
+    // Rewrites the right-hand side of an assignment to an n-bit target
+    Expression* narrow(const Identifier* lhs, Expression* rhs);
+    // Rewrites e, knowing that only its low n bits are used. Returns either
+    // e, or a replacement which is not attached to the AST.
+    Expression* narrow(Expression* e, size_t n);
+    Expression* narrow(BinaryExpression* be, size_t n);
+    // Narrows the operands of be in place. The right-hand side is only
+    // narrowed if rhs is true.
+    void narrow_operands(BinaryExpression* be, size_t n, bool rhs);
+    // Narrows one operand of be and detaches it from the AST
+    Expression* take(BinaryExpression* be, size_t n, bool lhs);
+    Expression* narrow(ConditionalExpression* ce, size_t n);
+    Expression* narrow(Concatenation* c, size_t n);
+    Expression* narrow(Identifier* id, size_t n);
+    Expression* narrow(UnaryExpression* ue, size_t n);
+};
+
+} // namespace cascade
+
+#endif
@@ -30,22 +30,50 @@
 
 #include "verilog/transform/loop_unroll.h"
 
+#include <cctype>
+#include <string>
 #include "verilog/analyze/evaluate.h"
 #include "verilog/analyze/module_info.h"
 #include "verilog/analyze/navigate.h"
 #include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
 
 using namespace std;
 
 namespace cascade {
 
-LoopUnroll::LoopUnroll() : Rewriter() { }
+LoopUnroll::LoopUnroll() : Rewriter() {
+  set_max_size(1 << 15);
+}
+
+LoopUnroll& LoopUnroll::set_max_size(size_t n) {
+  max_size_ = n;
+  return *this;
+}
 
 void LoopUnroll::run(ModuleDeclaration* md) {
+  // Don't reuse the names of counters introduced by a previous run
+  next_id_ = 0;
+  for (auto i = md->begin_items(), ie = md->end_items(); i != ie; ++i) {
+    if ((*i)->is_subclass_of(Node::Tag::declaration)) {
+      const auto& n = static_cast<const Declaration*>(*i)->get_id()->front_ids()->get_readable_sid();
+      if ((n.compare(0, 7, "__loop_") == 0) && (n.length() > 7) && isdigit(n[7])) {
+        next_id_ = max(next_id_, static_cast<size_t>(stoul(n.substr(7))) + 1);
+      }
+    }
+  }
+
   md->accept_items(this);
 
-  // Invalidate cached state (we haven't added or deleted declarations, so
-  // there's no need to invalidate the scope tree).
+  // Invalidate cached state. We only need to invalidate the scope tree if we
+  // introduced any new counters.
+  for (auto* d : decls_) {
+    md->push_front_items(d);
+  }
+  if (!decls_.empty()) {
+    Navigate(md).invalidate();
+  }
+  decls_.clear();
   Resolve().invalidate(md);
   ModuleInfo(md).invalidate();
 
@@ -55,7 +83,14 @@ void LoopUnroll::run(ModuleDeclaration* md) {
   md->accept_items(&r);
 }
 
-LoopUnroll::Unroll::Unroll() : Builder() { }
+LoopUnroll::Unroll::Unroll(size_t max_size) : Builder() {
+  max_size_ = max_size;
+  size_ = 0;
+}
+
+bool LoopUnroll::Unroll::overflow() const {
+  return size_ > max_size_;
+}
 
 Statement* LoopUnroll::Unroll::build(const BlockingAssign* ba) {
   const auto& val = Evaluate().get_value(ba->get_rhs());
@@ -66,12 +101,17 @@ Statement* LoopUnroll::Unroll::build(const BlockingAssign* ba) {
 
 Statement* LoopUnroll::Unroll::build(const ForStatement* fs) {
   auto* sb = new SeqBlock();
+  const auto n = Size().count(fs->get_stmt()) + Size().count(fs->get_update());
 
   const auto& ival = Evaluate().get_value(fs->get_init()->get_rhs());
   Evaluate().assign_value(fs->get_init()->get_lhs(), ival);
   sb->push_back_stmts(new BlockingAssign(fs->get_init()->get_lhs()->clone(), fs->get_init()->get_rhs()->clone()));
 
   while (Evaluate().get_value(fs->get_cond()).to_bool()) {
+    size_ += n;
+    if (overflow()) {
+      break;
+    }
     auto* s = fs->get_stmt()->accept(this);
     sb->push_back_stmts(s);
 
@@ -85,46 +125,109 @@ Statement* LoopUnroll::Unroll::build(const ForStatement* fs) {
 
 Statement* LoopUnroll::Unroll::build(const RepeatStatement* rs) {
   const auto n = Evaluate().get_value(rs->get_cond()).to_uint();
+  const auto m = Size().count(rs->get_stmt());
   auto* sb = new SeqBlock();
   for (size_t i = 0; i < n; ++i) {
+    size_ += m;
+    if (overflow()) {
+      break;
+    }
     auto* s = rs->get_stmt()->accept(this);
     sb->push_back_stmts(s);
   }
   return sb;
 }
 
-LoopUnroll::Reset::Reset() : Visitor() { }
-
-void LoopUnroll::Reset::visit(const RegDeclaration* rd) {
-  if (rd->is_non_null_val()) {
-    const auto& val = Evaluate().get_value(rd->get_val());
-    Evaluate().assign_value(rd->get_id(), val);
-  }
-}
-
 Statement* LoopUnroll::Unroll::build(const WhileStatement* ws) {
+  const auto n = Size().count(ws->get_stmt());
   auto* sb = new SeqBlock();
   while (Evaluate().get_value(ws->get_cond()).to_bool()) {
+    size_ += n;
+    if (overflow()) {
+      break;
+    }
     auto* s = ws->get_stmt()->accept(this);
     sb->push_back_stmts(s);
   }
   return sb;
 }
 
+LoopUnroll::Size::Size() : Visitor() { }
+
+size_t LoopUnroll::Size::count(const Node* n) {
+  // Count at least one for every iteration, even if its body is empty
+  n_ = 1;
+  n->accept(this);
+  return n_;
+}
+
+void LoopUnroll::Size::visit(const Identifier* id) {
+  Visitor::visit(id);
+  ++n_;
+}
+
+void LoopUnroll::Size::visit(const Number* n) {
+  (void) n;
+  ++n_;
+}
+
+LoopUnroll::Reset::Reset() : Visitor() { }
+
+void LoopUnroll::Reset::visit(const RegDeclaration* rd) {
+  if (rd->is_non_null_val()) {
+    const auto& val = Evaluate().get_value(rd->get_val());
+    Evaluate().assign_value(rd->get_id(), val);
+  }
+}
+
 Statement* LoopUnroll::rewrite(ForStatement* fs) {
-  Unroll u;
-  return fs->accept(&u);
+  Unroll u(max_size_);
+  auto* res = fs->accept(&u);
+  // If this loop is too large to unroll, leave it alone. We don't descend into
+  // its body: the trip counts of any nested loops may depend on variables
+  // which are only known at runtime.
+  if (u.overflow()) {
+    delete res;
+    return fs;
+  }
+  return res;
 }
 
 Statement* LoopUnroll::rewrite(RepeatStatement* rs) {
-  Unroll u;
-  return rs->accept(&u);
+  const auto n = Evaluate().get_value(rs->get_cond()).to_uint();
+  Unroll u(max_size_);
+  auto* res = rs->accept(&u);
+  if (!u.overflow()) {
+    return res;
+  }
+  delete res;
+
+  // Repeat statements don't have a variable that we can use to keep track of
+  // where we are. We'll need to introduce one. The trip count is a static
+  // constant, so the counter only needs to be wide enough to hold it.
+  size_t w = 1;
+  for (; (w < 8*sizeof(n)) && ((n >> w) != 0); ++w);
+  const auto name = "__loop_" + to_string(next_id_++);
+  decls_.push_back(new RegDeclaration(new Attributes(), new Identifier(name), Declaration::Type::UNSIGNED, new RangeExpression(w), nullptr));
+
+  auto* s = rs->get_stmt();
+  rs->set_stmt(new SeqBlock());
+  return new ForStatement(
+    new VariableAssign(new Identifier(name), new Number(Bits(w, 0), Number::Format::HEX)),
+    new BinaryExpression(new Identifier(name), BinaryExpression::Op::LT, new Number(Bits(w, n), Number::Format::HEX)),
+    new VariableAssign(new Identifier(name), new BinaryExpression(new Identifier(name), BinaryExpression::Op::PLUS, new Number(Bits(w, 1), Number::Format::HEX))),
+    s
+  );
 }
 
 Statement* LoopUnroll::rewrite(WhileStatement* ws) {
-  Unroll u;
-  return ws->accept(&u);
+  Unroll u(max_size_);
+  auto* res = ws->accept(&u);
+  if (u.overflow()) {
+    delete res;
+    return ws;
+  }
+  return res;
 }
 
-
 } // namespace cascade
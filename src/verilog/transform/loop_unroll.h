@@ -31,28 +31,58 @@
 #ifndef CASCADE_SRC_VERILOG_TRANSFORM_LOOP_UNROLL_H
 #define CASCADE_SRC_VERILOG_TRANSFORM_LOOP_UNROLL_H
 
+#include <stddef.h>
+#include <vector>
 #include "verilog/ast/visitors/builder.h"
 #include "verilog/ast/visitors/rewriter.h"
 #include "verilog/ast/visitors/visitor.h"
 
 namespace cascade {
 
+// This pass statically unrolls loop statements. Loops which would unroll into
+// more than a fixed number of primaries (identifiers and numbers, which are a
+// good proxy for the size of the code that we generate) are left in place and
+// executed as loops. Repeat statements which are left in place are rewritten
+// as for loops over a fresh counter variable.
+
 class LoopUnroll : public Rewriter {
   public:
     LoopUnroll();
     ~LoopUnroll() override = default;
 
+    // Configuration Interface:
+    LoopUnroll& set_max_size(size_t n);
+
     void run(ModuleDeclaration* md);
 
   private:
+    size_t max_size_;
+    size_t next_id_;
+    std::vector<RegDeclaration*> decls_;
+
     struct Unroll : public Builder {
-      Unroll();
+      explicit Unroll(size_t max_size);
       ~Unroll() override = default;
 
+      // Returns true if unrolling was abandoned because it exceeded max_size
+      bool overflow() const;
+
       Statement* build(const BlockingAssign* ba) override;
       Statement* build(const ForStatement* fs) override;
       Statement* build(const RepeatStatement* rs) override;
       Statement* build(const WhileStatement* ws) override;
+
+      size_t max_size_;
+      size_t size_;
+    };
+
+    struct Size : public Visitor {
+      Size();
+      ~Size() override = default;
+      size_t count(const Node* n);
+      void visit(const Identifier* id) override;
+      void visit(const Number* n) override;
+      size_t n_;
     };
 
     struct Reset : public Visitor {
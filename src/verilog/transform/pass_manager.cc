@@ -0,0 +1,417 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/transform/pass_manager.h"
+
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "verilog/ast/ast.h"
+#include "verilog/ast/visitors/visitor.h"
+#include "verilog/transform/assign_unpack.h"
+#include "verilog/transform/block_flatten.h"
+#include "verilog/transform/common_subexpression_eliminate.h"
+#include "verilog/transform/constant_prop.h"
+#include "verilog/transform/control_merge.h"
+#include "verilog/transform/de_alias.h"
+#include "verilog/transform/dead_code_eliminate.h"
+#include "verilog/transform/dead_state_eliminate.h"
+#include "verilog/transform/event_expand.h"
+#include "verilog/transform/index_normalize.h"
+#include "verilog/transform/known_bits_prop.h"
+#include "verilog/transform/loop_unroll.h"
+#include "verilog/transform/strength_reduce.h"
+
+using namespace std;
+
+namespace cascade {
+
+namespace {
+
+// Counts every node in a subtree
+struct Counter : Visitor {
+  Counter() : Visitor(), n(0) { }
+  ~Counter() override = default;
+
+  size_t n;
+
+  #define COUNT(T) void visit(const T* t) override { ++n; Visitor::visit(t); }
+  COUNT(ArgAssign)
+  COUNT(Attributes)
+  COUNT(AttrSpec)
+  COUNT(CaseGenerateItem)
+  COUNT(CaseItem)
+  COUNT(Event)
+  COUNT(BinaryExpression)
+  COUNT(ConditionalExpression)
+  COUNT(FeofExpression)
+  COUNT(FopenExpression)
+  COUNT(Concatenation)
+  COUNT(Identifier)
+  COUNT(MultipleConcatenation)
+  COUNT(Number)
+  COUNT(String)
+  COUNT(RangeExpression)
+  COUNT(UnaryExpression)
+  COUNT(GenerateBlock)
+  COUNT(Id)
+  COUNT(IfGenerateClause)
+  COUNT(ModuleDeclaration)
+  COUNT(AlwaysConstruct)
+  COUNT(IfGenerateConstruct)
+  COUNT(CaseGenerateConstruct)
+  COUNT(LoopGenerateConstruct)
+  COUNT(InitialConstruct)
+  COUNT(ContinuousAssign)
+  COUNT(GenvarDeclaration)
+  COUNT(LocalparamDeclaration)
+  COUNT(NetDeclaration)
+  COUNT(ParameterDeclaration)
+  COUNT(RegDeclaration)
+  COUNT(GenerateRegion)
+  COUNT(ModuleInstantiation)
+  COUNT(PortDeclaration)
+  COUNT(BlockingAssign)
+  COUNT(NonblockingAssign)
+  COUNT(CaseStatement)
+  COUNT(ConditionalStatement)
+  COUNT(ForStatement)
+  COUNT(RepeatStatement)
+  COUNT(ParBlock)
+  COUNT(SeqBlock)
+  COUNT(TimingControlStatement)
+  COUNT(DebugStatement)
+  COUNT(FflushStatement)
+  COUNT(FinishStatement)
+  COUNT(FseekStatement)
+  COUNT(GetStatement)
+  COUNT(PutStatement)
+  COUNT(RestartStatement)
+  COUNT(RetargetStatement)
+  COUNT(SaveStatement)
+  COUNT(WhileStatement)
+  COUNT(EventControl)
+  COUNT(VariableAssign)
+  #undef COUNT
+};
+
+// Strips whitespace from both ends of a string
+string trim(const string& s) {
+  const auto b = s.find_first_not_of(" \t\n");
+  if (b == string::npos) {
+    return "";
+  }
+  const auto e = s.find_last_not_of(" \t\n");
+  return s.substr(b, e-b+1);
+}
+
+} // namespace
+
+PassManager::PassManager() {
+  max_iterations_ = 8;
+  stats_ = false;
+  set_pipeline(default_pipeline());
+}
+
+PassManager& PassManager::set_pipeline(const string& spec) {
+  pipeline_.clear();
+  error_ = false;
+  unknown_.clear();
+
+  for (size_t i = 0, ie = spec.length(); i < ie; ) {
+    Step s;
+    s.repeat = false;
+
+    // Split off the next step. This is either a parenthesized group or
+    // everything up to the next comma.
+    string body;
+    const auto start = spec.find_first_not_of(" \t\n", i);
+    if (start == string::npos) {
+      break;
+    }
+    if (spec[start] == '(') {
+      const auto close = spec.find(')', start);
+      if (close == string::npos) {
+        error_ = true;
+        break;
+      }
+      body = spec.substr(start+1, close-start-1);
+      i = close+1;
+    } else {
+      const auto comma = spec.find(',', start);
+      body = spec.substr(start, (comma == string::npos) ? string::npos : comma-start);
+      i = start + body.length();
+    }
+
+    // Check for a trailing *, and then skip past the comma
+    const auto next = spec.find_first_not_of(" \t\n", i);
+    if (next != string::npos && spec[next] == '*') {
+      s.repeat = true;
+      i = next+1;
+    } else if (!body.empty() && trim(body).back() == '*') {
+      s.repeat = true;
+      body = trim(body);
+      body.pop_back();
+    }
+    const auto comma = spec.find_first_not_of(" \t\n", i);
+    if (comma != string::npos) {
+      if (spec[comma] != ',') {
+        error_ = true;
+        break;
+      }
+      i = comma+1;
+    } else {
+      i = ie;
+    }
+
+    // Resolve the names in this step. Keep going past unrecognized names so
+    // that all of them can be reported.
+    stringstream ss(body);
+    for (string name; getline(ss, name, ','); ) {
+      name = trim(name);
+      Pass p;
+      if (!lookup(name, &p)) {
+        error_ = true;
+        unknown_.push_back(name);
+        continue;
+      }
+      s.passes.push_back(name);
+    }
+    if (s.passes.empty()) {
+      error_ = true;
+      break;
+    }
+    pipeline_.push_back(s);
+  }
+
+  if (error_) {
+    pipeline_.clear();
+  }
+  return *this;
+}
+
+PassManager& PassManager::set_max_iterations(size_t n) {
+  max_iterations_ = n;
+  return *this;
+}
+
+PassManager& PassManager::set_stats(bool stats) {
+  stats_ = stats;
+  return *this;
+}
+
+string PassManager::default_pipeline() {
+  return "assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,known_bits_prop,strength_reduce,event_expand,control_merge,dead_code_eliminate,block_flatten,common_subexpression_eliminate";
+}
+
+string PassManager::batch_pipeline() {
+  return "assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,known_bits_prop,strength_reduce,event_expand,control_merge,dead_state_eliminate,dead_code_eliminate,block_flatten,common_subexpression_eliminate";
+}
+
+vector<string> PassManager::passes() {
+  vector<string> res;
+  stringstream ss(batch_pipeline());
+  for (string name; getline(ss, name, ','); ) {
+    res.push_back(name);
+  }
+  return res;
+}
+
+string PassManager::remove(const string& spec, const string& name) {
+  // Drop every occurrence of name, along with any whitespace
+  string res;
+  for (size_t i = 0, ie = spec.length(); i < ie; ) {
+    if (isalnum(spec[i]) || (spec[i] == '_')) {
+      auto j = i;
+      while ((j < ie) && (isalnum(spec[j]) || (spec[j] == '_'))) {
+        ++j;
+      }
+      const auto tok = spec.substr(i, j-i);
+      if (tok != name) {
+        res += tok;
+      }
+      i = j;
+    } else if (isspace(spec[i])) {
+      ++i;
+    } else {
+      res += spec[i++];
+    }
+  }
+
+  // Clean up the separators and groups that this leaves behind
+  const vector<pair<string, string>> fixes = {{",,", ","}, {"(,", "("}, {",)", ")"}, {"()*", ""}, {"()", ""}, {",*", ""}};
+  for (auto changed = true; changed; ) {
+    changed = false;
+    for (const auto& f : fixes) {
+      for (auto pos = res.find(f.first); pos != string::npos; pos = res.find(f.first)) {
+        res.replace(pos, f.first.length(), f.second);
+        changed = true;
+      }
+    }
+  }
+  const auto b = res.find_first_not_of(",*");
+  if (b == string::npos) {
+    return "";
+  }
+  const auto e = res.find_last_not_of(",");
+  return res.substr(b, e-b+1);
+}
+
+bool PassManager::error() const {
+  return error_;
+}
+
+const vector<string>& PassManager::unknown() const {
+  return unknown_;
+}
+
+void PassManager::run(ModuleDeclaration* md) {
+  capped_.clear();
+  for (const auto& s : pipeline_) {
+    if (!s.repeat) {
+      for (const auto& p : s.passes) {
+        run_pass(p, md);
+      }
+      continue;
+    }
+    // Node count is a cheap proxy for whether a group has reached a fixpoint,
+    // but it isn't exact: a pass can rewrite a module without changing its
+    // size, and a group can keep changing size without ever settling. So
+    // this is bounded iteration rather than a true fixpoint, and groups which
+    // run into the bound are recorded.
+    auto settled = false;
+    for (size_t i = 0, n = count(md); !settled && (i < max_iterations_); ++i) {
+      for (const auto& p : s.passes) {
+        run_pass(p, md);
+      }
+      const auto m = count(md);
+      settled = (m == n);
+      n = m;
+    }
+    if (!settled) {
+      string group;
+      for (const auto& p : s.passes) {
+        group += (group.empty() ? "" : ",") + p;
+      }
+      capped_.push_back("(" + group + ")*");
+    }
+  }
+}
+
+const vector<string>& PassManager::capped() const {
+  return capped_;
+}
+
+size_t PassManager::count(const ModuleDeclaration* md) {
+  Counter c;
+  md->accept(&c);
+  return c.n;
+}
+
+const vector<PassManager::Stats>& PassManager::get_stats() const {
+  return results_;
+}
+
+void PassManager::clear_stats() {
+  results_.clear();
+}
+
+void PassManager::write_stats(ostream& os) const {
+  os << setw(24) << left << "pass" << setw(8) << right << "runs" << setw(12) << "time (us)" << setw(10) << "nodes" << endl;
+  for (const auto& s : results_) {
+    os << setw(24) << left << s.name << setw(8) << right << s.runs << setw(12) << (s.ns / 1000) << setw(10) << showpos << s.delta << noshowpos << endl;
+  }
+}
+
+bool PassManager::lookup(const string& name, Pass* p) {
+  if (name == "assign_unpack") {
+    *p = [](ModuleDeclaration* md) {AssignUnpack().run(md);};
+  } else if (name == "index_normalize") {
+    *p = [](ModuleDeclaration* md) {IndexNormalize().run(md);};
+  } else if (name == "loop_unroll") {
+    *p = [](ModuleDeclaration* md) {LoopUnroll().run(md);};
+  } else if (name == "de_alias") {
+    *p = [](ModuleDeclaration* md) {DeAlias().run(md);};
+  } else if (name == "constant_prop") {
+    *p = [](ModuleDeclaration* md) {ConstantProp().run(md);};
+  } else if (name == "known_bits_prop") {
+    *p = [](ModuleDeclaration* md) {KnownBitsProp().run(md);};
+  } else if (name == "strength_reduce") {
+    *p = [](ModuleDeclaration* md) {StrengthReduce().run(md);};
+  } else if (name == "event_expand") {
+    *p = [](ModuleDeclaration* md) {EventExpand().run(md);};
+  } else if (name == "control_merge") {
+    *p = [](ModuleDeclaration* md) {ControlMerge().run(md);};
+  } else if (name == "dead_state_eliminate") {
+    *p = [](ModuleDeclaration* md) {DeadStateEliminate().run(md);};
+  } else if (name == "dead_code_eliminate") {
+    *p = [](ModuleDeclaration* md) {DeadCodeEliminate().run(md);};
+  } else if (name == "block_flatten") {
+    *p = [](ModuleDeclaration* md) {BlockFlatten().run(md);};
+  } else if (name == "common_subexpression_eliminate") {
+    *p = [](ModuleDeclaration* md) {CommonSubexpressionEliminate().run(md);};
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void PassManager::run_pass(const string& name, ModuleDeclaration* md) {
+  Pass p;
+  lookup(name, &p);
+  if (!stats_) {
+    p(md);
+    return;
+  }
+
+  const auto before = count(md);
+  const auto start = chrono::steady_clock::now();
+  p(md);
+  const auto stop = chrono::steady_clock::now();
+  const auto after = count(md);
+
+  auto itr = results_.begin();
+  for (auto itre = results_.end(); itr != itre; ++itr) {
+    if (itr->name == name) {
+      break;
+    }
+  }
+  if (itr == results_.end()) {
+    results_.push_back({name, 0, 0, 0});
+    itr = results_.end()-1;
+  }
+  ++itr->runs;
+  itr->ns += chrono::duration_cast<chrono::nanoseconds>(stop-start).count();
+  itr->delta += static_cast<int64_t>(after) - static_cast<int64_t>(before);
+}
+
+} // namespace cascade
@@ -0,0 +1,141 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_TRANSFORM_PASS_MANAGER_H
+#define CASCADE_SRC_VERILOG_TRANSFORM_PASS_MANAGER_H
+
+#include <functional>
+#include <iosfwd>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "verilog/ast/ast_fwd.h"
+
+namespace cascade {
+
+// This class runs the IR pipeline over a module declaration. A pipeline is
+// a comma-separated list of pass names which are run in order. A pass name
+// followed by a *, or a parenthesized group of passes followed by a *, is
+// repeated until the number of nodes in the module stops changing or an
+// iteration limit is reached, e.g.
+//
+//   assign_unpack,(constant_prop,dead_code_eliminate)*,block_flatten
+//
+// Passes don't report whether they changed anything, so this is bounded
+// iteration rather than a guaranteed fixpoint. Groups which reach the limit
+// are reported by capped().
+//
+// The pass manager records the wall time spent in each pass and the change
+// in node count that it produced.
+
+class PassManager {
+  public:
+    // Per-pass statistics, aggregated over every run of that pass:
+    struct Stats {
+      std::string name;
+      size_t runs;
+      uint64_t ns;
+      int64_t delta;
+    };
+
+    // Constructors:
+    PassManager();
+    ~PassManager() = default;
+
+    // Configuration Interface:
+    //
+    // Replaces the current pipeline. Unrecognized pass names or malformed
+    // groups cause error() to return true.
+    PassManager& set_pipeline(const std::string& spec);
+    // Sets the maximum number of times that a repeated group is run.
+    PassManager& set_max_iterations(size_t n);
+    // Enables or disables the collection of statistics.
+    PassManager& set_stats(bool stats);
+
+    // Pipeline Interface:
+    //
+    // Returns the pipeline which is run by default.
+    static std::string default_pipeline();
+    // Returns the pipeline which is run by default on programs which are
+    // known to be complete. This adds passes which may remove state that
+    // code evaluated later on would otherwise be able to observe.
+    static std::string batch_pipeline();
+    // Returns a list of every pass name which is recognized.
+    static std::vector<std::string> passes();
+    // Returns a copy of spec with every occurrence of a pass removed.
+    static std::string remove(const std::string& spec, const std::string& name);
+    // Returns true if the last call to set_pipeline() failed.
+    bool error() const;
+    // Returns the pass names which the last call to set_pipeline() didn't
+    // recognize. This may be empty if it failed because of a malformed group.
+    const std::vector<std::string>& unknown() const;
+    // Runs the pipeline on md.
+    void run(ModuleDeclaration* md);
+    // Returns the repeated groups which reached the iteration limit during
+    // the last call to run(), written as they would appear in a pipeline.
+    const std::vector<std::string>& capped() const;
+    // Returns the number of nodes in md.
+    static size_t count(const ModuleDeclaration* md);
+
+    // Statistics Interface:
+    //
+    // Returns the statistics collected since the last call to clear_stats(),
+    // in the order that passes were first run.
+    const std::vector<Stats>& get_stats() const;
+    // Clears statistics.
+    void clear_stats();
+    // Prints statistics as a table.
+    void write_stats(std::ostream& os) const;
+
+  private:
+    typedef std::function<void(ModuleDeclaration*)> Pass;
+
+    // A contiguous run of passes, which may be repeated to a fixpoint
+    struct Step {
+      std::vector<std::string> passes;
+      bool repeat;
+    };
+
+    std::vector<Step> pipeline_;
+    size_t max_iterations_;
+    bool stats_;
+    bool error_;
+    std::vector<std::string> unknown_;
+    std::vector<std::string> capped_;
+    std::vector<Stats> results_;
+
+    static bool lookup(const std::string& name, Pass* p);
+    void run_pass(const std::string& name, ModuleDeclaration* md);
+};
+
+} // namespace cascade
+
+#endif
@@ -0,0 +1,244 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "verilog/transform/strength_reduce.h"
+
+#include "verilog/analyze/evaluate.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/analyze/resolve.h"
+#include "verilog/ast/ast.h"
+
+using namespace std;
+
+namespace cascade {
+
+StrengthReduce::StrengthReduce() : Rewriter() { }
+
+void StrengthReduce::run(ModuleDeclaration* md) {
+  md->accept_items(this);
+
+  // Invalidate cached state (we haven't added or deleted declarations, so
+  // there's no need to invalidate the scope tree).
+  Resolve().invalidate(md);
+  ModuleInfo(md).invalidate();
+}
+
+Attributes* StrengthReduce::rewrite(Attributes* as) {
+  // Does nothing. Attributes contain identifiers which don't resolve.
+  return as;
+}
+
+Expression* StrengthReduce::rewrite(BinaryExpression* be) {
+  Rewriter::rewrite(be);
+  switch (be->get_op()) {
+    case BinaryExpression::Op::TIMES:
+      return reduce_times(be);
+    case BinaryExpression::Op::DIV:
+      return reduce_div(be);
+    case BinaryExpression::Op::MOD:
+      return reduce_mod(be);
+    case BinaryExpression::Op::TTIMES:
+      return reduce_pow(be);
+    default:
+      return be;
+  }
+}
+
+Statement* StrengthReduce::rewrite(DebugStatement* ds) {
+  // Don't descend past here
+  return ds;
+}
+
+Expression* StrengthReduce::reduce_times(BinaryExpression* be) {
+  // Multiplication commutes, so the constant can appear on either side.
+  const auto lhs = be->get_rhs()->is(Node::Tag::number);
+  if (!lhs && !be->get_lhs()->is(Node::Tag::number)) {
+    return be;
+  }
+  // Resetting the evaluation state of this expression restores every number
+  // to its self-determined width.
+  Evaluate().invalidate(be);
+  const auto* x = lhs ? be->get_lhs() : be->get_rhs();
+  const auto c = static_cast<const Number*>(lhs ? be->get_rhs() : be->get_lhs())->get_val();
+  const auto k = log2(c);
+  if (k < 0) {
+    return be;
+  }
+  // The product has width max(x, c) and is only signed if both operands are.
+  // The shift has the width and sign of x. Outside of an assignment these
+  // have to agree.
+  if (!is_assign_rhs(be) && (self_width(x) < c.size())) {
+    return be;
+  }
+  const auto t = Evaluate().get_type(x);
+  if ((t == Bits::Type::REAL) || (!is_assign_rhs(be) && (t == Bits::Type::SIGNED) && !c.is_signed())) {
+    return be;
+  }
+
+  Evaluate().invalidate(be);
+  return new BinaryExpression(take(be, lhs), BinaryExpression::Op::LLT, new Number(Bits(32, k), Number::Format::HEX));
+}
+
+Expression* StrengthReduce::reduce_div(BinaryExpression* be) {
+  if (!be->get_rhs()->is(Node::Tag::number)) {
+    return be;
+  }
+  Evaluate().invalidate(be);
+  const auto* x = be->get_lhs();
+  const auto c = static_cast<const Number*>(be->get_rhs())->get_val();
+  const auto k = log2(c);
+  if (k < 0) {
+    return be;
+  }
+  // Signed division rounds towards zero, which isn't the same thing as an
+  // arithmetic shift for negative numbers. Unsigned division of a signed
+  // value is a logical shift, but only at the width the operand was extended
+  // to. Either way, it's simplest to require an unsigned dividend.
+  if (!is_assign_rhs(be) && (self_width(x) < c.size())) {
+    return be;
+  }
+  if (Evaluate().get_type(x) != Bits::Type::UNSIGNED) {
+    return be;
+  }
+
+  Evaluate().invalidate(be);
+  return new BinaryExpression(take(be, true), BinaryExpression::Op::GGT, new Number(Bits(32, k), Number::Format::HEX));
+}
+
+Expression* StrengthReduce::reduce_mod(BinaryExpression* be) {
+  if (!be->get_rhs()->is(Node::Tag::number)) {
+    return be;
+  }
+  Evaluate().invalidate(be);
+  const auto* x = be->get_lhs();
+  const auto c = static_cast<const Number*>(be->get_rhs())->get_val();
+  const auto k = log2(c);
+  if (k < 0) {
+    return be;
+  }
+  // Signed modulus takes the sign of the dividend. Anything else is a mask
+  // which is as wide as the constant it replaces. This preserves the width
+  // of the result, and both operators produce unsigned values.
+  const auto t = Evaluate().get_type(x);
+  if ((t == Bits::Type::REAL) || ((t == Bits::Type::SIGNED) && c.is_signed())) {
+    return be;
+  }
+  Bits mask(c.size(), 0);
+  for (auto i = 0; i < k; ++i) {
+    mask.set(i, true);
+  }
+
+  Evaluate().invalidate(be);
+  return new BinaryExpression(take(be, true), BinaryExpression::Op::AMP, new Number(mask, Number::Format::HEX));
+}
+
+Expression* StrengthReduce::reduce_pow(BinaryExpression* be) {
+  if (!be->get_lhs()->is(Node::Tag::number)) {
+    return be;
+  }
+  Evaluate().invalidate(be);
+  const auto b = static_cast<const Number*>(be->get_lhs())->get_val();
+  if (log2(b) != 1) {
+    return be;
+  }
+  // Powers are unsigned and as wide as their base, as is a shift of an
+  // unsigned one. Unlike arithmetic_pow(), the shift is well defined for
+  // exponents which don't fit in a word.
+  if (Evaluate().get_type(be->get_rhs()) == Bits::Type::REAL) {
+    return be;
+  }
+
+  Evaluate().invalidate(be);
+  return new BinaryExpression(new Number(Bits(b.size(), 1), Number::Format::HEX), BinaryExpression::Op::LLT, take(be, false));
+}
+
+int StrengthReduce::log2(const Bits& val) {
+  if (val.is_real()) {
+    return -1;
+  }
+  auto res = -1;
+  for (size_t i = 0, ie = val.size(); i < ie; ++i) {
+    if (!val.get(i)) {
+      continue;
+    }
+    if (res != -1) {
+      return -1;
+    }
+    res = static_cast<int>(i);
+  }
+  if (val.is_signed() && (res != -1) && (static_cast<size_t>(res) == val.size()-1)) {
+    return -1;
+  }
+  return res;
+}
+
+size_t StrengthReduce::self_width(const Expression* e) {
+  if (e->is(Node::Tag::number)) {
+    return static_cast<const Number*>(e)->get_val().size();
+  }
+  if (e->is(Node::Tag::identifier)) {
+    const auto* id = static_cast<const Identifier*>(e);
+    const auto* r = Resolve().get_resolution(id);
+    if ((r != nullptr) && (id->size_dim() == r->size_dim())) {
+      return Evaluate().get_width(r);
+    }
+  }
+  return 0;
+}
+
+bool StrengthReduce::is_assign_rhs(const BinaryExpression* be) {
+  const auto* p = be->get_parent();
+  if (p->is(Node::Tag::continuous_assign)) {
+    const auto* ca = static_cast<const ContinuousAssign*>(p);
+    return (ca->size_lhs() == 1) && (ca->get_rhs() == be);
+  }
+  if (p->is(Node::Tag::blocking_assign)) {
+    const auto* ba = static_cast<const BlockingAssign*>(p);
+    return (ba->size_lhs() == 1) && (ba->get_rhs() == be);
+  }
+  if (p->is(Node::Tag::nonblocking_assign)) {
+    const auto* na = static_cast<const NonblockingAssign*>(p);
+    return (na->size_lhs() == 1) && (na->get_rhs() == be);
+  }
+  return false;
+}
+
+Expression* StrengthReduce::take(BinaryExpression* be, bool lhs) {
+  if (lhs) {
+    auto* res = be->get_lhs();
+    be->set_lhs(new Identifier("ignore"));
+    return res;
+  }
+  auto* res = be->get_rhs();
+  be->set_rhs(new Identifier("ignore"));
+  return res;
+}
+
+} // namespace cascade
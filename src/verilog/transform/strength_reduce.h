@@ -0,0 +1,84 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_TRANSFORM_STRENGTH_REDUCE_H
+#define CASCADE_SRC_VERILOG_TRANSFORM_STRENGTH_REDUCE_H
+
+#include <stddef.h>
+#include "common/bits.h"
+#include "verilog/ast/ast_fwd.h"
+#include "verilog/ast/visitors/rewriter.h"
+
+namespace cascade {
+
+// This pass replaces arithmetic on power-of-two constants with cheaper
+// bitwise operators: x*2^k and 2^k*x become x<<k, x/2^k becomes x>>k, x%2^k
+// becomes x&(2^k-1), and 2**x becomes 1<<x. Every rewrite preserves the
+// self-determined width and sign of the original expression, so results are
+// bit-identical in any context. Signed division and modulus round towards
+// zero and are left alone, as are multiplies and divides whose constant is
+// wider than the other operand, unless they appear by themselves on the
+// right-hand side of an assignment, where the extra width is discarded.
+
+class StrengthReduce : public Rewriter {
+  public:
+    StrengthReduce();
+    ~StrengthReduce() override = default;
+
+    void run(ModuleDeclaration* md);
+
+  private:
+    // Rewriter Interface:
+    Attributes* rewrite(Attributes* as) override;
+    Expression* rewrite(BinaryExpression* be) override;
+    Statement* rewrite(DebugStatement* ds) override;
+
+    // Reduction Helpers:
+    Expression* reduce_times(BinaryExpression* be);
+    Expression* reduce_div(BinaryExpression* be);
+    Expression* reduce_mod(BinaryExpression* be);
+    Expression* reduce_pow(BinaryExpression* be);
+
+    // Returns log2 of val if val is a non-negative power of two, -1 otherwise.
+    static int log2(const Bits& val);
+    // Returns the self-determined width of an expression or zero if it can't
+    // be computed without evaluating the expression. Numbers must have been
+    // invalidated first.
+    static size_t self_width(const Expression* e);
+    // Returns true if be is the entire right-hand side of a single-target
+    // assignment.
+    static bool is_assign_rhs(const BinaryExpression* be);
+    // Detaches an operand from be and returns it.
+    static Expression* take(BinaryExpression* be, bool lhs);
+};
+
+} // namespace cascade
+
+#endif
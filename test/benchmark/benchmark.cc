@@ -33,6 +33,7 @@
 #include "cl/cl.h"
 #include "gtest/gtest.h"
 #include "harness.h"
+#include "verilog/transform/pass_manager.h"
 
 using namespace cascade;
 using namespace cascade::cl;
@@ -66,6 +67,14 @@ static void BM_Mips32(benchmark::State& state) {
 }
 BENCHMARK(BM_Mips32)->Unit(benchmark::kMillisecond);
 
+static void BM_Mips32_NoStrengthReduce(benchmark::State& state) {
+  const auto pipeline = PassManager::remove(PassManager::default_pipeline(), "strength_reduce");
+  for(auto _ : state) {
+    run_benchmark("data/test/benchmark/mips32/run_bubble_128_1024.v", pipeline, "1");
+  }
+}
+BENCHMARK(BM_Mips32_NoStrengthReduce)->Unit(benchmark::kMillisecond);
+
 static void BM_Regex(benchmark::State& state) {
   for(auto _ : state) {
     run_benchmark("data/test/benchmark/regex/run_disjunct_64.v", "27136");
@@ -79,3 +88,11 @@ static void BM_Nw(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_Nw)->Unit(benchmark::kMillisecond);
+
+static void BM_Nw_NoStrengthReduce(benchmark::State& state) {
+  const auto pipeline = PassManager::remove(PassManager::default_pipeline(), "strength_reduce");
+  for(auto _ : state) {
+    run_benchmark("data/test/benchmark/nw/run_8.v", pipeline, "-32768");
+  }
+}
+BENCHMARK(BM_Nw_NoStrengthReduce)->Unit(benchmark::kMillisecond);
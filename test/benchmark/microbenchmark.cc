@@ -28,10 +28,17 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <fstream>
+#include <sstream>
 #include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
 #include "benchmark/benchmark.h"
 #include "cascade/cascade.h"
 #include "cl/cl.h"
+#include "common/lz4.h"
+#include "common/sockstream.h"
 #include "common/system.h"
 #include "harness.h"
 #include "verilog/parse/parser.h"
@@ -154,3 +161,61 @@ static void BM_CodeArray(benchmark::State& state) {
 }
 
 BENCHMARK(BM_CodeArray)->Range(2,5)->Complexity();
+
+static void BM_Lz4(benchmark::State& state, string path) {
+  ifstream ifs(System::src_root() + "/" + path);
+  stringstream ss;
+  ss << ifs.rdbuf();
+  const auto src = ss.str();
+
+  vector<char> dst;
+  for(auto _ : state) {
+    Lz4::compress(src.data(), src.length(), dst);
+  }
+  state.SetBytesProcessed(state.iterations() * src.length());
+  state.counters["ratio"] = double(src.length()) / dst.size();
+}
+
+BENCHMARK_CAPTURE(BM_Lz4, lz4_bitcoin, "data/test/benchmark/bitcoin/sha256_transform.v");
+BENCHMARK_CAPTURE(BM_Lz4, lz4_mips32, "data/test/benchmark/mips32/mips32.v");
+
+static void BM_RoundTrip(benchmark::State& state, string path, size_t copies, uint32_t threshold) {
+  ifstream ifs(System::src_root() + "/" + path);
+  stringstream ss;
+  ss << ifs.rdbuf();
+  string msg;
+  for (size_t i = 0; i < copies; ++i) {
+    msg += ss.str();
+  }
+
+  int fds[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+  sockstream client(fds[0]);
+  sockstream server(fds[1]);
+  client.set_compression_threshold(threshold);
+  server.set_compression_threshold(threshold);
+
+  thread t([&server, &msg]{
+    string buf(msg.length(), '\0');
+    while (server.read(&buf[0], buf.length())) {
+      server.write(buf.data(), buf.length());
+      server.flush();
+    }
+  });
+  string res(msg.length(), '\0');
+  for (auto _ : state) {
+    client.write(msg.data(), msg.length());
+    client.flush();
+    client.read(&res[0], res.length());
+  }
+  ::shutdown(fds[0], SHUT_WR);
+  t.join();
+  state.SetBytesProcessed(2 * state.iterations() * msg.length());
+}
+
+BENCHMARK_CAPTURE(BM_RoundTrip, round_trip_mips32_raw, "data/test/benchmark/mips32/mips32.v", 1, 0);
+BENCHMARK_CAPTURE(BM_RoundTrip, round_trip_mips32_lz4, "data/test/benchmark/mips32/mips32.v", 1, 1);
+BENCHMARK_CAPTURE(BM_RoundTrip, round_trip_bitcoin_raw, "data/test/benchmark/bitcoin/sha256_transform.v", 1, 0);
+BENCHMARK_CAPTURE(BM_RoundTrip, round_trip_bitcoin_lz4, "data/test/benchmark/bitcoin/sha256_transform.v", 1, 1);
+BENCHMARK_CAPTURE(BM_RoundTrip, round_trip_state_raw, "data/test/benchmark/mips32/sum.hex", 128, 0);
+BENCHMARK_CAPTURE(BM_RoundTrip, round_trip_state_lz4, "data/test/benchmark/mips32/sum.hex", 128, 1);
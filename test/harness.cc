@@ -30,12 +30,23 @@
 
 #include "harness.h"
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
 #include <sstream>
-#include "cascade/cascade.h"
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
 #include "cl/cl.h"
+#include "common/log.h"
 #include "common/system.h"
 #include "gtest/gtest.h"
+#include "verilog/ast/ast.h"
 #include "verilog/parse/parser.h"
+#include "verilog/print/print.h"
+#include "verilog/transform/pass_manager.h"
 
 using namespace cascade;
 using namespace cascade::cl;
@@ -50,6 +61,67 @@ auto& quartus_host = StrArg<string>::create("--quartus_host")
 auto& quartus_port = StrArg<uint32_t>::create("--quartus_port")
   .initial(9900);
 
+// Appends everything written to it to a string which it doesn't own
+class Capture : public streambuf {
+  public:
+    explicit Capture(string* s) : streambuf() { 
+      s_ = s;
+    }
+    ~Capture() override = default;
+
+  private:
+    string* s_;
+
+    int_type overflow(int_type c) override {
+      if (c != traits_type::eof()) {
+        s_->push_back(traits_type::to_char_type(c));
+      }
+      return traits_type::not_eof(c);
+    }
+    streamsize xsputn(const char_type* s, streamsize count) override {
+      s_->append(s, count);
+      return count;
+    }
+};
+
+// A scratch directory which is created the first time it's needed, under
+// TMPDIR if it's set, and removed when the process exits
+class Scratch {
+  public:
+    Scratch() {
+      const auto* tmp = getenv("TMPDIR");
+      path_ = ((tmp != nullptr) && (*tmp != '\0')) ? tmp : "/tmp";
+      while ((path_.length() > 1) && (path_.back() == '/')) {
+        path_.pop_back();
+      }
+      path_ += "/cascade_test.XXXXXX";
+      EXPECT_NE(mkdtemp(&path_[0]), nullptr);
+    }
+    ~Scratch() {
+      System::execute("rm -rf " + path_);
+    }
+
+    const string& path() const {
+      return path_;
+    }
+
+  private:
+    string path_;
+};
+
+const string& scratch_dir() {
+  static Scratch s;
+  return s.path();
+}
+
+// Eval's march and path, and defines the macro which refers to the scratch
+// directory beforehand
+void eval(Cascade& c, const string& march, const string& path) {
+  c << "`define SCRATCH(NAME) \"" << scratch_dir() << "/NAME\"\n"
+    << "`include \"data/march/" << march << ".v\"\n"
+    << "`include \"" << path << "\"" << endl;
+}
+
 } // namespace
 
 namespace cascade {
@@ -69,57 +141,131 @@ void run_typecheck(const string& march, const string& path, bool expected) {
   c.set_include_dirs(System::src_root());
   c.run();
 
-  c << "`include \"data/march/" << march << ".v\"\n" 
-    << "`include \"" << path << "\"" << endl;
+  eval(c, march, path);
 
   c.stop_now();
   EXPECT_EQ(c.bad(), expected);
 }
 
-void run_code(const string& march, const string& path, const string& expected) {
-  auto* sb = new stringbuf();
+void run_code(const string& march, const string& path, const string& expected, const function<void(Cascade&)>& configure, const function<void(Cascade&)>& drive) {
+  string out;
 
   Cascade c;
   c.set_include_dirs(System::src_root());
-  c.set_stdout(sb);
+  c.set_stdout(capture(&out));
+  if (configure != nullptr) {
+    configure(c);
+  }
   c.run();
 
-  c << "`include \"data/march/" << march << ".v\"\n"
-    << "`include \"" << path << "\"" << endl;
+  eval(c, march, path);
 
   c.stop_now();
   ASSERT_FALSE(c.bad());
 
-  c.run();
-  c.wait_for_stop();
-  EXPECT_EQ(sb->str(), expected);
+  if (drive != nullptr) {
+    drive(c);
+  } else {
+    c.run();
+    c.wait_for_stop();
+  }
+  EXPECT_EQ(out, expected);
 }
 
 void run_concurrent(const string& march, const string& path, const string& expected) {
-  std::thread t1(run_code, march, path, expected);
-  std::thread t2(run_code, march, path, expected);
+  std::thread t1([&]{run_code(march, path, expected);});
+  std::thread t2([&]{run_code(march, path, expected);});
   t1.join();
   t2.join();
 }
 
+void run_transform(const string& path, const string& pipeline, const string& expected) {
+  auto* md = parse_module(path);
+  auto* res = parse_module(expected);
+  ASSERT_NE(md, nullptr);
+  ASSERT_NE(res, nullptr);
+
+  PassManager pm;
+  pm.set_pipeline(pipeline);
+  ASSERT_FALSE(pm.error());
+  pm.run(md);
+
+  // Compare against the expected module after printing both the same way
+  stringstream ss1;
+  ss1 << md;
+  stringstream ss2;
+  ss2 << res;
+  EXPECT_EQ(ss1.str(), ss2.str());
+
+  delete md;
+  delete res;
+}
+
+void run_driver(const string& args, int status, const string& expected) {
+  // The location of the driver is provided by the build
+  auto* p = popen((string(CASCADE_DRIVER) + " " + args + " < /dev/null 2>&1").c_str(), "r");
+  ASSERT_NE(p, nullptr);
+  string out;
+  for (int c = fgetc(p); c != EOF; c = fgetc(p)) {
+    out.push_back(c);
+  }
+  const auto res = pclose(p);
+
+  ASSERT_TRUE(WIFEXITED(res));
+  EXPECT_EQ(WEXITSTATUS(res), status);
+  EXPECT_NE(out.find(expected), string::npos);
+}
+
 void run_benchmark(const string& path, const string& expected) {
-  auto* sb = new stringbuf();
+  run_benchmark(path, PassManager::default_pipeline(), expected);
+}
 
-  Cascade c;
-  c.set_include_dirs(System::src_root());
-  c.set_stdout(sb);
-  c.set_quartus_server(::quartus_host.value(), ::quartus_port.value());
-  c.run();
+void run_benchmark(const string& path, const string& pipeline, const string& expected) {
+  run_code(::march.value(), path, expected, [&pipeline](Cascade& c) {
+    c.set_pass_pipeline(pipeline);
+    c.set_quartus_server(::quartus_host.value(), ::quartus_port.value());
+  });
+}
 
-  c << "`include \"data/march/" << ::march.value() << ".v\"\n" 
-    << "`include \"" << path << "\"" << endl;
+ModuleDeclaration* parse_module(istream& is) {
+  Log log;
+  Parser p(&log);
+  p.parse(is);
+  EXPECT_FALSE(log.error());
+  EXPECT_EQ(distance(p.begin(), p.end()), 1);
+  if (log.error() || (p.begin() == p.end()) || !(*p.begin())->is(Node::Tag::module_declaration)) {
+    for (auto* n : p) {
+      delete n;
+    }
+    return nullptr;
+  }
+  return static_cast<ModuleDeclaration*>(*p.begin());
+}
 
-  c.stop_now();
-  ASSERT_FALSE(c.bad());
+ModuleDeclaration* parse_module(const string& path) {
+  ifstream ifs(path);
+  EXPECT_TRUE(ifs.is_open());
+  return parse_module(ifs);
+}
 
-  c.run();
-  c.wait_for_stop();
-  EXPECT_EQ(sb->str(), expected);
+streambuf* capture(string* s) {
+  return new Capture(s);
+}
+
+string scratch_path(const string& name) {
+  return scratch_dir() + "/" + name;
+}
+
+bool wait_for_info(Cascade& c, const string& info, const string& s) {
+  for (auto i = 0; i < 100; ++i) {
+    c.run();
+    this_thread::sleep_for(chrono::milliseconds(100));
+    c.stop_now();
+    if (info.find(s) != string::npos) {
+      return true;
+    }
+  }
+  return false;
 }
 
 } // namespace cascade
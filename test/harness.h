@@ -31,15 +31,42 @@
 #ifndef CASCADE_TEST_HARNESS_H
 #define CASCADE_TEST_HARNESS_H
 
+#include <functional>
+#include <iosfwd>
+#include <streambuf>
 #include <string>
+#include "cascade/cascade.h"
+#include "verilog/ast/ast_fwd.h"
 
 namespace cascade {
 
 void run_parse(const std::string& path, bool expected);
 void run_typecheck(const std::string& march, const std::string& path, bool expected);
-void run_code(const std::string& march, const std::string& path, const std::string& expected);
+// Runs path on march and checks what it prints. configure is invoked before
+// the runtime starts. If drive is provided, it takes over once the program
+// has been eval'ed (with the runtime stopped), and should leave the runtime
+// stopped. Otherwise the program is run until it finishes.
+void run_code(const std::string& march, const std::string& path, const std::string& expected, const std::function<void(Cascade&)>& configure = nullptr, const std::function<void(Cascade&)>& drive = nullptr);
 void run_concurrent(const std::string& march, const std::string& path, const std::string& expected);
+void run_transform(const std::string& path, const std::string& pipeline, const std::string& expected);
+void run_driver(const std::string& args, int status, const std::string& expected);
 void run_benchmark(const std::string& path, const std::string& expected);
+void run_benchmark(const std::string& path, const std::string& pipeline, const std::string& expected);
+
+// Parses a stream or a file which contains a single module declaration.
+// Returns nullptr on failure.
+ModuleDeclaration* parse_module(std::istream& is);
+ModuleDeclaration* parse_module(const std::string& path);
+// Returns a stream buffer which appends everything written to it to s. The
+// buffer belongs to whoever it's handed to, but s must outlive it.
+std::streambuf* capture(std::string* s);
+// Returns a path inside a scratch directory which is unique to this process.
+// Verilog code can refer to the same path as `SCRATCH(name).
+std::string scratch_path(const std::string& name);
+// Runs c in short bursts until info contains s, or ten seconds have passed.
+// c should be stopped beforehand, and is stopped afterwards, so info is never
+// read while the runtime might be writing to it.
+bool wait_for_info(Cascade& c, const std::string& info, const std::string& s);
 
 } // namespace cascade
 
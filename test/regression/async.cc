@@ -0,0 +1,55 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "harness.h"
+
+using namespace cascade;
+
+TEST(async, pipeline_1) {
+  run_code("minimal", "data/test/regression/simple/pipeline_1.v", "0123456789", [](Cascade& c) {
+    c.set_async_fast_pass(true);
+  });
+}
+TEST(async, io) {
+  run_code("minimal", "data/test/regression/simple/io_1.v", "1234512345", [](Cascade& c) {
+    c.set_async_fast_pass(true);
+  });
+}
+TEST(async, bitcoin) {
+  run_code("minimal", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n", [](Cascade& c) {
+    c.set_async_fast_pass(true);
+  });
+}
+TEST(async, jit_initial) {
+  run_code("minimal_jit_3", "data/test/regression/jit/initial.v", "once", [](Cascade& c) {
+    c.set_async_fast_pass(true);
+  });
+}
@@ -0,0 +1,77 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+#include "common/system.h"
+#include "gtest/gtest.h"
+#include "harness.h"
+#include "verilog/transform/pass_manager.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Runs three times: once against an empty cache, once against a warm one,
+// and once more with a different pipeline. Only the warm run should skip the
+// IR pipeline. The cache is placed in a nested directory which doesn't exist
+// yet to check that it's created.
+void run_cached(const string& march, const string& path, const string& expected) {
+  const auto root = scratch_path("ir_cache");
+  System::execute("rm -rf " + root);
+  for (auto i = 0; i < 3; ++i) {
+    string info;
+    run_code(march, path, expected, [&](Cascade& c) {
+      c.set_cache_path(root + "/nested/dir");
+      c.set_pass_stats(true);
+      if (i == 2) {
+        c.set_pass_pipeline(PassManager::remove(PassManager::default_pipeline(), "block_flatten"));
+      }
+      c.set_stdinfo(capture(&info));
+    });
+    const auto hit = info.find("IR pipeline statistics") == string::npos;
+    EXPECT_EQ(hit, i == 1);
+  }
+}
+
+} // namespace
+
+TEST(cache, pipeline_1) {
+  run_cached("minimal", "data/test/regression/simple/pipeline_1.v", "0123456789");
+}
+TEST(cache, bitcoin) {
+  run_cached("minimal", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n");
+}
+TEST(cache, jit_initial) {
+  run_cached("minimal_jit_3", "data/test/regression/jit/initial.v", "once");
+}
+TEST(cache, jit_mips32) {
+  run_cached("minimal_jit_3", "data/test/benchmark/mips32/run_bubble_128.v", "1");
+}
@@ -0,0 +1,153 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "common/thread_pool.h"
+#include "gtest/gtest.h"
+#include "harness.h"
+#include "runtime/compile_queue.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Runs a compile queue with a single slot, which is held by a request that
+// doesn't finish until it's released. Everything inserted in the meantime
+// waits, and the order in which those requests run is recorded.
+class Blocked {
+  public:
+    Blocked() : queue_(&pool_) {
+      pool_.set_num_threads(1);
+      pool_.run();
+      queue_.set_max_active(1);
+      release_ = false;
+      aborts_ = 0;
+      queue_.insert(this, 0, "sw", 1, 0, [this]{
+        unique_lock<mutex> ul(lock_);
+        cv_.wait(ul, [this]{return release_;});
+        order_.push_back(0);
+        cv_.notify_all();
+      }, []{});
+    }
+    ~Blocked() {
+      pool_.stop_now();
+    }
+
+    void insert(const void* owner, uint64_t key, uint64_t cost, uint64_t priority, int tag) {
+      queue_.insert(owner, key, "sw", cost, priority, [this, tag]{
+        lock_guard<mutex> lg(lock_);
+        order_.push_back(tag);
+        cv_.notify_all();
+      }, [this]{
+        lock_guard<mutex> lg(lock_);
+        ++aborts_;
+      });
+    }
+    vector<int> drain(size_t n) {
+      unique_lock<mutex> ul(lock_);
+      release_ = true;
+      cv_.notify_all();
+      cv_.wait(ul, [this, n]{return order_.size() == n;});
+      return order_;
+    }
+
+    CompileQueue* queue() {
+      return &queue_;
+    }
+    size_t aborts() {
+      lock_guard<mutex> lg(lock_);
+      return aborts_;
+    }
+
+  private:
+    ThreadPool pool_;
+    CompileQueue queue_;
+
+    mutex lock_;
+    condition_variable cv_;
+    bool release_;
+    vector<int> order_;
+    size_t aborts_;
+};
+
+} // namespace
+
+TEST(compile_queue, priority) {
+  Blocked b;
+  const int o1 = 0, o2 = 0, o3 = 0;
+  b.insert(&o1, 1, 10, 1, 1);
+  b.insert(&o2, 2, 10, 5, 2);
+  b.insert(&o3, 3, 5, 5, 3);
+  EXPECT_EQ(b.queue()->pending(), 3u);
+  EXPECT_EQ(b.queue()->active(), 1u);
+
+  // Hottest first, then cheapest, then oldest
+  EXPECT_EQ(b.drain(4), vector<int>({0, 3, 2, 1}));
+  EXPECT_EQ(b.aborts(), 0u);
+}
+
+TEST(compile_queue, dedup) {
+  Blocked b;
+  const int o1 = 0, o2 = 0, o3 = 0;
+  b.insert(&o1, 1, 10, 1, 1);
+  b.insert(&o2, 2, 10, 5, 2);
+  b.insert(&o3, 3, 5, 1, 3);
+  // Replaces the first request and inherits its higher priority, which puts
+  // it ahead of the third. A request with a different key or owner is a new
+  // request.
+  b.insert(&o1, 1, 1, 0, 4);
+  b.insert(&o1, 5, 1, 0, 5);
+  b.insert(&o2, 1, 1, 0, 6);
+  EXPECT_EQ(b.queue()->pending(), 5u);
+  EXPECT_EQ(b.aborts(), 1u);
+
+  EXPECT_EQ(b.drain(6), vector<int>({0, 2, 4, 3, 5, 6}));
+  EXPECT_EQ(b.aborts(), 1u);
+}
+
+TEST(compile_queue, cancel) {
+  Blocked b;
+  const int o1 = 0, o2 = 0;
+  b.insert(&o1, 1, 1, 0, 1);
+  b.insert(&o2, 2, 1, 0, 2);
+  b.insert(&o1, 3, 1, 0, 3);
+  b.queue()->cancel(&o1);
+  EXPECT_EQ(b.queue()->pending(), 1u);
+  EXPECT_EQ(b.aborts(), 2u);
+
+  EXPECT_EQ(b.drain(2), vector<int>({0, 2}));
+}
+
+TEST(compile_queue, debug) {
+  run_code("minimal", "data/test/regression/simple/debug_queue.v", "Compile queue: 0 waiting, 0 running, ETA 0ms\n");
+}
@@ -0,0 +1,98 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <string>
+#include "gtest/gtest.h"
+#include "harness.h"
+
+using namespace cascade;
+using namespace std;
+
+TEST(inline, array) {
+  run_code("minimal", "data/test/benchmark/array/run_5.v", "1048577\n", [](Cascade& c) {
+    c.set_inline_budget(64);
+  });
+}
+TEST(inline, bitcoin) {
+  run_code("minimal", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n", [](Cascade& c) {
+    c.set_inline_budget(256);
+  });
+}
+TEST(inline, mips32) {
+  run_code("minimal", "data/test/benchmark/mips32/run_bubble_128.v", "1", [](Cascade& c) {
+    c.set_inline_budget(1024);
+  });
+}
+TEST(inline, nw) {
+  run_code("minimal", "data/test/benchmark/nw/run_4.v", "-1126", [](Cascade& c) {
+    c.set_inline_budget(256);
+  });
+}
+TEST(inline, regex) {
+  run_code("minimal", "data/test/benchmark/regex/run_disjunct_1.v", "424", [](Cascade& c) {
+    c.set_inline_budget(256);
+  });
+}
+// Modules which are compiled on their own, and inlining or outlining which
+// takes place while the program runs, are reported on the info stream.
+TEST(inline, outline) {
+  string info;
+  run_code("minimal", "data/test/regression/jit/outline.v", "1", [&info](Cascade& c) {
+    c.set_inline_budget(0);
+    c.set_inline_threshold(0);
+    c.set_stdinfo(capture(&info));
+  });
+  EXPECT_NE(info.find("Outlined root.c"), string::npos);
+  EXPECT_NE(info.find("Inlined root.c"), string::npos);
+}
+TEST(inline, budget) {
+  string info;
+  run_code("minimal", "data/test/regression/jit/budget.v", "1", [&info](Cascade& c) {
+    c.set_inline_budget(150);
+    c.set_inline_threshold(0);
+    c.set_stdinfo(capture(&info));
+  });
+  EXPECT_NE(info.find("recompilation of root.l "), string::npos);
+  EXPECT_EQ(info.find("recompilation of root.s1 "), string::npos);
+  EXPECT_EQ(info.find("recompilation of root.s2 "), string::npos);
+  EXPECT_EQ(info.find("Inlined"), string::npos);
+}
+TEST(inline, threshold) {
+  string info;
+  run_code("minimal", "data/test/regression/jit/budget.v", "1", [&info](Cascade& c) {
+    c.set_inline_budget(150);
+    c.set_inline_threshold(1);
+    c.set_stdinfo(capture(&info));
+  });
+  EXPECT_NE(info.find("recompilation of root.l "), string::npos);
+  EXPECT_NE(info.find("Inlined root.l"), string::npos);
+  EXPECT_EQ(info.find("recompilation of root.s1 "), string::npos);
+  EXPECT_EQ(info.find("recompilation of root.s2 "), string::npos);
+}
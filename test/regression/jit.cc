@@ -28,10 +28,13 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <sstream>
+#include <string>
 #include "gtest/gtest.h"
 #include "harness.h"
 
 using namespace cascade;
+using namespace std;
 
 TEST(jit, initial) {
   run_code("minimal_jit", "data/test/regression/jit/initial.v", "once");
@@ -48,6 +51,9 @@ TEST(jit, array) {
 TEST(jit, bitcoin) {
   run_code("minimal_jit", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n");
 }
+TEST(jit, mem) {
+  run_code("minimal_jit", "data/test/regression/simple/mem_5.v", "00000002 000007d1 0beb9af0");
+}
 TEST(jit, mips32) {
   run_code("minimal_jit", "data/test/benchmark/mips32/run_bubble_128.v", "1");
 }
@@ -57,3 +63,79 @@ TEST(jit, nw) {
 TEST(jit, regex) {
   run_code("minimal_jit", "data/test/benchmark/regex/run_disjunct_1.v", "424");
 }
+TEST(jit, cold) {
+  // Later tiers are only compiled once a module has run for 100ms. Modules
+  // which never get hot stay on their first tier.
+  string info;
+  run_code("minimal_jit", "data/test/regression/jit/initial.v", "once", [&info](Cascade& c) {
+    c.set_promotion_threshold(100);
+    c.set_stdinfo(capture(&info));
+  });
+  EXPECT_EQ(info.find("tier-"), string::npos);
+}
+TEST(jit, undo) {
+  // The slow-pass tiers of minimal_jit_delay are delayed, so that they're
+  // still in flight when the program is retargeted away from it.
+  string info;
+  run_code("minimal_jit_delay", "data/test/regression/jit/undo.v", "once", [&info](Cascade& c) {
+    c.set_speculative_cache_size(4);
+    c.set_stdinfo(capture(&info));
+  }, [&info](Cascade& c) {
+    // Retarget away and wait for the results of the slow-pass compilations
+    // that were in flight to arrive and be retained.
+    c.run();
+    c << "initial $retarget(\"minimal\");" << endl;
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+    EXPECT_TRUE(wait_for_info(c, info, "Retained tier-1 recompilation of root "));
+
+    // Undo the retarget. The original source should reappear, and its
+    // slow-pass results should be reused rather than recompiled.
+    c.run();
+    c << "initial $retarget(\"minimal_jit_delay\");" << endl;
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+    EXPECT_TRUE(wait_for_info(c, info, "Finished tier-1 recompilation of root from speculative cache"));
+  });
+}
+
+TEST(jit_3, initial) {
+  run_code("minimal_jit_3", "data/test/regression/jit/initial.v", "once");
+}
+TEST(jit_3, bitcoin) {
+  run_code("minimal_jit_3", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n");
+}
+TEST(jit_3, mips32) {
+  run_code("minimal_jit_3", "data/test/benchmark/mips32/run_bubble_128.v", "1");
+}
+TEST(jit_3, deopt) {
+  string info;
+  run_code("minimal_jit_3", "data/test/regression/jit/deopt.v", "oncedone", [&info](Cascade& c) {
+    c.set_stdinfo(capture(&info));
+  });
+
+  // root.c1 must have been promoted first, and moved back to software
+  // afterwards. Its sibling must have been promoted and never moved back.
+  int deopt_promoted = -1;
+  int deopt_restored = -1;
+  auto keep_promoted = false;
+  auto keep_restored = false;
+  stringstream ss(info);
+  string line;
+  for (auto i = 0; getline(ss, line); ++i) {
+    const auto finished = line.find("Finished ") == 0;
+    const auto tier = line.find("Finished tier-") == 0;
+    if (tier && (deopt_promoted == -1) && (line.find("recompilation of root.c1 ") != string::npos)) {
+      deopt_promoted = i;
+    }
+    if (finished && (line.find("deoptimization of root.c1 ") != string::npos)) {
+      deopt_restored = i;
+    }
+    keep_promoted |= tier && (line.find("recompilation of root.c2 ") != string::npos);
+    keep_restored |= (line.find("deoptimization of root.c2 ") != string::npos);
+  }
+  EXPECT_NE(deopt_promoted, -1);
+  EXPECT_GT(deopt_restored, deopt_promoted);
+  EXPECT_TRUE(keep_promoted);
+  EXPECT_FALSE(keep_restored);
+}
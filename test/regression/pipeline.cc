@@ -0,0 +1,200 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "harness.h"
+#include "verilog/ast/ast.h"
+#include "verilog/transform/pass_manager.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Replaces the default pass pipeline
+function<void(Cascade&)> pipeline(const string& p) {
+  return [p](Cascade& c) {
+    c.set_pass_pipeline(p);
+  };
+}
+
+// Checks that an invalid pipeline is reported, and that the runtime finishes
+// before running any code
+void run_bad_pipeline(const string& p, const string& expected) {
+  string err;
+  run_code("minimal", "data/test/regression/simple/pipeline_1.v", "", [&p, &err](Cascade& c) {
+    c.set_pass_pipeline(p);
+    c.set_stderr(capture(&err));
+  }, [](Cascade& c) {
+    c.run();
+    c.wait_for_stop();
+    EXPECT_TRUE(c.is_finished());
+  });
+  EXPECT_NE(err.find(expected), string::npos);
+}
+
+} // namespace
+
+TEST(pipeline, fixpoint) {
+  run_code("minimal", "data/test/regression/simple/pipeline_1.v", "0123456789", pipeline("assign_unpack,index_normalize,loop_unroll,(de_alias,constant_prop)*,event_expand,control_merge,dead_code_eliminate*,block_flatten"));
+}
+TEST(pipeline, bitcoin) {
+  run_code("minimal", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n", pipeline("assign_unpack,index_normalize,loop_unroll,(de_alias,constant_prop,dead_code_eliminate)*,event_expand,control_merge,block_flatten"));
+}
+TEST(pipeline, jit_initial) {
+  run_code("minimal_jit_3", "data/test/regression/jit/initial.v", "once", pipeline("sw=(assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten)*"));
+}
+TEST(pipeline, array_no_cse) {
+  run_code("minimal", "data/test/benchmark/array/run_2.v", "257\n", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, array_cse) {
+  run_code("minimal", "data/test/benchmark/array/run_2.v", "257\n", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten,common_subexpression_eliminate*"));
+}
+TEST(pipeline, bitcoin_known_bits) {
+  run_code("minimal", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n", pipeline("assign_unpack,index_normalize,loop_unroll,(de_alias,constant_prop,known_bits_prop,dead_code_eliminate)*,event_expand,control_merge,block_flatten"));
+}
+TEST(pipeline, array_known_bits) {
+  run_code("minimal", "data/test/benchmark/array/run_2.v", "257\n", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,known_bits_prop*,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, dead_state) {
+  run_code("minimal", "data/test/regression/simple/pipeline_3.v", "16", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_state_eliminate,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, write_back_dead_state) {
+  ofstream ofs(scratch_path("pipeline_8.dat"), ios_base::binary);
+  const string zeros(16, '\0');
+  ofs.write(zeros.c_str(), zeros.length());
+  ofs.close();
+  run_code("minimal", "data/test/regression/simple/pipeline_8.v", "done", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_state_eliminate,dead_code_eliminate,block_flatten"));
+
+  // Memories which are written back are observable even if nothing reads them
+  ifstream ifs(scratch_path("pipeline_8.dat"), ios_base::binary);
+  uint32_t val = 0;
+  ifs.seekg(4);
+  ifs.read(reinterpret_cast<char*>(&val), 4);
+  EXPECT_EQ(val, 0xcafeu);
+}
+TEST(pipeline, batch_dead_state) {
+  string info;
+  run_code("minimal", "data/test/regression/simple/pipeline_3.v", "16", [&info](Cascade& c) {
+    c.set_batch_mode(true);
+    c.set_enable_debug(false);
+    c.set_pass_stats(true);
+    c.set_stdinfo(capture(&info));
+  });
+  // Dead state is only eliminated when debugging is disabled
+  EXPECT_NE(info.find("dead_state_eliminate"), string::npos);
+}
+TEST(pipeline, batch_enable_debug) {
+  string info;
+  run_code("minimal", "data/test/regression/simple/pipeline_3.v", "16", [&info](Cascade& c) {
+    c.set_batch_mode(true);
+    c.set_enable_debug(true);
+    c.set_pass_stats(true);
+    c.set_stdinfo(capture(&info));
+  });
+  // Dead state is only eliminated when debugging is disabled
+  EXPECT_EQ(info.find("dead_state_eliminate"), string::npos);
+}
+TEST(pipeline, bitcoin_dead_state) {
+  run_code("minimal", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n", pipeline("assign_unpack,index_normalize,loop_unroll,(de_alias,constant_prop,dead_state_eliminate,dead_code_eliminate)*,event_expand,control_merge,block_flatten"));
+}
+TEST(pipeline, nw_dead_state) {
+  run_code("minimal", "data/test/benchmark/nw/run_4.v", "-1126", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_state_eliminate,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, no_strength_reduce) {
+  run_code("minimal", "data/test/regression/simple/pipeline_4.v", "24 24 00000324 19 00000001 01 -14 920 -3 -5 00000020 0324 ffe4 2", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, strength_reduce) {
+  run_code("minimal", "data/test/regression/simple/pipeline_4.v", "24 24 00000324 19 00000001 01 -14 920 -3 -5 00000020 0324 ffe4 2", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,strength_reduce,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, mips32_strength_reduce) {
+  run_code("minimal", "data/test/benchmark/mips32/run_bubble_128.v", "1", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,strength_reduce,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, nw_strength_reduce) {
+  run_code("minimal", "data/test/benchmark/nw/run_4.v", "-1126", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,strength_reduce,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, unknown_pass) {
+  run_bad_pipeline("assign_unpack,not_a_pass,block_flatten", "Unknown pass 'not_a_pass'");
+}
+TEST(pipeline, malformed_group) {
+  run_bad_pipeline("assign_unpack,(constant_prop,dead_code_eliminate", "Unrecognized pass pipeline");
+}
+TEST(pipeline, unknown_target_pass) {
+  run_bad_pipeline("sw=assign_unpack,not_a_pass", "Unknown pass 'not_a_pass'");
+}
+TEST(pipeline, capped) {
+  // Common subexpression elimination settles after its second run. A group
+  // which is cut off before then is reported.
+  for (auto n : {1, 8}) {
+    auto* md = parse_module("data/test/regression/transform/cse_1.v");
+    ASSERT_NE(md, nullptr);
+    PassManager pm;
+    pm.set_pipeline("common_subexpression_eliminate*").set_max_iterations(n);
+    ASSERT_FALSE(pm.error());
+    pm.run(md);
+    EXPECT_EQ(pm.capped(), (n == 1) ? vector<string>{"(common_subexpression_eliminate)*"} : vector<string>());
+    delete md;
+  }
+}
+TEST(pipeline, driver) {
+  run_driver("--pass_pipeline assign_unpack,constant_prop,block_flatten --disable_repl -e data/test/regression/simple/pipeline_1.v", 0, "0123456789");
+}
+TEST(pipeline, driver_unknown_pass) {
+  run_driver("--pass_pipeline assign_unpack,not_a_pass --disable_repl -e data/test/regression/simple/pipeline_1.v", 1, "Unknown pass 'not_a_pass'");
+}
+TEST(pipeline, no_known_bits) {
+  run_code("minimal", "data/test/regression/simple/pipeline_5.v", "00 100 ff 00 23 d0 5a 1110", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, known_bits) {
+  run_code("minimal", "data/test/regression/simple/pipeline_5.v", "00 100 ff 00 23 d0 5a 1110", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,known_bits_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, no_known_bits_context) {
+  run_code("minimal", "data/test/regression/simple/pipeline_7.v", "f f d 8 e e", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, known_bits_context) {
+  run_code("minimal", "data/test/regression/simple/pipeline_7.v", "f f d 8 e e", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,known_bits_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, known_bits_ir) {
+  run_transform("data/test/regression/transform/known_bits_1.v", "known_bits_prop", "data/test/regression/transform/known_bits_1_ir.v");
+}
+TEST(pipeline, cse_ir) {
+  run_transform("data/test/regression/transform/cse_1.v", "common_subexpression_eliminate", "data/test/regression/transform/cse_1_ir.v");
+}
+TEST(pipeline, no_cse_nonblocking) {
+  run_code("minimal", "data/test/regression/simple/pipeline_6.v", "0f 0d 00 0f", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten"));
+}
+TEST(pipeline, cse_nonblocking) {
+  run_code("minimal", "data/test/regression/simple/pipeline_6.v", "0f 0d 00 0f", pipeline("assign_unpack,index_normalize,loop_unroll,de_alias,constant_prop,event_expand,control_merge,dead_code_eliminate,block_flatten,common_subexpression_eliminate"));
+}
@@ -0,0 +1,138 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "common/system.h"
+#include "gtest/gtest.h"
+#include "harness.h"
+#include "verilog/ast/ast.h"
+#include "verilog/print/print.h"
+#include "verilog/transform/pass_manager.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Modules which are compiled on their own are transformed in parallel. Run
+// once with the IR cache enabled, and then check each entry against the
+// result of running the same pipeline serially on the source it was keyed
+// on. Entries are a version and tier followed by the length-prefixed source
+// and IR, and the source begins with a comment that names the pipeline.
+void run_parallel(const string& march, const string& path, const string& expected) {
+  const auto cache = scratch_path("ir_parallel");
+  System::execute("rm -rf " + cache);
+  run_code(march, path, expected, [&cache](Cascade& c) {
+    c.set_cache_path(cache);
+  });
+
+  auto* dir = opendir(cache.c_str());
+  ASSERT_NE(dir, nullptr);
+  size_t n = 0;
+  for (auto* e = readdir(dir); e != nullptr; e = readdir(dir)) {
+    const string name = e->d_name;
+    if ((name.length() < 2) || (name.substr(name.length()-2) != ".v")) {
+      continue;
+    }
+    ifstream ifs(cache + "/" + name, ios::binary);
+    size_t v = 0;
+    size_t t = 0;
+    size_t sn = 0;
+    size_t im = 0;
+    ifs >> v >> t >> sn >> im;
+    ifs.get();
+    string src(sn, ' ');
+    string ir(im, ' ');
+    ifs.read(&src[0], sn);
+    ifs.read(&ir[0], im);
+    EXPECT_FALSE(ifs.fail()) << name;
+    if (ifs.fail()) {
+      continue;
+    }
+
+    stringstream ss(src);
+    auto* md = parse_module(ss);
+    EXPECT_NE(md, nullptr) << name;
+    if (md == nullptr) {
+      continue;
+    }
+
+    PassManager pm;
+    pm.set_pipeline(src.substr(3, src.find('\n')-3));
+    EXPECT_FALSE(pm.error()) << name;
+    pm.run(md);
+
+    stringstream res;
+    res << md;
+    EXPECT_EQ(res.str(), ir) << name;
+    delete md;
+    ++n;
+  }
+  closedir(dir);
+  EXPECT_GT(n, 1u);
+}
+
+} // namespace
+
+TEST(rebuild, unchanged) {
+  // The second file only changes the isolated source of root. root.c should
+  // keep the engine it was built with the first time around.
+  string info;
+  run_code("minimal", "data/test/regression/rebuild/unchanged_1.v", "done", [&info](Cascade& c) {
+    c.set_stdinfo(capture(&info));
+  }, [](Cascade& c) {
+    c.run();
+    c << "`include \"data/test/regression/rebuild/unchanged_2.v\"" << endl;
+    c.stop_now();
+    ASSERT_FALSE(c.bad());
+    c.run();
+    c.wait_for_stop();
+  });
+
+  size_t unchanged = 0;
+  size_t changed = 0;
+  stringstream ss(info);
+  string line;
+  while (getline(ss, line)) {
+    unchanged += (line.find("fast-pass recompilation of root.c ") != string::npos) ? 1 : 0;
+    changed += (line.find("fast-pass recompilation of root ") != string::npos) ? 1 : 0;
+  }
+  EXPECT_EQ(unchanged, 1u);
+  EXPECT_GE(changed, 2u);
+}
+TEST(rebuild, parallel_pipeline) {
+  run_parallel("minimal_no_inline", "data/test/regression/simple/pipeline_1.v", "0123456789");
+}
+TEST(rebuild, parallel_mips32) {
+  run_parallel("minimal_no_inline", "data/test/benchmark/mips32/run_bubble_128.v", "1");
+}
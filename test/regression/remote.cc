@@ -28,6 +28,9 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <fstream>
+#include <sstream>
+#include <string>
 #include "cascade/cascade_slave.h"
 #include "gtest/gtest.h"
 #include "harness.h"
@@ -40,6 +43,9 @@ int main(int argc, char** argv) {
   CascadeSlave slave;
   slave.set_listeners("/tmp/fpga_socket", 8800);
   slave.run();
+  CascadeSlave slave2;
+  slave2.set_listeners("/tmp/fpga_socket_2", 8801);
+  slave2.run();
 
   return RUN_ALL_TESTS();
 }
@@ -56,6 +62,17 @@ TEST(one_to_one, pipeline_2) {
 TEST(one_to_one, io) {
   run_code("minimal_remote", "data/test/regression/simple/io_1.v", "1234512345");
 }
+TEST(one_to_one, io_seek) {
+  run_code("minimal_remote", "data/test/regression/simple/io_5.v", "00000001 00000002 00000009 00000004");
+}
+TEST(one_to_one, io_memory) {
+  std::ofstream ofs(scratch_path("io_6.dat"));
+  for (size_t i = 0; i < 65536; ++i) {
+    ofs << std::hex << (i % 251) << std::endl;
+  }
+  ofs.close();
+  run_code("minimal_remote", "data/test/regression/simple/io_6.v", "00 01 4f 50 17 ");
+}
 TEST(one_to_one, bitcoin) {
   run_code("minimal_remote", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n");
 }
@@ -66,6 +83,18 @@ TEST(one_to_one, regex) {
   run_code("minimal_remote", "data/test/benchmark/regex/run_disjunct_1.v", "424");
 }
 
+TEST(pooled, bubble) {
+  run_code("minimal_remote_no_inline", "data/test/benchmark/mips32/run_bubble_128.v", "1");
+}
+TEST(pooled, async) {
+  run_code("minimal_remote_no_inline", "data/test/benchmark/bitcoin/run_4.v", "0000000f 00000093\n", [](Cascade& c) {
+    c.set_async_fast_pass(true);
+  });
+}
+TEST(pooled, concurrent) {
+  run_concurrent("minimal_remote_no_inline", "data/test/benchmark/mips32/run_bubble_128.v", "1");
+}
+
 TEST(many_to_one, bitcoin) {
   run_concurrent("minimal_concurrent", "data/test/benchmark/bitcoin/run_12.v", "00001314 00001398\n");
 }
@@ -75,3 +104,23 @@ TEST(many_to_one, regex) {
 TEST(many_to_one, array) {
   run_concurrent("minimal_concurrent", "data/test/benchmark/array/run_5.v", "1048577\n");
 }
+
+TEST(migrate, counter) {
+  // At least one engine must be rebuilt at its new location and swapped in
+  // before the program finishes
+  std::string info;
+  run_code("minimal_remote", "data/test/regression/remote/migrate.v", "16384 134209536", [&info](Cascade& c) {
+    c.set_stdinfo(capture(&info));
+  }, [](Cascade& c) {
+    c.run();
+    c.migrate("/tmp/fpga_socket", "127.0.0.1:8801");
+    c.wait_for_stop();
+  });
+  auto moved = false;
+  std::stringstream ss(info);
+  std::string line;
+  while (std::getline(ss, line)) {
+    moved |= (line.find("Finished migration of ") == 0) && (line.find("127.0.0.1:8801") != std::string::npos);
+  }
+  EXPECT_TRUE(moved);
+}
@@ -28,6 +28,7 @@
 // OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#include <fstream>
 #include "gtest/gtest.h"
 #include "harness.h"
 
@@ -114,6 +115,9 @@ TEST(simple, case_2) {
 TEST(simple, case_3) {
   run_code("minimal","data/test/regression/simple/case_3.v", "123");
 }
+TEST(simple, case_4) {
+  run_code("minimal","data/test/regression/simple/case_4.v", "a.b1a.c3d.d.e.e.");
+}
 TEST(simple, concat_1) {
   run_code("minimal","data/test/regression/simple/concat_1.v", "170");
 }
@@ -144,6 +148,9 @@ TEST(simple, for_1) {
 TEST(simple, for_2) {
   run_code("minimal","data/test/regression/simple/for_2.v", "012458");
 }
+TEST(simple, for_3) {
+  run_code("minimal","data/test/regression/simple/for_3.v", "704982704");
+}
 TEST(simple, generate_1) {
   run_code("minimal","data/test/regression/simple/generate_1.v", "01234567");
 }
@@ -192,6 +199,9 @@ TEST(simple, io_3) {
 TEST(simple, io_4) {
   run_code("minimal","data/test/regression/simple/io_4.v", "32 65535 -1");
 }
+TEST(simple, io_5) {
+  run_code("minimal","data/test/regression/simple/io_5.v", "00000001 00000002 00000009 00000004");
+}
 TEST(simple, issue_20a) {
   run_code("minimal","data/test/regression/simple/issue_20a.v", "");
 }
@@ -267,6 +277,46 @@ TEST(simple, mem_1) {
 TEST(simple, mem_2) {
   run_code("minimal","data/test/regression/simple/mem_2.v", "0001020304050607");
 }
+TEST(simple, mem_3) {
+  run_code("minimal","data/test/regression/simple/mem_3.v", "8648704");
+}
+TEST(simple, mem_4) {
+  run_code("minimal","data/test/regression/simple/mem_4.v", "1129");
+}
+TEST(simple, mem_5) {
+  run_code("minimal","data/test/regression/simple/mem_5.v", "00000002 000007d1 0beb9af0");
+}
+TEST(simple, mem_6) {
+  std::ofstream ofs(scratch_path("mem_6.dat"), std::ios_base::binary);
+  for (uint32_t i = 0; i < (1 << 20); ++i) {
+    ofs.write(reinterpret_cast<const char*>(&i), 4);
+  }
+  ofs.close();
+  run_code("minimal","data/test/regression/simple/mem_6.v", "00000000 00010000 000fffff");
+
+  std::ifstream ifs(scratch_path("mem_6.dat"), std::ios_base::binary);
+  uint32_t val = 0;
+  ifs.seekg(4);
+  ifs.read(reinterpret_cast<char*>(&val), 4);
+  EXPECT_EQ(val, 0xcafeu);
+}
+TEST(simple, mem_7) {
+  std::ofstream ofs(scratch_path("mem_7.dat"), std::ios_base::binary);
+  for (uint16_t i = 0; i < 8; ++i) {
+    const uint16_t val = 0xf123 + i;
+    ofs.write(reinterpret_cast<const char*>(&val), 2);
+  }
+  ofs.close();
+  run_code("minimal","data/test/regression/simple/mem_7.v", "123 124");
+
+  // Writing back replaces the whole image
+  std::ifstream ifs(scratch_path("mem_7.dat"), std::ios_base::binary | std::ios_base::ate);
+  EXPECT_EQ(ifs.tellg(), 8);
+  uint16_t val = 0;
+  ifs.seekg(4);
+  ifs.read(reinterpret_cast<char*>(&val), 2);
+  EXPECT_EQ(val, 0xabcu);
+}
 TEST(simple, nested_1) {
   run_code("minimal","data/test/regression/simple/nested_1.v", "8");
 }
@@ -279,6 +329,9 @@ TEST(simple, nonblock_2) {
 TEST(simple, nonblock_3) {
   run_code("minimal","data/test/regression/simple/nonblock_3.v", "0 1 2 4 8 ");
 }
+TEST(simple, nonblock_4) {
+  run_code("minimal","data/test/regression/simple/nonblock_4.v", "120 217 121 217 ");
+}
 TEST(simple, pipeline_1) {
   run_code("minimal","data/test/regression/simple/pipeline_1.v", "0123456789");
 }
@@ -330,6 +383,9 @@ TEST(simple, repeat_2) {
 TEST(simple, repeat_3) {
   run_code("minimal","data/test/regression/simple/repeat_3.v", "999999999");
 }
+TEST(simple, repeat_4) {
+  run_code("minimal","data/test/regression/simple/repeat_4.v", "300000");
+}
 TEST(simple, seq_1) {
   run_code("minimal","data/test/regression/simple/seq_1.v", "12");
 }
@@ -348,3 +404,6 @@ TEST(simple, while_1) {
 TEST(simple, while_2) {
   run_code("minimal","data/test/regression/simple/while_2.v", "012345");
 }
+TEST(simple, while_3) {
+  run_code("minimal","data/test/regression/simple/while_3.v", "499500");
+}
@@ -0,0 +1,139 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "common/sockstream.h"
+#include "gtest/gtest.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Returns n bytes of highly redundant text, like module source
+string text(size_t n) {
+  const string line = "  always @(posedge clock.val) count <= count + 1;\n";
+  string res;
+  while (res.length() < n) {
+    res += line + to_string(res.length()) + "\n";
+  }
+  return res.substr(0, n);
+}
+
+// Returns n bytes which won't compress
+string noise(size_t n) {
+  srand(n);
+  string res(n, '\0');
+  for (auto& c : res) {
+    c = rand() & 0xff;
+  }
+  return res;
+}
+
+// Sends each message as its own frame from one end of a socket pair and
+// checks that the other end receives it unchanged. The sender runs on its
+// own thread so that large frames can't fill the socket buffer and block.
+void run_round_trip(uint32_t send_threshold, uint32_t recv_threshold, const vector<string>& msgs) {
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  sockstream out(fds[0]);
+  sockstream in(fds[1]);
+  out.set_compression_threshold(send_threshold);
+  in.set_compression_threshold(recv_threshold);
+
+  thread t([&out, &msgs]{
+    for (const auto& m : msgs) {
+      out.write(m.data(), m.length());
+      out.flush();
+    }
+  });
+  for (const auto& m : msgs) {
+    string res(m.length(), '\0');
+    in.read(&res[0], res.length());
+    EXPECT_EQ(in.gcount(), static_cast<streamsize>(m.length()));
+    EXPECT_TRUE(res == m) << m.length() << " bytes";
+  }
+  t.join();
+}
+
+} // namespace
+
+TEST(sockstream, uncompressed) {
+  run_round_trip(0, 0, {text(1), text(4095), text(4096), text(1 << 18), noise(8192)});
+}
+TEST(sockstream, threshold) {
+  run_round_trip(4096, 4096, {text(1), text(4095), text(4096), text(4097), text(1 << 18), noise(8192), text(17)});
+}
+TEST(sockstream, receiver_threshold) {
+  // Compressed frames are flagged, so the receiver's threshold doesn't matter
+  run_round_trip(4096, 0, {text(4095), text(4096), text(1 << 18), noise(8192)});
+  run_round_trip(0, 4096, {text(4095), text(4096), text(1 << 18), noise(8192)});
+}
+TEST(sockstream, frames) {
+  // Frames below the threshold, or which don't shrink, are sent as-is.
+  // Everything else is flagged in the high bit of its length prefix and
+  // followed by its uncompressed length.
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  sockstream out(fds[0]);
+  out.set_compression_threshold(4096);
+
+  const vector<pair<string, bool>> msgs = {{text(4095), false}, {text(4096), true}, {noise(4096), false}};
+  for (const auto& msg : msgs) {
+    const auto& m = msg.first;
+    out.write(m.data(), m.length());
+    out.flush();
+
+    uint32_t header = 0;
+    ASSERT_EQ(::recv(fds[1], &header, sizeof(header), MSG_WAITALL), static_cast<ssize_t>(sizeof(header)));
+    const auto compressed = (header & 0x8000'0000) != 0;
+    EXPECT_EQ(compressed, msg.second);
+
+    uint32_t n = header & 0x7fff'ffff;
+    if (compressed) {
+      uint32_t len = 0;
+      ASSERT_EQ(::recv(fds[1], &len, sizeof(len), MSG_WAITALL), static_cast<ssize_t>(sizeof(len)));
+      EXPECT_EQ(len, m.length());
+      EXPECT_LT(n, m.length());
+      n -= sizeof(len);
+    } else {
+      EXPECT_EQ(n, m.length());
+    }
+    vector<char> body(n);
+    ASSERT_EQ(::recv(fds[1], body.data(), n, MSG_WAITALL), static_cast<ssize_t>(n));
+  }
+  ::close(fds[1]);
+}
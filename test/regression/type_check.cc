@@ -191,6 +191,9 @@ TEST(type_check, fail_declaration_6) {
 TEST(type_check, fail_declaration_7) {
   run_typecheck("minimal", "data/test/regression/type_check/fail/declaration_7.v", true);
 }
+TEST(type_check, fail_declaration_8) {
+  run_typecheck("minimal", "data/test/regression/type_check/fail/declaration_8.v", true);
+}
 TEST(type_check, fail_generate_1) {
   run_typecheck("minimal", "data/test/regression/type_check/fail/generate_1.v", true);
 }
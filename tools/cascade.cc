@@ -35,6 +35,7 @@
 #include "cascade/cascade.h"
 #include "cl/cl.h"
 #include "common/system.h"
+#include "verilog/transform/pass_manager.h"
 
 using namespace cascade;
 using namespace cascade::cl;
@@ -78,18 +79,56 @@ auto& disable_error = FlagArg::create("--disable_error")
   .description("Turn off error messages");
 auto& enable_log = FlagArg::create("--enable_log")
   .description("Prints debugging information to log file");
+auto& enable_debug = FlagArg::create("--enable_debug")
+  .description("Keeps simulating variables which can't affect observable behavior, so that they can be inspected with $__debug");
 
 __attribute__((unused)) auto& g4 = Group::create("Optimization Options");
 auto& disable_inlining = FlagArg::create("--disable_inlining")
   .description("Prevents cascade from inlining modules");
+auto& inline_budget = StrArg<size_t>::create("--inline_budget")
+  .usage("<n>")
+  .description("Maximum size, in identifiers and constants, that a module may grow to through inlining; larger children are compiled on their own; setting n to zero places no limit on inlining")
+  .initial(0);
+auto& inline_threshold = StrArg<size_t>::create("--inline_threshold")
+  .usage("<n>")
+  .description("Number of milliseconds a module which was compiled on its own must run for before it is inlined into its parent; setting n to zero disables runtime inlining")
+  .initial(0);
 auto& open_loop_target = StrArg<size_t>::create("--open_loop_target")
   .usage("<n>")
   .description("Maximum number of seconds to run in open loop for before transferring control back to runtime")
   .initial(1);
+auto& promotion_threshold = StrArg<size_t>::create("--promotion_threshold")
+  .usage("<n>")
+  .description("Number of milliseconds a module must run for in one jit tier before the next tier is compiled; zero, the default, compiles every tier immediately")
+  .initial(0);
+auto& async_fast_pass = FlagArg::create("--async_fast_pass")
+  .description("Keeps running old code while fast-pass compilations for new code run in the background");
+auto& speculative_cache_size = StrArg<size_t>::create("--speculative_cache_size")
+  .usage("<n>")
+  .description("Number of slow-pass results per module to keep after their source is replaced, for reuse if it reappears; note that these hold on to hardware resources")
+  .initial(0);
+auto& max_compilations = StrArg<size_t>::create("--max_compilations")
+  .usage("<n>")
+  .description("Maximum number of background compilations to run at once; the rest wait in a queue ordered by how hot their modules are")
+  .initial(2);
+auto& pass_pipeline = StrArg<string>::create("--pass_pipeline")
+  .usage("<target>=<pass1>,<pass2>,...;...")
+  .description("IR pipeline to run on modules for each target; a pass or parenthesized group of passes followed by * is repeated until it reaches a fixpoint")
+  .initial("");
+auto& pass_stats = FlagArg::create("--pass_stats")
+  .description("Prints the time spent in and the change in node count produced by each IR pass; only effective with --enable_info");
+auto& cache_path = StrArg<string>::create("--cache_path")
+  .usage("<path/to/dir>")
+  .description("Directory to cache transformed IR in across runs; caching is disabled if no path is provided")
+  .initial("");
+auto& compression_threshold = StrArg<size_t>::create("--compression_threshold")
+  .usage("<n>")
+  .description("Minimum size in bytes of a message to a remote compiler which will be compressed; compression is disabled if n is zero, and only pays off over slow links")
+  .initial(0);
 
 __attribute__((unused)) auto& g5 = Group::create("REPL Options");
 auto& disable_repl = FlagArg::create("--disable_repl")
-  .description("Disables the REPL and treats user input as stdin");
+  .description("Disables the REPL and treats user input as stdin; if a program is provided with -e, it is assumed to be complete, which allows state that can't affect observable behavior to be eliminated");
 
 class inbuf : public streambuf {
   public:
@@ -190,13 +229,45 @@ int main(int argc, char** argv) {
     sigaction(SIGINT, &action, nullptr);
   }
 
+  // Check that every requested pipeline is well-formed
+  stringstream ss(::pass_pipeline.value());
+  for (string entry; getline(ss, entry, ';'); ) {
+    const auto eq = entry.find('=');
+    const auto spec = (eq == string::npos) ? entry : entry.substr(eq+1);
+    PassManager pm;
+    if (pm.set_pipeline(spec).error()) {
+      cerr << "Unrecognized pass pipeline '" << spec << "'!";
+      for (const auto& u : pm.unknown()) {
+        cerr << " Unknown pass '" << u << "'.";
+      }
+      cerr << " Valid passes are:";
+      for (const auto& p : PassManager::passes()) {
+        cerr << " " << p;
+      }
+      cerr << endl;
+      return 1;
+    }
+  }
+
   // Create a new cascade
   ::cascade_ = new Cascade();
 
   // Set command line flags
   ::cascade_->set_include_dirs(::inc_dirs.value() + ":" + System::src_root());
   ::cascade_->set_enable_inlining(!::disable_inlining.value());
+  ::cascade_->set_inline_budget(::inline_budget.value());
+  ::cascade_->set_inline_threshold(::inline_threshold.value());
   ::cascade_->set_open_loop_target(::open_loop_target.value());
+  ::cascade_->set_promotion_threshold(::promotion_threshold.value());
+  ::cascade_->set_async_fast_pass(::async_fast_pass.value());
+  ::cascade_->set_speculative_cache_size(::speculative_cache_size.value());
+  ::cascade_->set_max_compilations(::max_compilations.value());
+  ::cascade_->set_pass_pipeline(::pass_pipeline.value());
+  ::cascade_->set_pass_stats(::pass_stats.value());
+  ::cascade_->set_enable_debug(::enable_debug.value());
+  ::cascade_->set_batch_mode(::disable_repl.value() && (::input_path.value() != ""));
+  ::cascade_->set_cache_path(::cache_path.value());
+  ::cascade_->set_compression_threshold(::compression_threshold.value());
   ::cascade_->set_quartus_server(::quartus_host.value(), ::quartus_port.value());
   ::cascade_->set_profile_interval(::profile.value());
 
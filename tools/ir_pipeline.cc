@@ -0,0 +1,191 @@
+// Copyright 2017-2019 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "cl/cl.h"
+#include "common/incstream.h"
+#include "common/log.h"
+#include "common/system.h"
+#include "runtime/isolate.h"
+#include "verilog/analyze/module_info.h"
+#include "verilog/ast/ast.h"
+#include "verilog/parse/parser.h"
+#include "verilog/print/print.h"
+#include "verilog/program/inline.h"
+#include "verilog/program/program.h"
+#include "verilog/transform/pass_manager.h"
+
+using namespace cascade;
+using namespace cascade::cl;
+using namespace std;
+
+namespace {
+
+__attribute__((unused)) auto& g1 = Group::create("Input Options");
+auto& march = StrArg<string>::create("--march")
+  .usage("minimal|minimal_jit|sw|de10|de10_jit")
+  .description("Target architecture whose standard library and annotations to use")
+  .initial("minimal");
+auto& inc_dirs = StrArg<string>::create("-I")
+  .usage("<path1>:<path2>:...:<pathn>")
+  .description("Paths to search for files on")
+  .initial("");
+auto& input_path = StrArg<string>::create("-e")
+  .usage("path/to/file.v")
+  .description("Read input from file");
+auto& disable_inlining = FlagArg::create("--disable_inlining")
+  .description("Prevents modules from being inlined before running the pipeline");
+auto& inline_budget = StrArg<size_t>::create("--inline_budget")
+  .usage("<n>")
+  .description("Maximum size, in identifiers and constants, that a module may grow to through inlining; setting n to zero places no limit on inlining")
+  .initial(0);
+
+__attribute__((unused)) auto& g2 = Group::create("Pipeline Options");
+auto& passes = StrArg<string>::create("--passes")
+  .usage("<pass1>,(<pass2>,<pass3>)*,...")
+  .description("Passes to run, in order; a pass or parenthesized group of passes followed by * is repeated until it reaches a fixpoint")
+  .initial(PassManager::default_pipeline());
+auto& max_iterations = StrArg<size_t>::create("--max_iterations")
+  .usage("<n>")
+  .description("Maximum number of times to repeat a group of passes")
+  .initial(8);
+auto& print_ir = FlagArg::create("--print")
+  .description("Prints the IR for each module after running the pipeline");
+
+// Parses and evaluates the contents of a file. Returns false on error.
+bool eval(const string& path, const string& dirs, Log* log, Parser* parser, Program* program) {
+  incstream is(dirs);
+  if (!is.open(path)) {
+    cerr << "Unable to open file '" << path << "'!" << endl;
+    return false;
+  }
+  for (auto eof = false; !eof; ) {
+    eof = parser->parse(is);
+    for (auto i = parser->begin(), ie = parser->end(); !log->error() && (i != ie); ++i) {
+      if ((*i)->is(Node::Tag::module_declaration)) {
+        auto* md = static_cast<ModuleDeclaration*>(*i);
+        program->declare(md, log, parser);
+        if (::disable_inlining.value()) {
+          md->get_attrs()->set_or_replace("__no_inline", new String("true"));
+        }
+      } else {
+        program->eval(static_cast<ModuleItem*>(*i), log, parser);
+      }
+    }
+    if (log->error()) {
+      for (auto e = log->error_begin(), ee = log->error_end(); e != ee; ++e) {
+        cerr << *e << endl;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+// Collects every module which would be compiled to its own engine
+void collect(const ModuleDeclaration* md, vector<const ModuleDeclaration*>* res) {
+  res->push_back(md);
+  for (auto& c : ModuleInfo(md).children()) {
+    const auto* mi = static_cast<const ModuleInstantiation*>(c.first->get_parent());
+    if (!Inline().is_inlined(mi)) {
+      collect(c.second, res);
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line
+  Simple::read(argc, argv);
+
+  PassManager pm;
+  pm.set_pipeline(::passes.value());
+  pm.set_max_iterations(::max_iterations.value());
+  pm.set_stats(true);
+  if (pm.error()) {
+    cerr << "Unrecognized pass pipeline '" << ::passes.value() << "'!";
+    for (const auto& u : pm.unknown()) {
+      cerr << " Unknown pass '" << u << "'.";
+    }
+    cerr << " Valid passes are:";
+    for (const auto& p : PassManager::passes()) {
+      cerr << " " << p;
+    }
+    cerr << endl;
+    return 1;
+  }
+  if (::input_path.value().empty()) {
+    cerr << "No input file provided!" << endl;
+    return 1;
+  }
+
+  // Build a program the same way that the runtime does: the march file
+  // first, followed by user code.
+  const auto dirs = ::inc_dirs.value() + ":" + System::src_root();
+  Log log;
+  Parser parser(&log);
+  parser.set_include_dirs(dirs);
+  Program program;
+  if (!eval("data/march/" + ::march.value() + ".v", System::src_root(), &log, &parser, &program)) {
+    return 1;
+  }
+  if (!eval(::input_path.value(), dirs, &log, &parser, &program)) {
+    return 1;
+  }
+  program.set_inline_budget(::inline_budget.value());
+  program.inline_all();
+
+  // Isolate and transform everything that runs as logic
+  vector<const ModuleDeclaration*> mds;
+  collect(program.root_elab()->second, &mds);
+  for (const auto* md : mds) {
+    const auto* std = md->get_attrs()->get<String>("__std");
+    if ((std == nullptr) || !std->eq("logic")) {
+      continue;
+    }
+    auto* ir = Isolate().isolate(md, -1);
+    const auto before = PassManager::count(ir);
+    pm.clear_stats();
+    pm.run(ir);
+
+    cout << "// " << ir->get_id() << ": " << before << " -> " << PassManager::count(ir) << " nodes" << endl;
+    pm.write_stats(cout);
+    if (::print_ir.value()) {
+      cout << ir << endl;
+    }
+    cout << endl;
+    delete ir;
+  }
+
+  return 0;
+}